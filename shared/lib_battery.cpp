@@ -144,6 +144,36 @@ void capacity_t::copy(capacity_t * capacity)
 	_prev_charge = capacity->_prev_charge;
 	_charge = capacity->_charge;
 }
+void capacity_t::save_state(capacity_state &state) const
+{
+	state.q0 = _q0;
+	state.qmax = _qmax;
+	state.qmax_thermal = _qmax_thermal;
+	state.I = _I;
+	state.I_loss = _I_loss;
+	state.SOC = _SOC;
+	state.DOD = _DOD;
+	state.DOD_prev = _DOD_prev;
+	state.dt_hour = _dt_hour;
+	state.chargeChange = _chargeChange;
+	state.prev_charge = _prev_charge;
+	state.charge = _charge;
+}
+void capacity_t::restore_state(const capacity_state &state)
+{
+	_q0 = state.q0;
+	_qmax = state.qmax;
+	_qmax_thermal = state.qmax_thermal;
+	_I = state.I;
+	_I_loss = state.I_loss;
+	_SOC = state.SOC;
+	_DOD = state.DOD;
+	_DOD_prev = state.DOD_prev;
+	_dt_hour = state.dt_hour;
+	_chargeChange = state.chargeChange;
+	_prev_charge = state.prev_charge;
+	_charge = state.charge;
+}
 void capacity_t::check_charge_change()
 {
 	_charge = NO_CHARGE;
@@ -250,6 +280,22 @@ capacity_t(q20, SOC_init, SOC_max, SOC_min)
 	replace_battery();
 }
 capacity_kibam_t * capacity_kibam_t::clone(){ return new capacity_kibam_t(*this); }
+void capacity_kibam_t::save_state(capacity_state &state) const
+{
+	capacity_t::save_state(state);
+	state.q1_0 = _q1_0;
+	state.q2_0 = _q2_0;
+	state.q1 = _q1;
+	state.q2 = _q2;
+}
+void capacity_kibam_t::restore_state(const capacity_state &state)
+{
+	capacity_t::restore_state(state);
+	_q1_0 = state.q1_0;
+	_q2_0 = state.q2_0;
+	_q1 = state.q1;
+	_q2 = state.q2;
+}
 void capacity_kibam_t::copy(capacity_t * capacity)
 {
 	capacity_t::copy(capacity);
@@ -522,6 +568,8 @@ void voltage_t::copy(voltage_t * voltage)
 	// doesn't change;
 	//_batt_voltage_matrix = voltage->_batt_voltage_matrix;
 }
+void voltage_t::save_state(voltage_state &state) const { state.cell_voltage = _cell_voltage; }
+void voltage_t::restore_state(const voltage_state &state) { _cell_voltage = state.cell_voltage; }
 double voltage_t::battery_voltage(){ return _num_cells_series*_cell_voltage; }
 double voltage_t::battery_voltage_nominal(){ return _num_cells_series * _cell_voltage_nominal; }
 double voltage_t::cell_voltage(){ return _cell_voltage; }
@@ -721,6 +769,16 @@ void voltage_vanadium_redox_t::copy(voltage_t * voltage)
 	_F = tmp->_F;
 	_C0 = tmp->_C0;
 }
+void voltage_vanadium_redox_t::save_state(voltage_state &state) const
+{
+	voltage_t::save_state(state);
+	state.I = _I;
+}
+void voltage_vanadium_redox_t::restore_state(const voltage_state &state)
+{
+	voltage_t::restore_state(state);
+	_I = state.I;
+}
 void voltage_vanadium_redox_t::updateVoltage(capacity_t * capacity, thermal_t * thermal, double )
 {
 
@@ -801,8 +859,24 @@ void lifetime_t::copy(lifetime_t * lifetime)
 	_replacement_scheduled = lifetime->_replacement_scheduled;
 	_q = lifetime->_q;
 }
+void lifetime_t::save_state(lifetime_state &state) const
+{
+	_lifetime_cycle->save_state(state.cycle);
+	_lifetime_calendar->save_state(state.calendar);
+	state.replacements = _replacements;
+	state.replacement_scheduled = _replacement_scheduled;
+	state.q = _q;
+}
+void lifetime_t::restore_state(const lifetime_state &state)
+{
+	_lifetime_cycle->restore_state(state.cycle);
+	_lifetime_calendar->restore_state(state.calendar);
+	_replacements = state.replacements;
+	_replacement_scheduled = state.replacement_scheduled;
+	_q = state.q;
+}
 double lifetime_t::capacity_percent(){ return _q; }
-void lifetime_t::runLifetimeModels(size_t idx, capacity_t * capacity, double T_battery)
+void lifetime_t::runLifetimeModels(size_t idx, capacity_t * capacity, double T_battery, size_t n_steps)
 {
 	double q_last = _q;
 	double q_cycle = _q;
@@ -815,7 +889,7 @@ void lifetime_t::runLifetimeModels(size_t idx, capacity_t * capacity, double T_b
 		else if (idx==0)
 			q_cycle = _lifetime_cycle->runCycleLifetime((capacity->DOD()));
 		
-		q_calendar = _lifetime_calendar->runLifetimeCalendarModel(idx, T_battery, capacity->SOC()*0.01);
+		q_calendar = _lifetime_calendar->runLifetimeCalendarModel(idx + n_steps - 1, T_battery, capacity->SOC()*0.01, n_steps);
 
 		// total capacity is min of cycle (Q_neg) and calendar (Q_li) capacity
 		_q = fmin(q_cycle, q_calendar);
@@ -857,6 +931,8 @@ lifetime_cycle_t::lifetime_cycle_t(const util::matrix_t<double> &batt_lifetime_m
 		_cycles_vect.push_back(batt_lifetime_matrix.at(i,1));
 		_capacities_vect.push_back(batt_lifetime_matrix.at(i, 2));
 	}
+	init_bilinear();
+
 	// initialize other member variables
 	_nCycles = 0;
 	_Dlt = 0;
@@ -866,6 +942,9 @@ lifetime_cycle_t::lifetime_cycle_t(const util::matrix_t<double> &batt_lifetime_m
 	_Ylt = 0;
 	_Range = 0;
 	_average_range = 0;
+
+	// the peaks stack only holds the unclosed half cycles, so is short
+	_Peaks.reserve(64);
 }
 
 lifetime_cycle_t::~lifetime_cycle_t(){}
@@ -891,6 +970,30 @@ void lifetime_cycle_t::copy(lifetime_cycle_t * lifetime_cycle)
 	_Range = lifetime_cycle->_Range;
 	_average_range = lifetime_cycle->_average_range;
 }
+void lifetime_cycle_t::save_state(lifetime_cycle_state &state) const
+{
+	state.nCycles = _nCycles;
+	state.q = _q;
+	state.Dlt = _Dlt;
+	state.jlt = _jlt;
+	state.Xlt = _Xlt;
+	state.Ylt = _Ylt;
+	state.Peaks = _Peaks;
+	state.Range = _Range;
+	state.average_range = _average_range;
+}
+void lifetime_cycle_t::restore_state(const lifetime_cycle_state &state)
+{
+	_nCycles = state.nCycles;
+	_q = state.q;
+	_Dlt = state.Dlt;
+	_jlt = state.jlt;
+	_Xlt = state.Xlt;
+	_Ylt = state.Ylt;
+	_Peaks = state.Peaks;
+	_Range = state.Range;
+	_average_range = state.average_range;
+}
 double lifetime_cycle_t::computeCycleDamageAtDOD(double DOD)
 {
 	if (DOD == 0)
@@ -980,18 +1083,16 @@ int lifetime_cycle_t::rainflow_compareRanges()
 		_nCycles++;
 
 		// the capacity percent cannot increase
-		if (bilinear(_average_range, _nCycles) <= _q)
-			_q = bilinear(_average_range, _nCycles);
+		double q = bilinear(_average_range, _nCycles);
+		if (q <= _q)
+			_q = q;
 
 		if (_q < 0)
 			_q = 0.;
 		
-		// discard peak & valley of Y
-		double save = _Peaks[_jlt]; 
-		_Peaks.pop_back(); 
-		_Peaks.pop_back();
-		_Peaks.pop_back();
-		_Peaks.push_back(save);
+		// discard peak & valley of Y, keeping the last peak in their place on the stack
+		_Peaks[_jlt - 2] = _Peaks[_jlt];
+		_Peaks.resize(_jlt - 1);
 		_jlt -= 2;
 		// stay in while loop
 		retCode = LT_RERANGE;
@@ -1018,139 +1119,163 @@ double lifetime_cycle_t::cycle_range(){ return _Range; }
 double lifetime_cycle_t::bilinear(double DOD, int cycle_number)
 {
 	/*
-	Work could be done to make this simpler
-	Current idea is to interpolate first along the C = f(n) curves for each DOD to get C_DOD_, C_DOD_+ 
+	Interpolate first along the C = f(n) curves for the DOD bracketing the DOD of interest to get C_DOD_, C_DOD_+ 
 	Then interpolate C_, C+ to get C at the DOD of interest
+	The bracketing curves are built once by init_bilinear
 	*/
+	double C = 100;
+	size_t n = _DOD_unique.size();
+
+	if (n > 1)
+	{
+		// the number of unique DOD less than the DOD of interest indexes the bracket
+		size_t k = std::lower_bound(_DOD_unique.begin(), _DOD_unique.end(), DOD) - _DOD_unique.begin();
+
+		// Compute C(D_lo, n), C(D_hi, n)
+		double C_Dlo = util::linterp_col(_bracket_C_n_low[k], 0, cycle_number, 1);
+		double C_Dhi = util::linterp_col(_bracket_C_n_high[k], 0, cycle_number, 1);
+
+		if (C_Dlo < 0.)
+			C_Dlo = 0.;
+		if (C_Dhi > 100.)
+			C_Dhi = 100.;
+
+		// Interpolate to get C(D, n)
+		C = util::interpolate(_bracket_D_lo[k], C_Dlo, _bracket_D_hi[k], C_Dhi, DOD);
+	}
+	// just have one row, single level interpolation
+	else
+	{
+		C = util::linterp_col(_batt_lifetime_matrix, 1, cycle_number, 2);
+	}
+
+	return C;
+}
+
+void lifetime_cycle_t::init_bilinear()
+{
+	// get unique values of D
+	_DOD_unique.clear();
+	for (size_t i = 0; i != _DOD_vect.size(); i++)
+	{
+		if (std::find(_DOD_unique.begin(), _DOD_unique.end(), _DOD_vect[i]) == _DOD_unique.end())
+			_DOD_unique.push_back(_DOD_vect[i]);
+	}
+	std::sort(_DOD_unique.begin(), _DOD_unique.end());
+
+	_bracket_D_lo.clear();
+	_bracket_D_hi.clear();
+	_bracket_C_n_low.clear();
+	_bracket_C_n_high.clear();
+
+	size_t n = _DOD_unique.size();
+	if (n < 2)
+		return;
 
-	std::vector<double> D_unique_vect;
+	// every DOD in (D_unique[k-1], D_unique[k]] has the same bracket, so build it at the upper end
+	for (size_t k = 0; k <= n; k++)
+	{
+		double DOD = (k < n) ? _DOD_unique[k] : _DOD_unique[n - 1] + 1.;
+		double D_lo, D_hi;
+		util::matrix_t<double> C_n_low, C_n_high;
+		bilinear_bracket(DOD, D_lo, D_hi, C_n_low, C_n_high);
+
+		_bracket_D_lo.push_back(D_lo);
+		_bracket_D_hi.push_back(D_hi);
+		_bracket_C_n_low.push_back(C_n_low);
+		_bracket_C_n_high.push_back(C_n_high);
+	}
+}
+
+void lifetime_cycle_t::bilinear_bracket(double DOD, double &D_lo, double &D_hi, util::matrix_t<double> &C_n_low, util::matrix_t<double> &C_n_high)
+{
 	std::vector<double> C_n_low_vect;
-	std::vector<double> D_high_vect;
 	std::vector<double> C_n_high_vect;
 	std::vector<int> low_indices;
 	std::vector<int> high_indices;
 	double D = 0.;
-	size_t n = 0;
-	double C = 100;
 
-	// get unique values of D
-	D_unique_vect.push_back(_DOD_vect[0]);
-	for (int i = 0; i < (int)_DOD_vect.size(); i++){
-		bool contained = false;
-		for (int j = 0; j < (int)D_unique_vect.size(); j++){
-			if (_DOD_vect[i] == D_unique_vect[j]){
-				contained = true;
-				break;
-			}
-		}
-		if (!contained){
-			D_unique_vect.push_back(_DOD_vect[i]);
-		}
-	}
-	n = D_unique_vect.size();
+	// get where DOD is bracketed [D_lo, DOD, D_hi]
+	D_lo = 0;
+	D_hi = 100;
 
-	if (n > 1)
+	for (int i = 0; i < (int)_DOD_vect.size(); i++)
 	{
-		// get where DOD is bracketed [D_lo, DOD, D_hi]
-		double D_lo = 0;
-		double D_hi = 100;
+		D = _DOD_vect[i];
+		if (D < DOD && D > D_lo)
+			D_lo = D;
+		else if (D >= DOD && D < D_hi)
+			D_hi = D;
+	}
 
-		for (int i = 0; i < (int)_DOD_vect.size(); i++)
-		{
-			D = _DOD_vect[i];
-			if (D < DOD && D > D_lo)
-				D_lo = D;
-			else if (D >= DOD && D < D_hi)
-				D_hi = D;
-		}
+	// Seperate table into bins
+	double D_min = 100.;
+	double D_max = 0.;
+	
+	for (int i = 0; i < (int)_DOD_vect.size(); i++)
+	{
+		D = _DOD_vect[i];
+		if (D == D_lo)
+			low_indices.push_back(i);
+		else if (D == D_hi)
+			high_indices.push_back(i);
+
+		if (D < D_min){ D_min = D; }
+		else if (D > D_max){ D_max = D; }
+	}
 
-		// Seperate table into bins
-		double D_min = 100.;
-		double D_max = 0.;
-		
-		for (int i = 0; i < (int)_DOD_vect.size(); i++)
+	// if we're out of the bounds, just make the upper bound equal to the highest input
+	if (high_indices.size() == 0)
+	{
+		for (int i = 0; i != (int)_DOD_vect.size(); i++)
 		{
-			D = _DOD_vect[i];
-			if (D == D_lo)
-				low_indices.push_back(i);
-			else if (D == D_hi)
+			if (_DOD_vect[i] == D_max)
 				high_indices.push_back(i);
-
-			if (D < D_min){ D_min = D; }
-			else if (D > D_max){ D_max = D; }
-		}
-
-		// if we're out of the bounds, just make the upper bound equal to the highest input
-		if (high_indices.size() == 0)
-		{
-			for (int i = 0; i != (int)_DOD_vect.size(); i++)
-			{
-				if (_DOD_vect[i] == D_max)
-					high_indices.push_back(i);
-			}
 		}
+	}
 
-		size_t n_rows_lo = low_indices.size();
-		size_t n_rows_hi = high_indices.size();
-		size_t n_cols = 2;
+	size_t n_rows_lo = low_indices.size();
+	size_t n_rows_hi = high_indices.size();
+	size_t n_cols = 2;
 
-		// If we aren't bounded, fill in values
-		if (n_rows_lo == 0)
-		{
-			// Assumes 0% DOD
-			for (int i = 0; i < (int)n_rows_hi; i++)
-			{
-				C_n_low_vect.push_back(0. + i * 500); // cycles
-				C_n_low_vect.push_back(100.); // 100 % capacity
-			}
-		}
-		
-		if (n_rows_lo != 0)
+	// If we aren't bounded, fill in values
+	if (n_rows_lo == 0)
+	{
+		// Assumes 0% DOD
+		for (int i = 0; i < (int)n_rows_hi; i++)
 		{
-			for (int i = 0; i < (int)n_rows_lo; i++)
-			{
-				C_n_low_vect.push_back(_cycles_vect[low_indices[i]]);
-				C_n_low_vect.push_back(_capacities_vect[low_indices[i]]);
-			}
+			C_n_low_vect.push_back(0. + i * 500); // cycles
+			C_n_low_vect.push_back(100.); // 100 % capacity
 		}
-		if (n_rows_hi != 0)
+	}
+	
+	if (n_rows_lo != 0)
+	{
+		for (int i = 0; i < (int)n_rows_lo; i++)
 		{
-			for (int i = 0; i < (int)n_rows_hi; i++)
-			{
-				C_n_high_vect.push_back(_cycles_vect[high_indices[i]]);
-				C_n_high_vect.push_back(_capacities_vect[high_indices[i]]);
-			}
+			C_n_low_vect.push_back(_cycles_vect[low_indices[i]]);
+			C_n_low_vect.push_back(_capacities_vect[low_indices[i]]);
 		}
-		n_rows_lo = C_n_low_vect.size() / n_cols;
-		n_rows_hi = C_n_high_vect.size() / n_cols;
-
-		if (n_rows_lo == 0 || n_rows_hi == 0)
+	}
+	if (n_rows_hi != 0)
+	{
+		for (int i = 0; i < (int)n_rows_hi; i++)
 		{
-			// need a safeguard here
+			C_n_high_vect.push_back(_cycles_vect[high_indices[i]]);
+			C_n_high_vect.push_back(_capacities_vect[high_indices[i]]);
 		}
-
-		util::matrix_t<double> C_n_low(n_rows_lo, n_cols, &C_n_low_vect);
-		util::matrix_t<double> C_n_high(n_rows_lo, n_cols, &C_n_high_vect);
-
-		// Compute C(D_lo, n), C(D_hi, n)
-		double C_Dlo = util::linterp_col(C_n_low, 0, cycle_number, 1);
-		double C_Dhi = util::linterp_col(C_n_high, 0, cycle_number, 1);
-
-		if (C_Dlo < 0.)
-			C_Dlo = 0.;
-		if (C_Dhi > 100.)
-			C_Dhi = 100.;
-
-		// Interpolate to get C(D, n)
-		C = util::interpolate(D_lo, C_Dlo, D_hi, C_Dhi, DOD);
 	}
-	// just have one row, single level interpolation
-	else
+	n_rows_lo = C_n_low_vect.size() / n_cols;
+	n_rows_hi = C_n_high_vect.size() / n_cols;
+
+	if (n_rows_lo == 0 || n_rows_hi == 0)
 	{
-		C = util::linterp_col(_batt_lifetime_matrix, 1, cycle_number, 2);
+		// need a safeguard here
 	}
 
-	return C;
+	// the high curve takes the number of rows of the low curve, but can't read past its own
+	C_n_low = util::matrix_t<double>(n_rows_lo, n_cols, &C_n_low_vect);
+	C_n_high = util::matrix_t<double>(std::min(n_rows_lo, n_rows_hi), n_cols, &C_n_high_vect);
 }
 
 /*
@@ -1212,19 +1337,46 @@ void lifetime_calendar_t::copy(lifetime_calendar_t * lifetime_calendar)
 	_b = lifetime_calendar->_b;
 	_c = lifetime_calendar->_c;
 }
-double lifetime_calendar_t::runLifetimeCalendarModel(size_t idx, double T, double SOC)
+void lifetime_calendar_t::save_state(lifetime_calendar_state &state) const
+{
+	state.day_age_of_battery = _day_age_of_battery;
+	state.last_idx = _last_idx;
+	state.q = _q;
+	state.dq_old = _dq_old;
+	state.dq_new = _dq_new;
+}
+void lifetime_calendar_t::restore_state(const lifetime_calendar_state &state)
+{
+	_day_age_of_battery = state.day_age_of_battery;
+	_last_idx = state.last_idx;
+	_q = state.q;
+	_dq_old = state.dq_old;
+	_dq_new = state.dq_new;
+}
+double lifetime_calendar_t::runLifetimeCalendarModel(size_t idx, double T, double SOC, size_t n_steps)
 {
 	if (_calendar_choice != lifetime_calendar_t::NONE)
 	{
 		// only run once per iteration (need to make the last iteration)
 		if (idx > _last_idx)
 		{
-
-			if (idx % util::hours_per_day / _dt_hour == 0)
-				_day_age_of_battery++;
+			if (n_steps == 1)
+			{
+				if (idx % util::hours_per_day / _dt_hour == 0)
+					_day_age_of_battery++;
+			}
+			else
+			{
+				// steps already run are skipped, then count the day boundaries in the rest of the span
+				size_t idx_first = idx + 1 - n_steps;
+				if (idx_first <= _last_idx)
+					idx_first = _last_idx + 1;
+				_day_age_of_battery += (int)(idx / util::hours_per_day - (idx_first - 1) / util::hours_per_day);
+				n_steps = idx + 1 - idx_first;
+			}
 
 			if (_calendar_choice == lifetime_calendar_t::LITHIUM_ION_CALENDAR_MODEL)
-				runLithiumIonModel(T, SOC);
+				runLithiumIonModel(T, SOC, n_steps);
 			else if (_calendar_choice == lifetime_calendar_t::CALENDAR_LOSS_TABLE)
 				runTableModel();
 
@@ -1233,14 +1385,19 @@ double lifetime_calendar_t::runLifetimeCalendarModel(size_t idx, double T, doubl
 	}
 	return _q;
 }
-void lifetime_calendar_t::runLithiumIonModel(double T, double SOC)
+void lifetime_calendar_t::runLithiumIonModel(double T, double SOC, size_t n_steps)
 {
 	double k_cal = _a * exp(_b * (1. / T - 1. / 296))*exp(_c*(SOC / T - 1. / 296));
-	if (_dq_old == 0)
-		_dq_new = k_cal * sqrt(_dt_day);
-	else
-		_dq_new = (0.5 * pow(k_cal, 2) / _dq_old) * _dt_day + _dq_old;
-	_dq_old = _dq_new;
+	// over a span the rate is evaluated once, leaving only the fade recurrence per step
+	double k_cal_squared = pow(k_cal, 2);
+	for (size_t i = 0; i != n_steps; i++)
+	{
+		if (_dq_old == 0)
+			_dq_new = k_cal * sqrt(_dt_day);
+		else
+			_dq_new = (0.5 * k_cal_squared / _dq_old) * _dt_day + _dq_old;
+		_dq_old = _dq_new;
+	}
 	_q = (_q0 - (_dq_new)) * 100;
 	
 }
@@ -1332,6 +1489,18 @@ void thermal_t::copy(thermal_t * thermal)
 	_capacity_percent = thermal->_capacity_percent;
 	_T_max = thermal->_T_max;
 }
+void thermal_t::save_state(thermal_state &state) const
+{
+	state.R = _R;
+	state.T_battery = _T_battery;
+	state.capacity_percent = _capacity_percent;
+}
+void thermal_t::restore_state(const thermal_state &state)
+{
+	_R = state.R;
+	_T_battery = state.T_battery;
+	_capacity_percent = state.capacity_percent;
+}
 void thermal_t::replace_battery(size_t lifetimeIndex)
 { 
 	_T_battery = _T_room[util::yearOneIndex(_dt_hour, lifetimeIndex)];
@@ -1342,16 +1511,66 @@ void thermal_t::replace_battery(size_t lifetimeIndex)
 void thermal_t::updateTemperature(double I, double R, double dt, size_t lifetimeIndex)
 {
 	_R = R;
-	if (trapezoidal(I, dt*HR2SEC, lifetimeIndex) < _T_max && trapezoidal(I, dt*HR2SEC, lifetimeIndex) > 0)
-		_T_battery = trapezoidal(I, dt*HR2SEC, lifetimeIndex);
-	else if (rk4(I, dt*HR2SEC, lifetimeIndex) < _T_max && rk4(I, dt*HR2SEC, lifetimeIndex) > 0)
-		_T_battery = rk4(I, dt*HR2SEC, lifetimeIndex);
-	else if (implicit_euler(I, dt*HR2SEC, lifetimeIndex) < _T_max && implicit_euler(I, dt*HR2SEC, lifetimeIndex) > 0)
-		_T_battery = implicit_euler(I, dt*HR2SEC, lifetimeIndex);
+
+	// only fall back to the next method if the last one failed
+	double T = trapezoidal(I, dt*HR2SEC, lifetimeIndex);
+	if (T < _T_max && T > 0)
+	{
+		_T_battery = T;
+		return;
+	}
+	T = rk4(I, dt*HR2SEC, lifetimeIndex);
+	if (T < _T_max && T > 0)
+	{
+		_T_battery = T;
+		return;
+	}
+	T = implicit_euler(I, dt*HR2SEC, lifetimeIndex);
+	if (T < _T_max && T > 0)
+		_T_battery = T;
 	else
 		_message.add("Computed battery temperature below zero or greater than max allowed, consider reducing C-rate");
 }
 
+size_t thermal_t::stepsAtRoomTemperature(size_t lifetimeIndex, size_t n_max)
+{
+	double T_room = _T_room[util::yearOneIndex(_dt_hour, lifetimeIndex)];
+	size_t n = 1;
+	while (n < n_max && _T_room[util::yearOneIndex(_dt_hour, lifetimeIndex + n)] == T_room)
+		n++;
+	return n;
+}
+double thermal_t::updateTemperatureIdle(size_t lifetimeIndex, size_t n_steps)
+{
+	// At zero current a trapezoidal step relaxes the temperature difference to the room by a constant
+	// factor, so a run of steps at the same room temperature is a single power of that factor
+	double dt = _dt_hour*HR2SEC;
+	double BC = _h*_A / (_mass*_Cp);
+	double a = (1 - 0.5*dt*BC) / (1 + 0.5*dt*BC);
+
+	double T_sum = 0;
+	size_t i = 0;
+	while (i < n_steps)
+	{
+		double T_room = _T_room[util::yearOneIndex(_dt_hour, lifetimeIndex + i)];
+		size_t n = stepsAtRoomTemperature(lifetimeIndex + i, n_steps - i);
+
+		double dT = _T_battery - T_room;
+		double a_n = pow(a, (double)n);
+		T_sum += n * T_room + (a == 1 ? n * dT : dT * a * (1 - a_n) / (1 - a));
+		_T_battery = T_room + dT * a_n;
+		i += n;
+	}
+	return T_sum / n_steps;
+}
+size_t thermal_t::idleSteps(size_t lifetimeIndex, size_t n_max)
+{
+	// while the battery is still relaxing, the calendar fade needs the temperature of each step
+	if (fabs(_T_battery - _T_room[util::yearOneIndex(_dt_hour, lifetimeIndex)]) > T_room_tolerance)
+		return 1;
+	return stepsAtRoomTemperature(lifetimeIndex, n_max);
+}
+
 double thermal_t::f(double T_battery, double I, size_t lifetimeindex)
 {
 	return (1 / (_mass*_Cp)) * ((_h*(_T_room[util::yearOneIndex(_dt_hour, lifetimeindex)]  - T_battery)*_A) + pow(I, 2)*_R);
@@ -1468,25 +1687,30 @@ void losses_t::copy(losses_t * losses)
 	_idle_loss = losses->_idle_loss;
 	_full_loss = losses->_full_loss;*/
 }
+void losses_t::save_state(losses_state &state) const { state.nCycle = _nCycle; }
+void losses_t::restore_state(const losses_state &state) { _nCycle = state.nCycle; }
 
 void losses_t::replace_battery(){ _nCycle = 0; }
 double losses_t::getLoss(size_t indexFirstYear) { return _full_loss[indexFirstYear]; }
-void losses_t::run_losses(size_t lifetimeIndex)
+void losses_t::run_losses(size_t lifetimeIndex, size_t n_steps)
 {	
 	_capacity->updateCapacityForLifetime(_lifetime->capacity_percent());
 
-	size_t indexYearOne = util::yearOneIndex(_dtHour, lifetimeIndex);
-	size_t hourOfYear = (size_t)std::floor(indexYearOne * _dtHour);
-	size_t monthIndex = util::month_of((double)(hourOfYear)) - 1;
-
 	// update system losses depending on user input
 	if (_loss_mode == losses_t::MONTHLY) {
-		if (_capacity->charge_operation() == capacity_t::CHARGE)
-			_full_loss[indexYearOne] = _charge_loss[monthIndex];
-		if (_capacity->charge_operation() == capacity_t::DISCHARGE)
-			_full_loss[indexYearOne] = _discharge_loss[monthIndex];
-		if (_capacity->charge_operation() == capacity_t::NO_CHARGE)
-			_full_loss[indexYearOne] = _idle_loss[monthIndex];
+		for (size_t i = 0; i != n_steps; i++)
+		{
+			size_t indexYearOne = util::yearOneIndex(_dtHour, lifetimeIndex + i);
+			size_t hourOfYear = (size_t)std::floor(indexYearOne * _dtHour);
+			size_t monthIndex = util::month_of((double)(hourOfYear)) - 1;
+
+			if (_capacity->charge_operation() == capacity_t::CHARGE)
+				_full_loss[indexYearOne] = _charge_loss[monthIndex];
+			if (_capacity->charge_operation() == capacity_t::DISCHARGE)
+				_full_loss[indexYearOne] = _discharge_loss[monthIndex];
+			if (_capacity->charge_operation() == capacity_t::NO_CHARGE)
+				_full_loss[indexYearOne] = _idle_loss[monthIndex];
+		}
 	}
 
 }
@@ -1500,23 +1724,13 @@ battery_t::battery_t(double dt_hour, int battery_chemistry)
 	_dt_min = dt_hour * 60;
 	_battery_chemistry = battery_chemistry;
 	_last_idx = 0;
-
-	if (battery_chemistry != battery_t::LEAD_ACID) {
-		_capacity_initial = new capacity_lithium_ion_t();
-	}
-	else {
-		_capacity_initial = new capacity_kibam_t();
-	}
-	_thermal_initial = new thermal_t();
 }
 
 battery_t::battery_t(const battery_t& battery)
 {
 	_capacity = battery.capacity_model()->clone();
-	_capacity_initial = battery.capacity_initial_model()->clone();
 	_voltage = battery.voltage_model()->clone();
 	_thermal = battery.thermal_model()->clone();
-	_thermal_initial = battery.thermal_initial_model()->clone();
 	_lifetime = battery.lifetime_model()->clone();
 	_losses = battery.losses_model()->clone();
 	_battery_chemistry = battery._battery_chemistry;
@@ -1525,21 +1739,13 @@ battery_t::battery_t(const battery_t& battery)
 	_last_idx = battery._last_idx;
 }
 
-battery_t::~battery_t()
-{
-	if (_capacity_initial)
-		delete _capacity_initial;
-	if (_thermal_initial)
-		delete _thermal_initial;
-}
+battery_t::~battery_t(){}
 
 // copy from battery to this
 void battery_t::copy(const battery_t * battery)
 {
 	_capacity->copy(battery->capacity_model());
-	_capacity_initial->copy(battery->capacity_initial_model());
 	_thermal->copy(battery->thermal_model());
-	_thermal_initial->copy(battery->thermal_initial_model());
 	_lifetime->copy(battery->lifetime_model());
 	_voltage->copy(battery->voltage_model());
 	_losses->copy(battery->losses_model());
@@ -1550,6 +1756,26 @@ void battery_t::copy(const battery_t * battery)
 	_last_idx = battery->_last_idx;
 }
 
+void battery_t::save_state(battery_state &state) const
+{
+	_capacity->save_state(state.capacity);
+	_voltage->save_state(state.voltage);
+	_thermal->save_state(state.thermal);
+	_lifetime->save_state(state.lifetime);
+	_losses->save_state(state.losses);
+	state.last_idx = _last_idx;
+}
+
+void battery_t::restore_state(const battery_state &state)
+{
+	_capacity->restore_state(state.capacity);
+	_voltage->restore_state(state.voltage);
+	_thermal->restore_state(state.thermal);
+	_lifetime->restore_state(state.lifetime);
+	_losses->restore_state(state.losses);
+	_last_idx = state.last_idx;
+}
+
 void battery_t::delete_clone()
 {
 	if (_capacity) delete _capacity;
@@ -1569,9 +1795,6 @@ void battery_t::initialize(capacity_t *capacity, voltage_t * voltage, lifetime_t
 	_voltage = voltage;
 	_thermal = thermal;
 	_losses = losses;
-
-	_capacity_initial->copy(_capacity);
-	_thermal_initial->copy(_thermal);
 }
 
 void battery_t::run(size_t lifetimeIndex, double I)
@@ -1580,8 +1803,10 @@ void battery_t::run(size_t lifetimeIndex, double I)
 	// Temperature affects capacity, but capacity model can reduce current, which reduces temperature, need to iterate
 	double I_initial = I;
 	size_t iterate_count = 0;
-	_capacity_initial->copy(_capacity);
-	_thermal_initial->copy(_thermal);
+	capacity_state capacity_initial;
+	thermal_state thermal_initial;
+	_capacity->save_state(capacity_initial);
+	_thermal->save_state(thermal_initial);
 
 	while (iterate_count < 5)
 	{
@@ -1590,8 +1815,8 @@ void battery_t::run(size_t lifetimeIndex, double I)
 
 		if (fabs(I - I_initial)/fabs(I_initial) > tolerance)
 		{
-			_thermal->copy(_thermal_initial);
-			_capacity->copy(_capacity_initial);
+			_thermal->restore_state(thermal_initial);
+			_capacity->restore_state(capacity_initial);
 			I_initial = I;
 			iterate_count++;
 		} 
@@ -1604,6 +1829,33 @@ void battery_t::run(size_t lifetimeIndex, double I)
 	runLifetimeModel(lifetimeIndex);
 	runLossesModel(lifetimeIndex);
 }
+void battery_t::run_idle(size_t lifetimeIndex, size_t n_steps)
+{
+	// Steps away from the room temperature are run individually, so a single step matches run() exactly.
+	// Once the battery sits at the room temperature the calendar fade rate is evaluated once for each
+	// run of steps at that temperature, and the charge redistributes over the run in one update.
+	size_t i = 0;
+	while (i < n_steps)
+	{
+		size_t idx = lifetimeIndex + i;
+		size_t n = _thermal->idleSteps(idx, n_steps - i);
+		double I = 0.;
+		if (n == 1)
+		{
+			run(idx, I);
+			i++;
+			continue;
+		}
+		double T_mean = _thermal->updateTemperatureIdle(idx, n);
+
+		// the charge redistribution at zero current is exact over the whole run
+		_capacity->updateCapacity(I, _dt_hour * n);
+		runVoltageModel();
+		i += n;
+		runLifetimeModel(idx, T_mean, n);
+		runLossesModel(idx, n);
+	}
+}
 void battery_t::runThermalModel(double I, size_t lifetimeIndex)
 {
 	_thermal->updateTemperature(I, _voltage->R_battery(), _dt_hour, lifetimeIndex);
@@ -1626,28 +1878,33 @@ void battery_t::runVoltageModel()
 
 void battery_t::runLifetimeModel(size_t lifetimeIndex)
 {
-	_lifetime->runLifetimeModels(lifetimeIndex, capacity_model(), thermal_model()->T_battery());
+	runLifetimeModel(lifetimeIndex, thermal_model()->T_battery(), 1);
+}
+void battery_t::runLifetimeModel(size_t lifetimeIndex, double T_battery, size_t n_steps)
+{
+	_lifetime->runLifetimeModels(lifetimeIndex, capacity_model(), T_battery, n_steps);
 	if (_lifetime->check_replaced())
 	{
 		_capacity->replace_battery();
-		_thermal->replace_battery(lifetimeIndex);
+		_thermal->replace_battery(lifetimeIndex + n_steps - 1);
 		_losses->replace_battery();
 	}
 }
-void battery_t::runLossesModel(size_t idx)
+void battery_t::runLossesModel(size_t idx, size_t n_steps)
 {
-	if (idx > _last_idx || idx == 0)
+	size_t idx_last = idx + n_steps - 1;
+	if (idx_last > _last_idx || idx == 0)
 	{
-		_losses->run_losses(idx);
-		_last_idx = idx;
+		// losses for steps already run aren't recomputed
+		size_t idx_first = (idx > _last_idx || idx == 0) ? idx : _last_idx + 1;
+		_losses->run_losses(idx_first, idx_last + 1 - idx_first);
+		_last_idx = idx_last;
 	}
 }
 capacity_t * battery_t::capacity_model() const { return _capacity; }
-capacity_t * battery_t::capacity_initial_model() const { return _capacity_initial; }
 voltage_t * battery_t::voltage_model() const { return _voltage; }
 lifetime_t * battery_t::lifetime_model() const { return _lifetime; }
 thermal_t * battery_t::thermal_model() const { return _thermal; }
-thermal_t * battery_t::thermal_initial_model() const { return _thermal_initial; }
 losses_t * battery_t::losses_model() const { return _losses; }
 
 double battery_t::battery_charge_needed(double SOC_max)
@@ -62,6 +62,7 @@
 
 const double low_tolerance = 0.01;
 const double tolerance = 0.001;
+const double T_room_tolerance = 0.01; // [K] battery temperature within which an idle battery is at the room temperature
 
 // Messages
 class message
@@ -82,6 +83,32 @@ protected:
 	std::vector<int> count;
 };
 
+/*
+Quantities in the capacity models which change as the battery runs.
+Parameters are not included so that a snapshot can be saved and restored cheaply
+*/
+struct capacity_state
+{
+	double q0;
+	double qmax;
+	double qmax_thermal;
+	double I;
+	double I_loss;
+	double SOC;
+	double DOD;
+	double DOD_prev;
+	double dt_hour;
+	bool chargeChange;
+	int prev_charge;
+	int charge;
+
+	// KiBaM only
+	double q1_0;
+	double q2_0;
+	double q1;
+	double q2;
+};
+
 /*
 Base class from which capacity models derive
 Note, all capacity models are based on the capacity of one battery
@@ -100,6 +127,10 @@ public:
 	// shallow copy from capacity to this
 	virtual void copy(capacity_t *);
 
+	// save or restore the time-varying state
+	virtual void save_state(capacity_state &state) const;
+	virtual void restore_state(const capacity_state &state);
+
 	// virtual destructor
 	virtual ~capacity_t(){};
 	
@@ -168,6 +199,9 @@ public:
 	// copy from capacity to this
 	void copy(capacity_t *);
 
+	void save_state(capacity_state &state) const;
+	void restore_state(const capacity_state &state);
+
 	void updateCapacity(double &I, double dt);
 	void updateCapacityForThermal(double capacity_percent);
 	void updateCapacityForLifetime(double capacity_percent);
@@ -236,6 +270,17 @@ public:
 protected:
 };
 
+/*
+Quantities in the voltage models which change as the battery runs
+*/
+struct voltage_state
+{
+	double cell_voltage;
+
+	// vanadium redox only
+	double I;
+};
+
 /*
 Voltage Base class.  
 All voltage models are based on one-cell, but return the voltage for one battery
@@ -252,6 +297,9 @@ public:
 	// copy from voltage to this
 	virtual void copy(voltage_t *);
 
+	// save or restore the time-varying state
+	virtual void save_state(voltage_state &state) const;
+	virtual void restore_state(const voltage_state &state);
 
 	virtual ~voltage_t(){};
 
@@ -362,6 +410,9 @@ public:
 	// copy from voltage to this
 	void copy(voltage_t *);
 
+	void save_state(voltage_state &state) const;
+	void restore_state(const voltage_state &state);
+
 	void updateVoltage(capacity_t * capacity, thermal_t * thermal, double dt);
 
 protected:
@@ -379,6 +430,41 @@ private:
 };
 
 
+/*
+Quantities in the lifetime models which change as the battery runs.
+The rainflow peaks are kept in a vector, whose storage is reused when a snapshot is overwritten
+*/
+struct lifetime_cycle_state
+{
+	int nCycles;
+	double q;
+	double Dlt;
+	int jlt;
+	double Xlt;
+	double Ylt;
+	std::vector<double> Peaks;
+	double Range;
+	double average_range;
+};
+
+struct lifetime_calendar_state
+{
+	int day_age_of_battery;
+	size_t last_idx;
+	double q;
+	double dq_old;
+	double dq_new;
+};
+
+struct lifetime_state
+{
+	lifetime_cycle_state cycle;
+	lifetime_calendar_state calendar;
+	int replacements;
+	bool replacement_scheduled;
+	double q;
+};
+
 /*
 Lifetime cycling class.  
 */
@@ -396,6 +482,10 @@ public:
 	// copy from lifetime_cycle to this
 	void copy(lifetime_cycle_t *);
 
+	// save or restore the time-varying state
+	void save_state(lifetime_cycle_state &state) const;
+	void restore_state(const lifetime_cycle_state &state);
+
 	// return q, the effective capacity percent
 	double runCycleLifetime(double DOD);
 
@@ -414,12 +504,22 @@ protected:
 	int rainflow_compareRanges();
 	double bilinear(double DOD, int cycle_number);
 
+	// build the cycles-vs-capacity curves bracketing each interval between the depths-of-discharge in the lifetime matrix
+	void init_bilinear();
+	void bilinear_bracket(double DOD, double &D_lo, double &D_hi, util::matrix_t<double> &C_n_low, util::matrix_t<double> &C_n_high);
+
 	util::matrix_t<double> _cycles_vs_DOD;
 	util::matrix_t<double> _batt_lifetime_matrix;
 	std::vector<double> _DOD_vect;
 	std::vector<double> _cycles_vect;
 	std::vector<double> _capacities_vect;
 
+	// sorted unique depths-of-discharge and the bracketing curves for DOD <= _DOD_unique[0], ..., DOD > _DOD_unique[n-1]
+	std::vector<double> _DOD_unique;
+	std::vector<double> _bracket_D_lo;
+	std::vector<double> _bracket_D_hi;
+	std::vector<util::matrix_t<double>> _bracket_C_n_low;
+	std::vector<util::matrix_t<double>> _bracket_C_n_high;
 
 	int _nCycles;
 	double _q;				// relative capacity %
@@ -454,15 +554,20 @@ public:
 	// copy from lifetime_calendar to this
 	void copy(lifetime_calendar_t *);
 
+	// save or restore the time-varying state
+	void save_state(lifetime_calendar_state &state) const;
+	void restore_state(const lifetime_calendar_state &state);
+
 	/// Given the index of the simulation, the tempertature and SOC, return the effective capacity percent
-	double runLifetimeCalendarModel(size_t idx, double T, double SOC);
+	/// Over n_steps > 1 ending at idx, T and SOC are the means over the span and the fade is taken in one update
+	double runLifetimeCalendarModel(size_t idx, double T, double SOC, size_t n_steps = 1);
 
 	void replaceBattery();
 
 	enum CALENDAR_LOSS_OPTIONS {NONE, LITHIUM_ION_CALENDAR_MODEL, CALENDAR_LOSS_TABLE};
 
 protected:
-	void runLithiumIonModel(double T, double SOC);
+	void runLithiumIonModel(double T, double SOC, size_t n_steps = 1);
 	void runTableModel();
 
 private:
@@ -510,7 +615,12 @@ public:
 	// copy lifetime to this
 	void copy(lifetime_t *);
 
-	void runLifetimeModels(size_t idx, capacity_t *, double T_battery);
+	// save or restore the time-varying state of lifetime and its cycle and calendar models
+	void save_state(lifetime_state &state) const;
+	void restore_state(const lifetime_state &state);
+
+	// run the models over n_steps starting at idx, where T_battery is the mean temperature over the steps
+	void runLifetimeModels(size_t idx, capacity_t *, double T_battery, size_t n_steps = 1);
 
 	double capacity_percent();
 
@@ -539,6 +649,16 @@ protected:
 };
 
 
+/*
+Quantities in the thermal model which change as the battery runs
+*/
+struct thermal_state
+{
+	double R;
+	double T_battery;
+	double capacity_percent;
+};
+
 /*
 Thermal classes
 */
@@ -557,7 +677,21 @@ public:
 	// copy thermal to this
 	void copy(thermal_t *);
 
+	// save or restore the time-varying state
+	void save_state(thermal_state &state) const;
+	void restore_state(const thermal_state &state);
+
 	void updateTemperature(double I, double R, double dt, size_t lifetimeIndex);
+
+	// relax the temperature at zero current over n_steps, returning the mean temperature over the steps
+	double updateTemperatureIdle(size_t lifetimeIndex, size_t n_steps);
+
+	// number of steps from lifetimeIndex, up to n_max, with the same room temperature
+	size_t stepsAtRoomTemperature(size_t lifetimeIndex, size_t n_max);
+
+	// number of steps from lifetimeIndex, up to n_max, which an idle battery at the room temperature can take together
+	size_t idleSteps(size_t lifetimeIndex, size_t n_max);
+
 	void replace_battery(size_t lifetimeIndex);
 
 	// outputs
@@ -591,6 +725,12 @@ protected:
 	message _message;
 
 };
+/// Quantities in the losses model which change as the battery runs
+struct losses_state
+{
+	int nCycle;
+};
+
 /**
 * \class losses_t
 *
@@ -634,8 +774,12 @@ public:
 	/// Copy input losses to this object
 	void copy(losses_t *);
 
-	/// Run the losses model at the present simulation index (for year 1 only)
-	void run_losses(size_t lifetimeIndex);
+	/// Save or restore the time-varying state
+	void save_state(losses_state &state) const;
+	void restore_state(const losses_state &state);
+
+	/// Run the losses model at the present simulation index (for year 1 only), or over n_steps from it
+	void run_losses(size_t lifetimeIndex, size_t n_steps = 1);
 
 	/// Replace the battery
 	void replace_battery();
@@ -661,6 +805,21 @@ protected:
 	double_vec  _full_loss;
 };
 
+/*
+Snapshot of the time-varying state of a battery and all its models.
+Saving and restoring a snapshot does not copy any model parameters or allocate memory once the snapshot has been used,
+so it is the preferred way for dispatch to reset the battery between iterations of a time step
+*/
+struct battery_state
+{
+	capacity_state capacity;
+	voltage_state voltage;
+	thermal_state thermal;
+	lifetime_state lifetime;
+	losses_state losses;
+	size_t last_idx;
+};
+
 /*
 Class which encapsulates a battery and all its models
 */
@@ -677,6 +836,10 @@ public:
 	// copy members from battery to this
 	void copy(const battery_t * battery);
 
+	// save or restore the time-varying state of the battery
+	void save_state(battery_state &state) const;
+	void restore_state(const battery_state &state);
+
 	// virtual destructor, does nothing as no memory allocated in constructor
 	virtual ~battery_t();
 
@@ -688,19 +851,21 @@ public:
 	// Run all for single time step
 	void run(size_t lifetimeIndex, double I);
 
+	// Run all at zero current for n_steps time steps, advancing the steps spent at the room temperature in one update
+	void run_idle(size_t lifetimeIndex, size_t n_steps = 1);
+
 	// Run a component level model
 	void runCapacityModel(double &I);
 	void runVoltageModel();
 	void runThermalModel(double I, size_t lifetimeIndex);
 	void runLifetimeModel(size_t lifetimeIndex);
-	void runLossesModel(size_t lifetimeIndex);
+	void runLifetimeModel(size_t lifetimeIndex, double T_battery, size_t n_steps);
+	void runLossesModel(size_t lifetimeIndex, size_t n_steps = 1);
 
 	capacity_t * capacity_model() const;
-	capacity_t * capacity_initial_model() const;
 	voltage_t * voltage_model() const;
 	lifetime_t * lifetime_model() const;
 	thermal_t * thermal_model() const;
-	thermal_t * thermal_initial_model() const;
 	losses_t * losses_model() const;
 
 	// Get capacity quantities
@@ -724,9 +889,7 @@ public:
 
 private:
 	capacity_t * _capacity;
-	capacity_t * _capacity_initial;
 	thermal_t * _thermal;
-	thermal_t * _thermal_initial;
 	lifetime_t * _lifetime;
 	voltage_t * _voltage;
 	losses_t * _losses;
@@ -45,12 +45,14 @@
 *******************************************************************************************************/
 
 #include "lib_battery_dispatch.h"
+#include "lib_battery_dispatch_lp.h"
 #include "lib_battery_powerflow.h"
 #include "lib_shared_inverter.h"
 #include "lib_utility_rate.h"
 
 #include <math.h>
 #include <algorithm>
+#include <functional>
 #include <numeric>
 
 /*
@@ -71,9 +73,9 @@ dispatch_t::dispatch_t(battery_t * Battery, double dt_hour, double SOC_min, doub
 	m_batteryPower->powerBatteryDischargeMax = Pd_max;
 	m_batteryPower->meterPosition = battMeterPosition;
 
-	// initalize Battery and a copy of the Battery for iteration
+	// initalize Battery and a snapshot of its state for iteration
 	_Battery = Battery;
-	_Battery_initial = new battery_t(*_Battery);
+	_Battery->save_state(_Battery_initial);
 
 	// Call the dispatch init method
 	init(_Battery, dt_hour, current_choice, t_min, mode);
@@ -92,6 +94,8 @@ void dispatch_t::init(battery_t * Battery, double dt_hour, int current_choice, d
 	_charging = false;
 	_e_max = Battery->battery_voltage()*Battery->battery_charge_maximum()*util::watt_to_kilowatt*0.01*(m_batteryPower->stateOfChargeMax - m_batteryPower->stateOfChargeMin);
 	_grid_recharge = false;
+	_idle_index_end = 0;
+	_idle_steps_skipped = 0;
 
 	// initialize powerflow model
 	m_batteryPower->canClipCharge = false;
@@ -108,7 +112,7 @@ dispatch_t::dispatch_t(const dispatch_t& dispatch)
 	m_batteryPower = m_batteryPowerFlow->getBatteryPower();
 
 	_Battery = new battery_t(*dispatch._Battery);
-	_Battery_initial = new battery_t(*dispatch._Battery_initial);
+	_Battery_initial = dispatch._Battery_initial;
 	init(_Battery, dispatch._dt_hour, dispatch._current_choice, dispatch._t_min, dispatch._mode);
 }
 
@@ -116,7 +120,7 @@ dispatch_t::dispatch_t(const dispatch_t& dispatch)
 void dispatch_t::copy(const dispatch_t * dispatch)
 {
 	_Battery->copy(dispatch->_Battery);
-	_Battery_initial->copy(dispatch->_Battery_initial);
+	_Battery_initial = dispatch->_Battery_initial;
 	init(_Battery, dispatch->_dt_hour,  dispatch->_current_choice, dispatch->_t_min, dispatch->_mode);
 
 	// can't create shallow copy of unique ptr
@@ -126,25 +130,25 @@ void dispatch_t::copy(const dispatch_t * dispatch)
 }
 void dispatch_t::delete_clone()
 {
-	// need to delete both, since allocated memory for both in deep copy 
+	// allocated memory for the battery in deep copy 
 	if (_Battery) delete _Battery;
-	if (_Battery_initial) delete _Battery_initial;
 }
 dispatch_t::~dispatch_t()
 {
 	// original _Battery doesn't need deleted, since was a pointer passed in
-	_Battery_initial->delete_clone();
-	delete _Battery_initial;
 }
 void dispatch_t::finalize(size_t idx, double &I)
 {
-	_Battery->copy(_Battery_initial);
+	_Battery->restore_state(_Battery_initial);
 	m_batteryPower->powerBatteryDC = 0;
 	m_batteryPower->powerBatteryAC = 0;
 	m_batteryPower->powerGridToBattery = 0;
 	m_batteryPower->powerBatteryToGrid = 0;
 	m_batteryPower->powerPVToGrid = 0;
-	_Battery->run(idx, I);
+	if (I == 0)
+		_Battery->run_idle(idx);
+	else
+		_Battery->run(idx, I);
 }
 
 bool dispatch_t::check_constraints(double &I, size_t count)
@@ -204,7 +208,7 @@ bool dispatch_t::check_constraints(double &I, size_t count)
 	// reset
 	if (iterate)
 	{
-		_Battery->copy(_Battery_initial);
+		_Battery->restore_state(_Battery_initial);
 		m_batteryPower->powerBatteryDC = 0;
 		m_batteryPower->powerBatteryAC = 0;
 		m_batteryPower->powerGridToBattery = 0;
@@ -334,17 +338,41 @@ void dispatch_t::runDispatch(size_t year, size_t hour_of_year, size_t step)
 
 	// Calculate current, and ensure the battery falls within the current limits
 	double I = current_controller(_Battery->battery_voltage_nominal());
+	size_t lifetimeIndex = util::lifetimeIndex(year, hour_of_year, step, static_cast<size_t>(1 / _dt_hour));
+
+	// Once the battery sits at the room temperature, a span of steps which are idle whatever its state is run in one update
+	if (I == 0 && lifetimeIndex >= _idle_index_end)
+	{
+		size_t n = idle_steps(hour_of_year, step);
+		if (n > 1)
+			n = _Battery->thermal_model()->idleSteps(lifetimeIndex, n);
+		if (n > 1)
+		{
+			_Battery->run_idle(lifetimeIndex, n);
+			_idle_index_end = lifetimeIndex + n;
+			_idle_steps_skipped += n - 1;
+		}
+	}
+	if (I == 0 && lifetimeIndex < _idle_index_end)
+	{
+		m_batteryPower->powerBatteryDC = 0;
+		m_batteryPowerFlow->calculate();
+		_prev_charging = _charging;
+		return;
+	}
 
 	// Setup battery iteration
-	_Battery_initial->copy(_Battery);
+	_Battery->save_state(_Battery_initial);
 	bool iterate = true;
 	size_t count = 0;
-	size_t lifetimeIndex = util::lifetimeIndex(year, hour_of_year, step, static_cast<size_t>(1 / _dt_hour));
 
 	do {
 
 		// Run Battery Model to update charge based on charge/discharge
-		_Battery->run(lifetimeIndex, I);
+		if (I == 0)
+			_Battery->run_idle(lifetimeIndex);
+		else
+			_Battery->run(lifetimeIndex, I);
 
 		// Update how much power was actually used to/from battery
 		I = _Battery->capacity_model()->I();
@@ -443,18 +471,35 @@ void dispatch_manual_t::copy(const dispatch_t * dispatch)
 		tmp->_percent_discharge_array, tmp->_percent_charge_array);
 }
 
-void dispatch_manual_t::prepareDispatch(size_t hour_of_year, size_t )
+size_t dispatch_manual_t::schedule_profile(size_t hour_of_year)
 {
 	size_t m, h;
 	util::month_hour(hour_of_year, m, h);
 	size_t column = h - 1;
-	size_t iprofile = 0;
 
 	bool is_weekday = util::weekday(hour_of_year);
 	if (!is_weekday && _mode == MANUAL)
-		iprofile = _sched_weekend(m - 1, column);
+		return _sched_weekend(m - 1, column);
 	else
-		iprofile = _sched(m - 1, column);  // 1-based
+		return _sched(m - 1, column);  // 1-based
+}
+size_t dispatch_manual_t::idle_steps(size_t hour_of_year, size_t step)
+{
+	size_t steps_per_hour = static_cast<size_t>(1 / _dt_hour);
+	size_t n = 0;
+	for (size_t hour = hour_of_year; hour == hour_of_year || hour % 24 != 0; hour++)
+	{
+		size_t iprofile = schedule_profile(hour);
+		if (_charge_array[iprofile - 1] || _discharge_array[iprofile - 1] || _gridcharge_array[iprofile - 1] ||
+			(iprofile < _fuelcellcharge_array.size() && _fuelcellcharge_array[iprofile - 1]))
+			break;
+		n += (hour == hour_of_year ? steps_per_hour - step : steps_per_hour);
+	}
+	return n > 1 ? n : 1;
+}
+void dispatch_manual_t::prepareDispatch(size_t hour_of_year, size_t )
+{
+	size_t iprofile = schedule_profile(hour_of_year);
 
 	m_batteryPower->canPVCharge = _charge_array[iprofile - 1];
 	m_batteryPower->canDischarge = _discharge_array[iprofile - 1];
@@ -563,7 +608,7 @@ bool dispatch_manual_t::check_constraints(double &I, size_t count)
 		// reset
 		if (iterate)
 		{
-			_Battery->copy(_Battery_initial);
+			_Battery->restore_state(_Battery_initial);
 			m_batteryPower->powerBatteryDC = 0;
 			m_batteryPower->powerBatteryAC = 0;
 			m_batteryPower->powerGridToBattery = 0;
@@ -657,6 +702,8 @@ dispatch_automatic_t::dispatch_automatic_t(
 	m_batteryPower->canDischarge = true;
 }
 
+dispatch_automatic_t::~dispatch_automatic_t(){ /* NOTHING TO DO */}
+
 void dispatch_automatic_t::init_with_pointer(const dispatch_automatic_t * tmp)
 {
 	_day_index = tmp->_day_index;
@@ -695,6 +742,15 @@ void dispatch_automatic_t::set_custom_dispatch(std::vector<double> P_batt_dc) {
 int dispatch_automatic_t::get_mode(){ return _mode; }
 double dispatch_automatic_t::power_batt_target() { return m_batteryPower->powerBatteryTarget; };
 
+void dispatch_automatic_t::set_lp_battery_limits(double safety_factor)
+{
+	// [kWh] - energy between the minimum and maximum state of charge, and above the minimum now
+	double E_per_SOC = _Battery->battery_voltage() *_Battery->battery_charge_maximum() * 0.01 * util::watt_to_kilowatt;
+	m_lp->energy_max = E_per_SOC * (m_batteryPower->stateOfChargeMax - m_batteryPower->stateOfChargeMin) * (1 - safety_factor);
+	m_lp->energy_initial = E_per_SOC * (_Battery->battery_soc() - m_batteryPower->stateOfChargeMin);
+	m_lp->charge_max = m_batteryPower->powerBatteryChargeMax;
+}
+
 void dispatch_automatic_t::dispatch(size_t year,
 	size_t hour_of_year,
 	size_t step)
@@ -825,7 +881,7 @@ bool dispatch_automatic_t::check_constraints(double &I, size_t count)
 		// reset
 		if (iterate)
 		{
-			_Battery->copy(_Battery_initial);
+			_Battery->restore_state(_Battery_initial);
 			m_batteryPower->powerBatteryDC = 0;
 			m_batteryPower->powerBatteryAC = 0;
 			m_batteryPower->powerGridToBattery = 0;
@@ -865,11 +921,13 @@ dispatch_automatic_behind_the_meter_t::dispatch_automatic_behind_the_meter_t(
 
 	grid.reserve(_num_steps);
 	sorted_grid.reserve(_num_steps);
+	_E_charge.reserve(_num_steps);
 
 	for (size_t ii = 0; ii != _num_steps; ii++)
 	{
 		grid.push_back(grid_point(0., 0, 0));
-		sorted_grid.push_back(grid[ii]);
+		sorted_grid.push_back(0.);
+		_E_charge.push_back(0.);
 	}
 }
 
@@ -884,6 +942,9 @@ void dispatch_automatic_behind_the_meter_t::init_with_pointer(const dispatch_aut
 	_P_load_dc = tmp->_P_load_dc;
 	_P_target_use = tmp->_P_target_use;
 	sorted_grid = tmp->sorted_grid;
+	_E_charge = tmp->_E_charge;
+
+	set_lp_dispatch(tmp->m_lp != NULL);
 }
 
 // deep copy from dispatch to this
@@ -916,6 +977,12 @@ void dispatch_automatic_behind_the_meter_t::dispatch(size_t year,
 void dispatch_automatic_behind_the_meter_t::update_load_data(std::vector<double> P_load_dc){ _P_load_dc = P_load_dc; }
 void dispatch_automatic_behind_the_meter_t::set_target_power(std::vector<double> P_target){ _P_target_input = P_target; }
 double dispatch_automatic_behind_the_meter_t::power_grid_target() { return _P_target_current; };
+void dispatch_automatic_behind_the_meter_t::set_lp_dispatch(bool enable)
+{
+	m_lp.reset();
+	if (enable && (_mode == dispatch_t::LOOK_AHEAD || _mode == dispatch_t::LOOK_BEHIND))
+		m_lp.reset(new dispatch_lp_t(_num_steps, _dt_hour, dispatch_lp_t::MINIMIZE_PEAK));
+}
 void dispatch_automatic_behind_the_meter_t::update_dispatch(size_t hour_of_year, size_t step, size_t idx)
 {
 	bool debug = false;
@@ -941,12 +1008,15 @@ void dispatch_automatic_behind_the_meter_t::update_dispatch(size_t hour_of_year,
 			// compute grid power, sort highest to lowest
 			sort_grid(p, debug, idx);
 
-			// Peak shaving scheme
-			compute_energy(p, debug, E_max);
-			target_power(p, debug, E_max, idx);
+			// Peak shaving scheme, the heuristic is used if the linear program is off or has no solution
+			if (!m_lp || !lp_power(p, debug))
+			{
+				compute_energy(p, debug, E_max);
+				target_power(p, debug, E_max, idx);
 
-			// Set battery power profile
-			set_battery_power(p, debug);
+				// Set battery power profile
+				set_battery_power(p, debug);
+			}
 		}
 		// save for extraction
 		_P_target_current = _P_target_use[_day_index];
@@ -975,7 +1045,7 @@ void dispatch_automatic_behind_the_meter_t::initialize(size_t hour_of_year)
 	for (size_t ii = 0; ii != _num_steps; ii++)
 	{
 		grid[ii] = grid_point(0., 0, 0); 
-		sorted_grid[ii] = grid[ii];
+		sorted_grid[ii] = 0.;
 		_P_target_use.push_back(0.);
 		_P_battery_use.push_back(0.);
 	}
@@ -1027,7 +1097,7 @@ void dispatch_automatic_behind_the_meter_t::sort_grid(FILE *p, bool debug, size_
 		for (size_t step = 0; step != _steps_per_hour; step++)
 		{
 			grid[count] = grid_point(_P_load_dc[idx] - _P_pv_dc[idx], hour, step);
-			sorted_grid[count] = grid[count];
+			sorted_grid[count] = grid[count].Grid();
 
 			if (debug)
 				fprintf(p, "%zu\t %.1f\t %.1f\t %.1f\n", count, _P_load_dc[idx], _P_pv_dc[idx], _P_load_dc[idx] - _P_pv_dc[idx]);
@@ -1036,7 +1106,7 @@ void dispatch_automatic_behind_the_meter_t::sort_grid(FILE *p, bool debug, size_
 			count++;
 		}
 	}
-	std::sort(sorted_grid.begin(), sorted_grid.end(), byGrid());
+	std::sort(sorted_grid.begin(), sorted_grid.end(), std::greater<double>());
 }
 
 void dispatch_automatic_behind_the_meter_t::compute_energy(FILE *p, bool debug, double & E_max)
@@ -1058,12 +1128,11 @@ void dispatch_automatic_behind_the_meter_t::target_power(FILE*p, bool debug, dou
 	{
 		double_vec::const_iterator first = _P_target_input.begin() + idx;
 		double_vec::const_iterator last = _P_target_input.begin() + idx + _num_steps;
-		double_vec tmp(first, last);
-		_P_target_use = tmp;
+		_P_target_use.assign(first, last);
 		return;
 	}
 	// don't calculate if peak grid demand is less than a previous target in the month
-	else if (sorted_grid[0].Grid() < _P_target_month)
+	else if (sorted_grid[0] < _P_target_month)
 	{
 		for (size_t i = 0; i != _num_steps; i++)
 			_P_target_use[i] = _P_target_month;
@@ -1076,41 +1145,20 @@ void dispatch_automatic_behind_the_meter_t::target_power(FILE*p, bool debug, dou
 		if (debug)
 			fprintf(p, "Index\tRecharge_target\t charge_energy\n");
 
-		double P_target = sorted_grid[0].Grid();
-		double P_target_min = 1e16;
-		double E_charge = 0.;
-		int index = (int)_num_steps - 1;
-		std::vector<double> E_charge_vec;
-		for (int jj = (int)_num_steps - 1; jj >= 0; jj--)
-		{
-			E_charge = 0.;
-			P_target_min = sorted_grid[index].Grid();
-
-			for (int ii = (int)_num_steps - 1; ii >= 0; ii--)
-			{
-				if (sorted_grid[ii].Grid() > P_target_min)
-					break;
-
-				E_charge += (P_target_min - sorted_grid[ii].Grid())*_dt_hour;
-			}
-			E_charge_vec.push_back(E_charge);
-			if (debug)
-				fprintf(p, "%u: index\t%.3f\t %.3f\n", index, P_target_min, E_charge);
-			index--;
+		// The energy which can be recharged with the target at sorted grid power k is the sum over j >= k of (P_k - P_j)*dt.
+		// Accumulate it from the lowest grid power up so that the whole vector is computed in one pass.
+		_E_charge[_num_steps - 1] = 0.;
+		for (size_t k = _num_steps - 1; k > 0; k--)
+			_E_charge[k - 1] = _E_charge[k] + (sorted_grid[k - 1] - sorted_grid[k]) * (_num_steps - k) * _dt_hour;
 
-			if (index < 0)
-				break;
+		if (debug)
+		{
+			for (size_t k = 0; k != _num_steps; k++)
+				fprintf(p, "%zu: index\t%.3f\t %.3f\n", k, sorted_grid[k], _E_charge[k]);
 		}
-		std::reverse(E_charge_vec.begin(), E_charge_vec.end());
 
 		// Calculate target power 
-		std::vector<double> sorted_grid_diff;
-		sorted_grid_diff.reserve(_num_steps - 1);
-
-		for (size_t ii = 0; ii != _num_steps - 1; ii++)
-			sorted_grid_diff.push_back(sorted_grid[ii].Grid() - sorted_grid[ii + 1].Grid());
-
-		P_target = sorted_grid[0].Grid(); // target power to shave to [kW]
+		double P_target = sorted_grid[0]; // target power to shave to [kW]
 		double sum = 0;			   // energy [kWh];
 		if (debug)
 			fprintf(p, "Step\tTarget_Power\tEnergy_Sum\tEnergy_charged\n");
@@ -1118,17 +1166,18 @@ void dispatch_automatic_behind_the_meter_t::target_power(FILE*p, bool debug, dou
 		for (size_t ii = 0; ii != _num_steps - 1; ii++)
 		{
 			// don't look at negative grid power
-			if (sorted_grid[ii + 1].Grid() < 0)
+			if (sorted_grid[ii + 1] < 0)
 				break;
 			// Update power target
 			else
-				P_target = sorted_grid[ii + 1].Grid();
+				P_target = sorted_grid[ii + 1];
 
 			if (debug)
 				fprintf(p, "%zu\t %.3f\t", ii, P_target);
 
 			// implies a repeated power
-			if (sorted_grid_diff[ii] == 0)
+			double sorted_grid_diff = sorted_grid[ii] - sorted_grid[ii + 1];
+			if (sorted_grid_diff == 0)
 			{
 				if (debug)
 					fprintf(p, "\n");
@@ -1136,20 +1185,20 @@ void dispatch_automatic_behind_the_meter_t::target_power(FILE*p, bool debug, dou
 			}
 			// add to energy we are trimming
 			else
-				sum += sorted_grid_diff[ii] * (ii + 1)*_dt_hour;
+				sum += sorted_grid_diff * (ii + 1)*_dt_hour;
 
 			if (debug)
-				fprintf(p, "%.3f\t%.3f\n", sum, E_charge_vec[ii + 1]);
+				fprintf(p, "%.3f\t%.3f\n", sum, _E_charge[ii + 1]);
 
-			if (sum < E_charge_vec[ii + 1] && sum < E_useful)
+			if (sum < _E_charge[ii + 1] && sum < E_useful)
 				continue;
 			// we have limited power, we'll shave what more we can
-			else if (sum > E_charge_vec[ii + 1])
+			else if (sum > _E_charge[ii + 1])
 			{
-				P_target += (sum - E_charge_vec[ii]) / ((ii + 1)*_dt_hour);
-				sum = E_charge_vec[ii];
+				P_target += (sum - _E_charge[ii]) / ((ii + 1)*_dt_hour);
+				sum = _E_charge[ii];
 				if (debug)
-					fprintf(p, "%zu\t %.3f\t%.3f\t%.3f\n", ii, P_target, sum, E_charge_vec[ii]);
+					fprintf(p, "%zu\t %.3f\t%.3f\t%.3f\n", ii, P_target, sum, _E_charge[ii]);
 				break;
 			}
 			// only allow one cycle per day
@@ -1158,7 +1207,7 @@ void dispatch_automatic_behind_the_meter_t::target_power(FILE*p, bool debug, dou
 				P_target += (sum - E_useful) / ((ii + 1)*_dt_hour);
 				sum = E_useful;
 				if (debug)
-					fprintf(p, "%zu\t %.3f\t%.3f\t%.3f\n", ii, P_target, sum, E_charge_vec[ii]);
+					fprintf(p, "%zu\t %.3f\t%.3f\t%.3f\n", ii, P_target, sum, _E_charge[ii]);
 				break;
 			}
 		}
@@ -1193,6 +1242,44 @@ void dispatch_automatic_behind_the_meter_t::set_battery_power(FILE *p, bool debu
 	}
 }
 
+bool dispatch_automatic_behind_the_meter_t::lp_power(FILE *p, bool debug)
+{
+	set_lp_battery_limits(_safety_factor);
+	m_lp->peak_min = std::fmax(_P_target_month, 0);
+
+	// the battery can only charge from PV which would be exported, and can't discharge to the grid
+	for (size_t i = 0; i != _num_steps; i++)
+	{
+		double P_grid = grid[i].Grid();
+		m_lp->net_load[i] = P_grid;
+		m_lp->charge_pv_max[i] = m_batteryPower->canPVCharge ? std::fmax(-P_grid, 0) : 0;
+		m_lp->charge_clip_max[i] = 0;
+		m_lp->charge_grid_max[i] = m_batteryPower->canGridCharge ? m_batteryPower->powerBatteryChargeMax : 0;
+		m_lp->discharge_max[i] = std::fmin(m_batteryPower->powerBatteryDischargeMax, std::fmax(P_grid, 0));
+	}
+
+	if (!m_lp->solve())
+		return false;
+
+	double P_target = m_lp->peak();
+	if (P_target > _P_target_month)
+		_P_target_month = P_target;
+
+	for (size_t i = 0; i != _num_steps; i++)
+	{
+		_P_target_use[i] = P_target;
+		_P_battery_use[i] = m_lp->battery_power()[i];
+	}
+
+	if (debug)
+	{
+		fprintf(p, "LP peak: %.3f\n", P_target);
+		for (size_t i = 0; i != _num_steps; i++)
+			fprintf(p, "i=%zu  P_battery: %.2f\n", i, _P_battery_use[i]);
+	}
+	return true;
+}
+
 dispatch_automatic_front_of_meter_t::dispatch_automatic_front_of_meter_t(
 	battery_t * Battery,
 	double dt_hour,
@@ -1248,6 +1335,7 @@ dispatch_automatic_front_of_meter_t::dispatch_automatic_front_of_meter_t(
 	if (battCycleCostChoice == dispatch_t::INPUT_CYCLE_COST) {
 		m_cycleCost = battCycleCost;
 	}
+	m_lpSolved = false;
 	
 	setup_cost_vector(ppa_weekday_schedule, ppa_weekend_schedule);
 }
@@ -1263,6 +1351,16 @@ void dispatch_automatic_front_of_meter_t::init_with_pointer(const dispatch_autom
 	m_etaPVCharge = tmp->m_etaPVCharge;
 	m_etaGridCharge = tmp->m_etaGridCharge;
 	m_etaDischarge = tmp->m_etaDischarge;
+
+	set_lp_dispatch(tmp->m_lp != NULL);
+}
+
+void dispatch_automatic_front_of_meter_t::set_lp_dispatch(bool enable)
+{
+	m_lp.reset();
+	m_lpSolved = false;
+	if (enable && (_mode == dispatch_t::FOM_LOOK_AHEAD || _mode == dispatch_t::FOM_LOOK_BEHIND || _mode == dispatch_t::FOM_FORECAST))
+		m_lp.reset(new dispatch_lp_t(_look_ahead_hours * _steps_per_hour, _dt_hour, dispatch_lp_t::MAXIMIZE_REVENUE));
 }
 
 void dispatch_automatic_front_of_meter_t::setup_cost_vector(util::matrix_t<size_t> ppa_weekday_schedule, util::matrix_t<size_t> ppa_weekend_schedule)
@@ -1317,7 +1415,7 @@ void dispatch_automatic_front_of_meter_t::dispatch(size_t year,
 	dispatch_automatic_t::dispatch(year, hour_of_year, step);
 }
 
-void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, size_t , size_t lifetimeIndex)
+void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, size_t step, size_t lifetimeIndex)
 {
 	// Initialize
 	m_batteryPower->powerBatteryDC = 0;
@@ -1331,7 +1429,8 @@ void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, s
 		// Power to charge (<0) or discharge (>0)
 		double powerBattery = 0;
 
-		if (lifetimeIndex == _index_last_updated + _d_index_update || lifetimeIndex == 0)
+		bool update = lifetimeIndex == _index_last_updated + _d_index_update || lifetimeIndex == 0;
+		if (update)
 		{
 			if (lifetimeIndex > 0) {
 				_index_last_updated += _d_index_update;
@@ -1339,7 +1438,20 @@ void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, s
 
 			/*! Cost to cycle the battery at all, using maximum DOD or user input */
 			costToCycle();
-			 
+
+			// Optimize over the look ahead period, the heuristic is used if the linear program is off or has no solution
+			m_lpSolved = m_lp && lp_power(hour_of_year, step, lifetimeIndex);
+		}
+
+		// Follow the optimized schedule until the next update
+		if (m_lpSolved)
+		{
+			size_t offset = lifetimeIndex - _index_last_updated;
+			if (offset < m_lp->num_steps())
+				powerBattery = m_lp->battery_power()[offset];
+		}
+		else if (update)
+		{
 			// Compute forecast variables which don't change from year to year
 			auto max_ppa_cost = std::max_element(_ppa_cost_vector.begin() + hour_of_year, _ppa_cost_vector.begin() + hour_of_year + _look_ahead_hours);
 			double ppa_cost = _ppa_cost_vector[hour_of_year];
@@ -1437,6 +1549,39 @@ void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, s
 	m_batteryPower->powerBatteryDC = m_batteryPower->powerBatteryTarget;
 }
 
+bool dispatch_automatic_front_of_meter_t::lp_power(size_t hour_of_year, size_t step, size_t lifetimeIndex)
+{
+	set_lp_battery_limits(0);
+
+	// forecasts past the end of the simulation wrap around to the start
+	for (size_t i = 0; i != m_lp->num_steps(); i++)
+	{
+		size_t hour = (hour_of_year + (step + i) / _steps_per_hour) % _ppa_cost_vector.size();
+		double ppa_cost = _ppa_cost_vector[hour];
+
+		/*! Cost to purchase electricity from the utility */
+		double usage_cost = ppa_cost;
+		if (m_utilityRateCalculator) {
+			usage_cost = m_utilityRateCalculator->getEnergyRate(hour % 8760);
+		}
+
+		size_t idx = lifetimeIndex + i;
+		double P_pv = _P_pv_dc.size() ? _P_pv_dc[idx % _P_pv_dc.size()] : 0;
+		double P_clipped = _P_cliploss_dc.size() ? _P_cliploss_dc[idx % _P_cliploss_dc.size()] : 0;
+
+		m_lp->charge_pv_max[i] = m_batteryPower->canPVCharge ? std::fmax(P_pv - P_clipped, 0) : 0;
+		m_lp->charge_clip_max[i] = m_batteryPower->canClipCharge ? P_clipped : 0;
+		m_lp->charge_grid_max[i] = m_batteryPower->canGridCharge ? m_batteryPower->powerBatteryChargeMax : 0;
+		m_lp->discharge_max[i] = std::fmin(m_batteryPower->powerBatteryDischargeMax, std::fmax(_inverter_paco - P_pv, 0));
+
+		// same economics as the heuristic, with the cycle cost charged on energy discharged
+		m_lp->value_discharge[i] = ppa_cost * m_etaDischarge - m_cycleCost;
+		m_lp->cost_charge_pv[i] = ppa_cost / m_etaPVCharge;
+		m_lp->cost_charge_grid[i] = usage_cost / m_etaGridCharge;
+	}
+	return m_lp->solve();
+}
+
 void dispatch_automatic_front_of_meter_t::update_cliploss_data(double_vec P_cliploss)
 {
 	_P_cliploss_dc = P_cliploss;
@@ -60,6 +60,7 @@ struct BatteryPower;
 class BatteryPowerFlow;
 class UtilityRate;
 class UtilityRateCalculator;
+class dispatch_lp_t;
 
 namespace battery_dispatch
 {
@@ -143,6 +144,9 @@ public:
 
 	message get_messages();
 
+	/// Number of idle time steps advanced together with an earlier step rather than run individually
+	size_t idle_steps_skipped() { return _idle_steps_skipped; }
+
 	/// Return a pointer to the underlying calculated power quantities
 	BatteryPower * getBatteryPower();
 
@@ -161,6 +165,9 @@ protected:
 		double t_min,
 		int mode);
 
+	/// Number of steps from this one for which the dispatch holds the battery idle whatever its state, at least one
+	virtual size_t idle_steps(size_t, size_t) { return 1; }
+
 	// Controllers
 	virtual	void SOC_controller();
 	void switch_controller();
@@ -169,7 +176,9 @@ protected:
 	bool restrict_power(double &I);
 
 	battery_t * _Battery;
-	battery_t * _Battery_initial;
+
+	// state of the battery at the start of the time step, restored between iterations
+	battery_state _Battery_initial;
 
 	double _dt_hour;
 
@@ -198,6 +207,10 @@ protected:
 	bool _prev_charging;
 	bool _grid_recharge;
 
+	// idle steps already advanced by the battery model, up to but excluding this lifetime index
+	size_t _idle_index_end;
+	size_t _idle_steps_skipped;
+
 	// messages
 	message _message;
 };
@@ -247,6 +260,12 @@ protected:
 	/// Helper function to internally set up the dispatch model
 	virtual void prepareDispatch(size_t hour_of_year, size_t step);
 
+	/// The 1-based schedule profile in effect for the hour
+	size_t schedule_profile(size_t hour_of_year);
+
+	/// Steps until the end of the day whose profiles allow no charging or discharging
+	size_t idle_steps(size_t hour_of_year, size_t step);
+
 	// Initialization help
 	void init(util::matrix_t<float> dm_dynamic_sched,
 		util::matrix_t<float> dm_dynamic_sched_weekend,
@@ -301,13 +320,6 @@ private:
 	size_t _step;
 };
 
-struct byGrid
-{
-	bool operator()(grid_point const  &a, grid_point const &b)
-	{
-		return a.Grid() > b.Grid();
-	}
-};
 typedef std::vector<grid_point> grid_vec;
 
 /*! Automated dispatch base class */
@@ -342,7 +354,7 @@ public:
 		bool can_fuelcell_charge
 		);
 
-	virtual ~dispatch_automatic_t(){};
+	virtual ~dispatch_automatic_t();
 
 	// deep copy constructor (new memory), from dispatch to this
 	dispatch_automatic_t(const dispatch_t& dispatch);
@@ -370,11 +382,20 @@ public:
 	/// Return the battery power target set by the controller
 	double power_batt_target();
 
+	/*! Use a rolling-horizon linear program rather than the heuristic for the look-ahead, look-behind and forecast modes */
+	virtual void set_lp_dispatch(bool enable)=0;
+
+	/*! Return the linear program, or NULL if the heuristic is used */
+	const dispatch_lp_t * lp_dispatch() const { return m_lp.get(); }
+
 protected:
 
 	/*! Initialize with a pointer*/
 	void init_with_pointer(const dispatch_automatic_t * tmp);
 
+	/*! Set the charge power and energy limits of the linear program from the current battery state */
+	void set_lp_battery_limits(double safety_factor);
+
 	/*! Return the dispatch mode */
 	int get_mode();
 
@@ -422,6 +443,9 @@ protected:
 
 	/*! The hours to look ahead in the simulation [hour] */
 	size_t _look_ahead_hours;
+
+	/*! Optional linear program for the dispatch */
+	std::unique_ptr<dispatch_lp_t> m_lp;
 };
 
 /*! Automated dispatch class for behind-the-meter connections */
@@ -473,6 +497,9 @@ public:
 	/*! Compute the updated power to send to the battery over the next N hours */
 	void update_dispatch(size_t hour_of_year, size_t step, size_t idx);
 
+	/*! Minimize the daily peak grid import with a linear program */
+	void set_lp_dispatch(bool enable);
+
 	/*! Pass in the load forecast */
 	void update_load_data(std::vector<double> P_load_dc);
 
@@ -496,6 +523,7 @@ protected:
 	void target_power(FILE*p, bool debug, double E_max, size_t idx);
 	void set_battery_power(FILE *p, bool debug);
 	void check_new_month(size_t hour_of_year, size_t step);
+	bool lp_power(FILE *p, bool debug);
 
 	/*! Full time-series of loads [kW] */
 	double_vec _P_load_dc;
@@ -515,8 +543,11 @@ protected:
 	/* Vector of length (24 hours * steps_per_hour) containing grid calculation [P_grid, hour, step] */
 	grid_vec grid; 
 
-	/* Vector of length (24 hours * steps_per_hour) containing sorted grid calculation [P_grid, hour, step] */
-	grid_vec sorted_grid;
+	/* Vector of length (24 hours * steps_per_hour) containing grid power sorted from highest to lowest [kW] */
+	double_vec sorted_grid;
+
+	/* Vector of length (24 hours * steps_per_hour) containing the energy which could be recharged with the target at each sorted grid power [kWh] */
+	double_vec _E_charge;
 };
 
 /*! Automated Front of Meter DC-connected battery dispatch */
@@ -580,6 +611,9 @@ public:
 	/// Compute the updated power to send to the battery over the next N hours
 	void update_dispatch(size_t hour_of_year, size_t step, size_t lifetimeIndex);
 
+	/// Maximize the revenue over the look ahead period with a linear program
+	void set_lp_dispatch(bool enable);
+
 	/// Update cliploss data
 	void update_cliploss_data(double_vec P_cliploss);
 
@@ -593,6 +627,7 @@ protected:
 	
 	void init_with_pointer(const dispatch_automatic_front_of_meter_t* tmp);
 	void setup_cost_vector(util::matrix_t<size_t> ppa_weekday_schedule, util::matrix_t<size_t> ppa_weekend_schedule);
+	bool lp_power(size_t hour_of_year, size_t step, size_t lifetimeIndex);
 
 	/*! Full clipping loss due to AC power limits vector */
 	double_vec _P_cliploss_dc;
@@ -618,6 +653,9 @@ protected:
 	double m_etaPVCharge;
 	double m_etaGridCharge;
 	double m_etaDischarge;
+
+	/*! The linear program was solved at the last update */
+	bool m_lpSolved;
 };
 
 /*! Battery metrics class */
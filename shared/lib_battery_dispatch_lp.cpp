@@ -0,0 +1,250 @@
+/*******************************************************************************************************
+*  Copyright 2017 Alliance for Sustainable Energy, LLC
+*
+*  NOTICE: This software was developed at least in part by Alliance for Sustainable Energy, LLC
+*  (Alliance) under Contract No. DE-AC36-08GO28308 with the U.S. Department of Energy and the U.S.
+*  The Government retains for itself and others acting on its behalf a nonexclusive, paid-up,
+*  irrevocable worldwide license in the software to reproduce, prepare derivative works, distribute
+*  copies to the public, perform publicly and display publicly, and to permit others to do so.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted
+*  provided that the following conditions are met:
+*
+*  1. Redistributions of source code must retain the above copyright notice, the above government
+*  rights notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright notice, the above government
+*  rights notice, this list of conditions and the following disclaimer in the documentation and/or
+*  other materials provided with the distribution.
+*
+*  3. The entire corresponding source code of any redistribution, with or without modification, by a
+*  research entity, including but not limited to any contracting manager/operator of a United States
+*  National Laboratory, any institution of higher learning, and any non-profit organization, must be
+*  made publicly available under this license for as long as the redistribution is made available by
+*  the research entity.
+*
+*  4. Redistribution of this software, without modification, must refer to the software by the same
+*  designation. Redistribution of a modified version of this software (i) may not refer to the modified
+*  version by the same designation, or by any confusingly similar designation, and (ii) must refer to
+*  the underlying software originally provided by Alliance as System Advisor Model or SAM. Except
+*  to comply with the foregoing, the terms System Advisor Model, SAM, or any confusingly similar
+*  designation may not be used to refer to any modified version of this software or any modified
+*  version of the underlying software originally provided by Alliance without the prior written consent
+*  of Alliance.
+*
+*  5. The name of the copyright holder, contributors, the United States Government, the United States
+*  Department of Energy, or any of their employees may not be used to endorse or promote products
+*  derived from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+*  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+*  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER,
+*  CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF THEIR
+*  EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+*  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+*  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************************************/
+
+#include "lib_battery_dispatch_lp.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "../lpsolve/lp_lib.h"
+
+namespace dispatch_lp
+{
+	/*! Peak shaving cycling costs, small next to the peak so they only break ties [1/kWh] */
+	const double costDischarge = 1e-4;
+	const double costChargeGrid = 1e-5;
+
+	/*! Value of energy left in the battery at the end of the horizon, so that free or cheap energy is stored for the next day [1/kWh] */
+	const double valueEnergyFinal = 5e-5;
+}
+
+dispatch_lp_t::dispatch_lp_t(size_t num_steps, double dt_hour, int objective) :
+	charge_pv_max(num_steps, 0.),
+	charge_clip_max(num_steps, 0.),
+	charge_grid_max(num_steps, 0.),
+	discharge_max(num_steps, 0.),
+	value_discharge(num_steps, 0.),
+	cost_charge_pv(num_steps, 0.),
+	cost_charge_grid(num_steps, 0.),
+	net_load(num_steps, 0.),
+	charge_max(0.),
+	energy_max(0.),
+	energy_initial(0.),
+	peak_min(0.),
+	m_lp(0),
+	m_num_steps(num_steps),
+	m_dt_hour(dt_hour),
+	m_objective(objective),
+	m_has_basis(false),
+	m_battery_power(num_steps, 0.),
+	m_peak(0.),
+	m_solve_count(0),
+	m_failure_count(0),
+	m_iterations(0),
+	m_solve_time(0.)
+{
+	build();
+}
+
+dispatch_lp_t::~dispatch_lp_t()
+{
+	if (m_lp)
+		delete_lp(m_lp);
+}
+
+void dispatch_lp_t::build()
+{
+	if (m_num_steps == 0)
+		return;
+
+	// the peak is the last column
+	int ncol = (int)(m_num_steps * NUM_VARS) + 1;
+	int peak_col = ncol;
+
+	m_lp = make_lp(0, ncol);
+	if (m_lp == NULL)
+		return;
+
+	set_verbose(m_lp, NEUTRAL);
+
+	int col[6];
+	double row[6];
+	double dt = m_dt_hour;
+
+	set_add_rowmode(m_lp, TRUE);
+
+	// energy balance: E_t - E_t-1 - dt * (charge) + dt * discharge = E_initial at t = 0, otherwise 0
+	for (size_t t = 0; t != m_num_steps; t++)
+	{
+		int n = 0;
+		col[n] = column(t, ENERGY); row[n++] = 1.;
+		if (t > 0) {
+			col[n] = column(t - 1, ENERGY); row[n++] = -1.;
+		}
+		col[n] = column(t, CHARGE_PV); row[n++] = -dt;
+		col[n] = column(t, CHARGE_CLIP); row[n++] = -dt;
+		col[n] = column(t, CHARGE_GRID); row[n++] = -dt;
+		col[n] = column(t, DISCHARGE); row[n++] = dt;
+		add_constraintex(m_lp, n, row, col, EQ, 0.);
+	}
+
+	// total charge power limit
+	for (size_t t = 0; t != m_num_steps; t++)
+	{
+		col[0] = column(t, CHARGE_PV); row[0] = 1.;
+		col[1] = column(t, CHARGE_CLIP); row[1] = 1.;
+		col[2] = column(t, CHARGE_GRID); row[2] = 1.;
+		add_constraintex(m_lp, 3, row, col, LE, 0.);
+	}
+
+	// grid import with the battery can't exceed the peak: charge - discharge - P <= -net_load
+	if (m_objective == MINIMIZE_PEAK)
+	{
+		for (size_t t = 0; t != m_num_steps; t++)
+		{
+			col[0] = column(t, CHARGE_PV); row[0] = 1.;
+			col[1] = column(t, CHARGE_GRID); row[1] = 1.;
+			col[2] = column(t, DISCHARGE); row[2] = -1.;
+			col[3] = peak_col; row[3] = -1.;
+			add_constraintex(m_lp, 4, row, col, LE, 0.);
+		}
+	}
+
+	set_add_rowmode(m_lp, FALSE);
+
+	if (m_objective == MINIMIZE_PEAK)
+	{
+		set_minim(m_lp);
+		set_obj(m_lp, peak_col, 1.);
+		for (size_t t = 0; t != m_num_steps; t++)
+		{
+			set_obj(m_lp, column(t, DISCHARGE), dispatch_lp::costDischarge * dt);
+			set_obj(m_lp, column(t, CHARGE_GRID), dispatch_lp::costChargeGrid * dt);
+		}
+		set_obj(m_lp, column(m_num_steps - 1, ENERGY), -dispatch_lp::valueEnergyFinal);
+	}
+	else
+	{
+		set_maxim(m_lp);
+		set_upbo(m_lp, peak_col, 0.);
+	}
+
+	m_basis.resize(1 + (size_t)get_Nrows(m_lp) + (size_t)get_Ncolumns(m_lp));
+	m_solution.resize((size_t)get_Ncolumns(m_lp));
+}
+
+bool dispatch_lp_t::solve()
+{
+	if (!m_lp)
+	{
+		m_failure_count++;
+		return false;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	double dt = m_dt_hour;
+	int peak_col = (int)(m_num_steps * NUM_VARS) + 1;
+	size_t peak_row = 2 * m_num_steps;
+	double E_max = std::max(energy_max, 0.);
+
+	set_rh(m_lp, 1, std::min(std::max(energy_initial, 0.), E_max));
+
+	for (size_t t = 0; t != m_num_steps; t++)
+	{
+		set_upbo(m_lp, column(t, CHARGE_PV), std::max(charge_pv_max[t], 0.));
+		set_upbo(m_lp, column(t, CHARGE_CLIP), std::max(charge_clip_max[t], 0.));
+		set_upbo(m_lp, column(t, CHARGE_GRID), std::max(charge_grid_max[t], 0.));
+		set_upbo(m_lp, column(t, DISCHARGE), std::max(discharge_max[t], 0.));
+		set_upbo(m_lp, column(t, ENERGY), E_max);
+		set_rh(m_lp, (int)(m_num_steps + t + 1), std::max(charge_max, 0.));
+
+		if (m_objective == MINIMIZE_PEAK)
+			set_rh(m_lp, (int)(peak_row + t + 1), -net_load[t]);
+		else
+		{
+			set_obj(m_lp, column(t, DISCHARGE), value_discharge[t] * dt);
+			set_obj(m_lp, column(t, CHARGE_PV), -cost_charge_pv[t] * dt);
+			set_obj(m_lp, column(t, CHARGE_GRID), -cost_charge_grid[t] * dt);
+		}
+	}
+	if (m_objective == MINIMIZE_PEAK)
+		set_lowbo(m_lp, peak_col, peak_min);
+
+	// warm start from the previous horizon
+	if (m_has_basis)
+		set_basis(m_lp, &m_basis[0], TRUE);
+
+	int ret = ::solve(m_lp);
+	bool return_ok = ret == OPTIMAL || ret == SUBOPTIMAL;
+
+	m_solve_count++;
+	m_iterations += (size_t)get_total_iter(m_lp);
+
+	if (return_ok)
+	{
+		get_variables(m_lp, &m_solution[0]);
+		for (size_t t = 0; t != m_num_steps; t++)
+		{
+			size_t i = t * NUM_VARS;
+			m_battery_power[t] = m_solution[i + DISCHARGE] - m_solution[i + CHARGE_PV] - m_solution[i + CHARGE_CLIP] - m_solution[i + CHARGE_GRID];
+		}
+		m_peak = m_solution[peak_col - 1];
+		m_has_basis = get_basis(m_lp, &m_basis[0], TRUE) == TRUE;
+	}
+	else
+	{
+		m_failure_count++;
+		m_has_basis = false;
+		default_basis(m_lp);
+	}
+
+	m_solve_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return return_ok;
+}
@@ -0,0 +1,157 @@
+/*******************************************************************************************************
+*  Copyright 2017 Alliance for Sustainable Energy, LLC
+*
+*  NOTICE: This software was developed at least in part by Alliance for Sustainable Energy, LLC
+*  (Alliance) under Contract No. DE-AC36-08GO28308 with the U.S. Department of Energy and the U.S.
+*  The Government retains for itself and others acting on its behalf a nonexclusive, paid-up,
+*  irrevocable worldwide license in the software to reproduce, prepare derivative works, distribute
+*  copies to the public, perform publicly and display publicly, and to permit others to do so.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted
+*  provided that the following conditions are met:
+*
+*  1. Redistributions of source code must retain the above copyright notice, the above government
+*  rights notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright notice, the above government
+*  rights notice, this list of conditions and the following disclaimer in the documentation and/or
+*  other materials provided with the distribution.
+*
+*  3. The entire corresponding source code of any redistribution, with or without modification, by a
+*  research entity, including but not limited to any contracting manager/operator of a United States
+*  National Laboratory, any institution of higher learning, and any non-profit organization, must be
+*  made publicly available under this license for as long as the redistribution is made available by
+*  the research entity.
+*
+*  4. Redistribution of this software, without modification, must refer to the software by the same
+*  designation. Redistribution of a modified version of this software (i) may not refer to the modified
+*  version by the same designation, or by any confusingly similar designation, and (ii) must refer to
+*  the underlying software originally provided by Alliance as System Advisor Model or SAM. Except
+*  to comply with the foregoing, the terms System Advisor Model, SAM, or any confusingly similar
+*  designation may not be used to refer to any modified version of this software or any modified
+*  version of the underlying software originally provided by Alliance without the prior written consent
+*  of Alliance.
+*
+*  5. The name of the copyright holder, contributors, the United States Government, the United States
+*  Department of Energy, or any of their employees may not be used to endorse or promote products
+*  derived from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+*  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+*  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER,
+*  CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF THEIR
+*  EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+*  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+*  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+*  IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************************************/
+
+#ifndef __LIB_BATTERY_DISPATCH_LP_H__
+#define __LIB_BATTERY_DISPATCH_LP_H__
+
+#include <cstddef>
+#include <vector>
+
+// Forward declaration so that lp_lib.h is only included by the implementation
+struct _lprec;
+
+/*
+Rolling-horizon linear program for automated battery dispatch
+*/
+class dispatch_lp_t
+{
+	/**
+	Class builds one sparse linear program for a fixed number of steps and re-solves it each time the dispatch is updated.
+	Each solve only changes the bounds, right-hand sides and objective, and starts from the basis of the previous solve.
+
+	Variables at each step are the DC power charged from PV, clipped PV and the grid, the DC power discharged [kW],
+	and the energy stored above the minimum state of charge at the end of the step [kWh].
+	The battery is treated as lossless within the horizon, conversion efficiencies are carried in the objective.
+
+	Objectives:
+		1. MAXIMIZE_REVENUE: value of discharged energy less the cost of the energy charged
+		2. MINIMIZE_PEAK: peak grid import over the horizon, with small cycling costs so that the battery only cycles to reduce the peak
+	*/
+public:
+	enum OBJECTIVE { MAXIMIZE_REVENUE, MINIMIZE_PEAK };
+
+	dispatch_lp_t(size_t num_steps, double dt_hour, int objective);
+	~dispatch_lp_t();
+
+	/*! Solve for the current horizon, returns false if no solution was found */
+	bool solve();
+
+	/*! The number of steps in the horizon */
+	size_t num_steps() const { return m_num_steps; }
+
+	/*! The objective, described by dispatch_lp_t::OBJECTIVE */
+	int objective() const { return m_objective; }
+
+	/*! Battery DC power at each step of the last solution, discharging is positive [kW] */
+	const std::vector<double> & battery_power() const { return m_battery_power; }
+
+	/*! Peak grid import of the last solution, MINIMIZE_PEAK only [kW] */
+	double peak() const { return m_peak; }
+
+	/*! Solve metrics accumulated over the simulation */
+	size_t solve_count() const { return m_solve_count; }
+	size_t failure_count() const { return m_failure_count; }
+	size_t iterations() const { return m_iterations; }
+	double solve_time() const { return m_solve_time; }
+
+	/*! Inputs for the next solve, each vector is of length num_steps */
+
+	/*! Upper limit on charging from PV, clipped PV and the grid [kW] */
+	std::vector<double> charge_pv_max;
+	std::vector<double> charge_clip_max;
+	std::vector<double> charge_grid_max;
+
+	/*! Upper limit on discharging [kW] */
+	std::vector<double> discharge_max;
+
+	/*! Value of energy discharged and cost of energy charged, MAXIMIZE_REVENUE only [$/kWh] */
+	std::vector<double> value_discharge;
+	std::vector<double> cost_charge_pv;
+	std::vector<double> cost_charge_grid;
+
+	/*! Grid import without the battery, MINIMIZE_PEAK only [kW] */
+	std::vector<double> net_load;
+
+	/*! Maximum total charge power [kW] */
+	double charge_max;
+
+	/*! Usable energy between the minimum and maximum state of charge, and the energy available now [kWh] */
+	double energy_max;
+	double energy_initial;
+
+	/*! Lower limit on the peak, for example the highest peak already set in the billing period [kW] */
+	double peak_min;
+
+protected:
+
+	void build();
+	int column(size_t step, size_t var) const { return (int)(step * NUM_VARS + var + 1); }
+
+	enum VARS { CHARGE_PV, CHARGE_CLIP, CHARGE_GRID, DISCHARGE, ENERGY, NUM_VARS };
+
+	_lprec * m_lp;
+	size_t m_num_steps;
+	double m_dt_hour;
+	int m_objective;
+
+	/*! Basis of the last successful solve, used to warm start the next */
+	std::vector<int> m_basis;
+	bool m_has_basis;
+
+	std::vector<double> m_solution;
+	std::vector<double> m_battery_power;
+	double m_peak;
+
+	size_t m_solve_count;
+	size_t m_failure_count;
+	size_t m_iterations;
+	double m_solve_time;
+};
+
+#endif
@@ -52,6 +52,7 @@
 #include <cmath>
 #include <limits>
 #include <iostream>
+#include <vector>
 
 #include "lib_cec6par.h"
 #include "lib_pv_incidence_modifier.h"
@@ -74,6 +75,7 @@ cec6par_module_t::cec6par_module_t( )
 {
 	Area = Vmp = Imp = Voc = Isc = alpha_isc = beta_voc 
 		= a = Il = Io = Rs = Rsh = Adj = std::numeric_limits<double>::quiet_NaN();
+	Solver = SINGLE_DIODE_ITERATIVE;
 }
 double air_mass_modifier( double Zenith_deg, double Elev_m, double a[5] )
 {
@@ -86,7 +88,6 @@ double air_mass_modifier( double Zenith_deg, double Elev_m, double a[5] )
 
 bool cec6par_module_t::operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &out )
 {
-	double muIsc = alpha_isc * (1-Adj/100);
 	//double muVoc = beta_voc * (1+Adj/100);
 	
 	/* initialize output first */
@@ -138,27 +139,27 @@ bool cec6par_module_t::operator() ( pvinput_t &input, double TcellC, double opvo
 		T_cell = TcellC + 273.15; // want cell temp in kelvin
 
 		// calculation of IL and IO at operating conditions
-		double IL_oper = Geff_total/I_ref *( Il + muIsc*(T_cell-Tc_ref) );
-		if (IL_oper < 0.0) IL_oper = 0.0;
-		
-		double EG = eg0 * (1-0.0002677*(T_cell-Tc_ref));
-		double IO_oper = Io * pow(T_cell/Tc_ref, 3) * exp( 1/KB*(eg0/Tc_ref - EG/T_cell) );
-		double A_oper = a * T_cell / Tc_ref;
-		double Rsh_oper = Rsh*(I_ref/Geff_total);
-			
-		double V_oc = openvoltage_5par( Voc, A_oper, IL_oper, IO_oper, Rsh_oper );
+		double IL_oper, IO_oper, A_oper, Rsh_oper;
+		operating_parameters( Geff_total, T_cell, IL_oper, IO_oper, A_oper, Rsh_oper );
+
+		double V_oc = ( Solver == SINGLE_DIODE_LAMBERTW ) ? openvoltage_5par_lambertw( A_oper, IL_oper, IO_oper, Rsh_oper )
+			: openvoltage_5par( Voc, A_oper, IL_oper, IO_oper, Rsh_oper );
 		double I_sc = IL_oper/(1+Rs/Rsh_oper);
 		
 		double P, V, I;
 		
 		if ( opvoltage < 0 )
 		{
-			P = maxpower_5par( V_oc, A_oper, IL_oper, IO_oper, Rs, Rsh_oper, &V, &I );			
+			if ( Solver == SINGLE_DIODE_LAMBERTW )
+				P = maxpower_5par_lambertw( A_oper, IL_oper, IO_oper, Rs, Rsh_oper, &V, &I );
+			else
+				P = maxpower_5par( V_oc, A_oper, IL_oper, IO_oper, Rs, Rsh_oper, &V, &I );			
 		}
 		else
 		{ // calculate power at specified operating voltage
 			V = opvoltage;
 			if (V >= V_oc) I = 0;
+			else if ( Solver == SINGLE_DIODE_LAMBERTW ) I = current_5par_lambertw( V, A_oper, IL_oper, IO_oper, Rs, Rsh_oper );
 			else I = current_5par( V, 0.9*IL_oper, A_oper, IL_oper, IO_oper, Rs, Rsh_oper );
 
 			P = V*I;
@@ -176,6 +177,45 @@ bool cec6par_module_t::operator() ( pvinput_t &input, double TcellC, double opvo
 	return out.Power >= 0;
 }
 
+bool cec6par_module_t::calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] )
+{
+	return pvmodule_calc_array( *this, n, input, TcellC, opvoltage, output );
+}
+
+void cec6par_module_t::operating_parameters( double Geff, double T_cell, double &IL_oper, double &IO_oper, double &A_oper, double &Rsh_oper )
+{
+	double muIsc = alpha_isc * (1-Adj/100);
+
+	IL_oper = Geff/I_ref *( Il + muIsc*(T_cell-Tc_ref) );
+	if (IL_oper < 0.0) IL_oper = 0.0;
+		
+	double EG = eg0 * (1-0.0002677*(T_cell-Tc_ref));
+	IO_oper = Io * pow(T_cell/Tc_ref, 3) * exp( 1/KB*(eg0/Tc_ref - EG/T_cell) );
+	A_oper = a * T_cell / Tc_ref;
+	Rsh_oper = Rsh*(I_ref/Geff);
+}
+
+void cec6par_module_t::max_power_batch( size_t n, const double *Geff, const double *TcellC, double *Pmp, double *Vmp, double *Imp )
+{
+	std::vector<double> a_oper(n), Il_oper(n), Io_oper(n), Rs_oper(n, Rs), Rsh_oper(n);
+	for ( size_t i = 0; i < n; i++ )
+	{
+		if ( Geff[i] >= 1.0 )
+			operating_parameters( Geff[i], TcellC[i] + 273.15, Il_oper[i], Io_oper[i], a_oper[i], Rsh_oper[i] );
+		else
+		{
+			// no light generated current, so the solver returns zero power
+			Il_oper[i] = 0;
+			Io_oper[i] = Io;
+			a_oper[i] = a;
+			Rsh_oper[i] = Rsh;
+		}
+	}
+
+	if ( n > 0 )
+		maxpower_5par_batch( n, &a_oper[0], &Il_oper[0], &Io_oper[0], &Rs_oper[0], &Rsh_oper[0], Pmp, Vmp, Imp );
+}
+
 
 
 /**********************************************************************************************
@@ -248,6 +288,11 @@ bool noct_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 	return true;
 }
 
+bool noct_celltemp_t::calc_array( size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] )
+{
+	return pvcelltemp_calc_array( *this, n, input, module, opvoltage, Tcell );
+}
+
 
 
 
@@ -341,6 +386,18 @@ static double channel_free_194( double W_gap, double SLOPE, double TA, double T_
 	return  Nu*k_air/W_gap;
 }
 
+mcsp_celltemp_t::mcsp_celltemp_t()
+{
+	WarmStart = false;
+	m_lastTC = m_lastEff = 0;
+	reset_counters();
+}
+
+void mcsp_celltemp_t::reset_counters()
+{
+	Calls = PowerIterations = TemperatureIterations = 0;
+}
+
 bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double opvoltage, double &Tcell )
 {	
 
@@ -427,6 +484,8 @@ bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 		return true;
 	}
 
+	Calls++;
+
 	if (HTD == 1)
 	{
 		Nrows = Ncols = 1;
@@ -474,6 +533,11 @@ bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 	P_guess = EFFREF * (SUNEFF*Area); // !Estimate performance based on SRC efficiency
 	if (HTD == 2) P_guess = P_guess * Nrows * Ncols;
 
+	// !Or start from the efficiency of the last converged call. Not used for the "gap" mounting configuration, whose
+	// !nested channel iterations are loose enough that the result would depend noticeably on the starting point
+	bool warm = WarmStart && MC != 4;
+	if (warm && m_lastEff > 0)
+		P_guess = m_lastEff * (SUNEFF*Area);
 
 	// !Adjust backside wind speed based on mounting structure orientation for "gap" mounting configuration
 	if (MC == 4) {
@@ -497,6 +561,8 @@ bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 	double app_fac_P  = 1.;
 	
 	double TC = input.Tdry+273.15;
+	if (warm && m_lastTC > 0)
+		TC = m_lastTC;
 
 	while( p_iter <= 300 && fabs(err_P) > 0.1 )
 	{		  
@@ -523,15 +589,15 @@ bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 				double h_conv_c   = pow( pow(h_forced,3.) + pow(h_free_c,3.) , 1./3.) ; // !Combine free and forced heat transfer coefficients (top)
 				double h_conv_b   = pow( pow(h_forced,3.) + pow(h_free_b,3.) , 1./3.) ; // !Combine free and forced heat transfer coefficients (bottom)
 			
-				// !Energy balance to calculate TC
-				double TC1 = ( (h_conv_c+h_conv_b)*TA 
-						+ (Fcs*EmisC+Fbs*EmisB)*sigma*h_sky*T_sky 
-						+ (Fcg*EmisC+Fbg*EmisB)*sigma*h_ground*T_ground
-						-(P_guess/Area)+SHDKR )
-						/ ( h_conv_c 
-						+ h_conv_b 
-						+ (Fcs*EmisC +Fbs*EmisB)*sigma*h_sky 
-						+ (Fcg*EmisC + Fbg*EmisB)*sigma*h_ground );
+				// !Energy balance residual, zero at the cell temperature. Newton's method with the radiation terms
+				// !(h_sky*(TC-T_sky) = TC^4-T_sky^4) differentiated exactly, and the convection coefficients, which
+				// !vary slowly with temperature, held at their values for this iteration
+				double e_sky      = (Fcs*EmisC+Fbs*EmisB)*sigma;
+				double e_ground   = (Fcg*EmisC+Fbg*EmisB)*sigma;
+				double resid      = (h_conv_c+h_conv_b)*(TC-TA) + e_sky*h_sky*(TC-T_sky) + e_ground*h_ground*(TC-T_ground)
+						+ (P_guess/Area) - SHDKR;
+				double dresid     = h_conv_c + h_conv_b + 4.*(e_sky+e_ground)*TC*TC*TC;
+				double TC1 = TC - resid/dresid;
 
 				// !Since some variables in TC1 calc are function of TC, iterative solving is required        
 				err_TC     = TC1 - TC; // !Error between n-1 and n temp calculations
@@ -554,8 +620,13 @@ bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 				double h_free_c   = free_convection_194(TC,TA,input.Tilt,rho_air,Area,Length,Width);
 				double h_conv_c   = pow((pow(h_forced,3.) + pow(h_free_c,3.)), (1./3.));
 					
-				double TC1 = ((h_conv_c)*TA + (Fcs*EmisC)*sigma*h_sky*T_sky + (Fcg*EmisC)*sigma*h_ground*T_ground
-						- (P_guess/Area)+SHDKR)/(h_conv_c+(Fcs*EmisC)*sigma*h_sky+(Fcg*EmisC)*sigma*h_ground);
+				// !Newton's method on the energy balance, as for rack mounting
+				double e_sky      = Fcs*EmisC*sigma;
+				double e_ground   = Fcg*EmisC*sigma;
+				double resid      = h_conv_c*(TC-TA) + e_sky*h_sky*(TC-T_sky) + e_ground*h_ground*(TC-T_ground)
+						+ (P_guess/Area) - SHDKR;
+				double dresid     = h_conv_c + 4.*(e_sky+e_ground)*TC*TC*TC;
+				double TC1 = TC - resid/dresid;
 					
 				err_TC     = TC1 - TC;
 				TC         = TC1;
@@ -582,9 +653,14 @@ bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 				double h_conv_c   = pow( pow(h_forced,3.) + pow(h_free_c,3.), (1./3.));
 				double h_conv_b   = h_free_b;// !No forced convection on backside
 					
-				double TC1 = (h_conv_c*TA+h_conv_b*TbackK+Fcs*EmisC*sigma*h_sky*T_sky+Fcg*EmisC*sigma*h_ground*T_ground
-								+EmisB*sigma*h_radbk*TbackK-(P_guess/Area)+SHDKR)
-							/ (h_conv_c+h_conv_b+Fcs*EmisC*sigma*h_sky+Fcg*EmisC*sigma*h_ground+EmisB*sigma*h_radbk);
+				// !Newton's method on the energy balance, as for rack mounting
+				double e_sky      = Fcs*EmisC*sigma;
+				double e_ground   = Fcg*EmisC*sigma;
+				double e_back     = EmisB*sigma;
+				double resid      = h_conv_c*(TC-TA) + h_conv_b*(TC-TbackK) + e_sky*h_sky*(TC-T_sky) + e_ground*h_ground*(TC-T_ground)
+						+ e_back*h_radbk*(TC-TbackK) + (P_guess/Area) - SHDKR;
+				double dresid     = h_conv_c + h_conv_b + 4.*(e_sky+e_ground+e_back)*TC*TC*TC;
+				double TC1 = TC - resid/dresid;
 					
 				err_TC     = TC1 - TC;
 				TC         = TC1;
@@ -749,6 +825,9 @@ bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 			break;
 		}
 
+		TemperatureIterations += h_iter;
+		PowerIterations++;
+
 		// now calculate module power based on new Cell Temp
 
 		pvoutput_t out;
@@ -779,6 +858,14 @@ bool mcsp_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &module, double
 		}
 	}
 	
+	m_lastTC = TC;
+	m_lastEff = P_guess / (SUNEFF*Area);
+
 	Tcell = TC - 273.15;
 	return true;
 }
+
+bool mcsp_celltemp_t::calc_array( size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] )
+{
+	return pvcelltemp_calc_array( *this, n, input, module, opvoltage, Tcell );
+}
@@ -76,6 +76,7 @@ public:
 	double Rs;
 	double Rsh;
 	double Adj;
+	int Solver; // SINGLE_DIODE_ITERATIVE or SINGLE_DIODE_LAMBERTW
 
 	cec6par_module_t();
 
@@ -86,6 +87,14 @@ public:
 	virtual double IscRef() { return Isc; }
 
 	virtual bool operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &output );
+	virtual bool calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] );
+
+	// max power point at each pair of effective irradiance (W/m2) and cell temperature ('C), always
+	// solved with the Lambert W method.  pairs below 1 W/m2 give zero power, as in operator()
+	void max_power_batch( size_t n, const double *Geff, const double *TcellC, double *Pmp, double *Vmp=0, double *Imp=0 );
+
+	// single diode parameters at the operating conditions, with the cell temperature in Kelvin
+	void operating_parameters( double Geff, double T_cell, double &IL_oper, double &IO_oper, double &A_oper, double &Rsh_oper );
 
 	virtual ~cec6par_module_t() {};
 };
@@ -99,6 +108,7 @@ public:
 	double Tnoct;
 
 	virtual bool operator() ( pvinput_t &input, pvmodule_t &module, double opvoltage, double &Tcell );
+	virtual bool calc_array( size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] );
 
 	virtual ~noct_celltemp_t(){}
 };
@@ -116,10 +126,28 @@ public:
 	double Width; // module width, along vertical dimension, (m)
 	double Wgap;  // gap width spacing (m)
 	double TbackInteg;  // back surface temperature for integrated modules ('C)
+
+	// start the iterations from the cell temperature and efficiency of the last converged call instead
+	// of ambient temperature and reference efficiency.  results then depend on the order of the calls,
+	// within the convergence tolerances.  ignored for the gap mounting configuration (MC=4)
+	bool WarmStart;
+
+	// counts since construction or reset_counters(), for measuring the cost of the model
+	size_t Calls; // calls with enough irradiance to solve the energy balance
+	size_t PowerIterations; // module power evaluations
+	size_t TemperatureIterations; // cell temperature updates, summed over the power iterations
+
+	mcsp_celltemp_t();
+	void reset_counters();
 	
 	virtual bool operator() ( pvinput_t &input, pvmodule_t &module, double opvoltage, double &Tcell );
+	virtual bool calc_array( size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] );
 
 	virtual ~mcsp_celltemp_t() {};
+
+private:
+	double m_lastTC; // cell temperature of the last converged call (K), zero if none
+	double m_lastEff; // ratio of power to effective irradiance times area in the last converged call
 };
 
 #endif
@@ -250,6 +250,7 @@ namespace geothermal
 
 	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Create CPolynomial class and objects to use throughout code
+	// The objects are const so they can be shared safely by simultaneous geothermal runs
 	/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	class CPolynomial
 	{
@@ -265,7 +266,7 @@ namespace geothermal
 		virtual ~CPolynomial(void) {}
 
 		//void init(const double &c1, const double &c2, const double &c3, const double &c4, const double &c5, const double &c6, const double &c7) { md1=c1; md2=c2; md3=c3; md4=c4; md5=c5; md6=c6; md7=c7; }
-		double evaluate(double val) { return evaluatePolynomial(val, md1, md2, md3, md4, md5, md6, md7); }
+		double evaluate(double val) const { return evaluatePolynomial(val, md1, md2, md3, md4, md5, md6, md7); }
 
 	private:
 		double md1,md2,md3,md4,md5,md6,md7;
@@ -273,68 +274,68 @@ namespace geothermal
 	};
 
 	// Enthalpy and Entropy Constants
-	CPolynomial oAmbientEnthalpyConstants(-31.76958886, 0.997066497, 0.00001087);
-	CPolynomial oAmbientEntropyConstants(-0.067875028480951, 0.002201824618666, -0.000002665154152, 0.000000004390426, -0.000000000004355);
-	CPolynomial oBinaryEnthalpyConstants(-24.113934502, 0.83827719984, 0.0013462856545, -5.9760546933E-6, 1.4924845946E-8, -1.8805783302E-11, 1.0122595469E-14);
-	CPolynomial oBinaryEntropyConstants(-0.060089552413, 0.0020324314656, -1.2026247967E-6, -1.8419111147E-09, 8.8430105661E-12, -1.2945213491E-14, 7.3991541798E-18);
-	CPolynomial oFlashEnthalpyConstants(-32.232886, 1.0112508, -0.00013079803, 0.00000050269721, -0.00000000050170088, 1.5041709E-13, 7.0459062E-16);
-	CPolynomial oFlashEntropyConstants(-0.067756238, 0.0021979159, -0.0000026352004, 0.0000000045293969, -6.5394475E-12, 6.2185729E-15, -2.2525163E-18);
+	const CPolynomial oAmbientEnthalpyConstants(-31.76958886, 0.997066497, 0.00001087);
+	const CPolynomial oAmbientEntropyConstants(-0.067875028480951, 0.002201824618666, -0.000002665154152, 0.000000004390426, -0.000000000004355);
+	const CPolynomial oBinaryEnthalpyConstants(-24.113934502, 0.83827719984, 0.0013462856545, -5.9760546933E-6, 1.4924845946E-8, -1.8805783302E-11, 1.0122595469E-14);
+	const CPolynomial oBinaryEntropyConstants(-0.060089552413, 0.0020324314656, -1.2026247967E-6, -1.8419111147E-09, 8.8430105661E-12, -1.2945213491E-14, 7.3991541798E-18);
+	const CPolynomial oFlashEnthalpyConstants(-32.232886, 1.0112508, -0.00013079803, 0.00000050269721, -0.00000000050170088, 1.5041709E-13, 7.0459062E-16);
+	const CPolynomial oFlashEntropyConstants(-0.067756238, 0.0021979159, -0.0000026352004, 0.0000000045293969, -6.5394475E-12, 6.2185729E-15, -2.2525163E-18);
 
 	// specific volume calculation constants
-	CPolynomial oSVC(0.017070951786, -0.000023968043944, 0.00000022418007508, -9.1528222658E-10, 2.1775771856E-12, -2.6995711458E-15, 1.4068205291E-18);
+	const CPolynomial oSVC(0.017070951786, -0.000023968043944, 0.00000022418007508, -9.1528222658E-10, 2.1775771856E-12, -2.6995711458E-15, 1.4068205291E-18);
 	
 	// pressure calculation constants
-	CPolynomial oPC(8.0894106754, -0.19788525656, 0.0019695373372, -0.0000091909636468, 0.000000024121846658, -2.5517506351E-12);
-	CPolynomial oPressureAmbientConstants(0.320593729630411, -0.0156410175570826, 0.0003545452343917, -0.0000027120923771, 0.0000000136666056);
-	CPolynomial oDensityConstants(62.329, 0.0072343, -0.00012456, 0.00000020215, -0.00000000017845);
-	CPolynomial oFlashTempConstants(113.186, -2.48032, 0.0209139, -0.0000557641, 0.0000000542893);
+	const CPolynomial oPC(8.0894106754, -0.19788525656, 0.0019695373372, -0.0000091909636468, 0.000000024121846658, -2.5517506351E-12);
+	const CPolynomial oPressureAmbientConstants(0.320593729630411, -0.0156410175570826, 0.0003545452343917, -0.0000027120923771, 0.0000000136666056);
+	const CPolynomial oDensityConstants(62.329, 0.0072343, -0.00012456, 0.00000020215, -0.00000000017845);
+	const CPolynomial oFlashTempConstants(113.186, -2.48032, 0.0209139, -0.0000557641, 0.0000000542893);
 
 	// used in calculating flash brine effectiveness
-	CPolynomial oFlashConstants1(-1.306483, 0.2198881, -0.003125628, 0.0000173028, -0.00000003258986);
-	CPolynomial oFlashConstants2(0.01897203, -0.0002054368, 0.000002824477, -0.00000001427949, 0.00000000002405238);
-	CPolynomial oPSatConstants(0.0588213, -0.0018299913, 0.00010459209, -0.00000084085735, 0.0000000086940123);
+	const CPolynomial oFlashConstants1(-1.306483, 0.2198881, -0.003125628, 0.0000173028, -0.00000003258986);
+	const CPolynomial oFlashConstants2(0.01897203, -0.0002054368, 0.000002824477, -0.00000001427949, 0.00000000002405238);
+	const CPolynomial oPSatConstants(0.0588213, -0.0018299913, 0.00010459209, -0.00000084085735, 0.0000000086940123);
 
 	// EGS
-	CPolynomial oEGSDensity(0.001003773308, -0.00000043857183, 0.00000001365689, -0.00000000006419, 0.00000000000013);
-	CPolynomial oEGSSpecificHeat(4.301651536642, - 0.011554722573, 0.00020328187235, - 0.0000011433197, 0.00000000217642);
+	const CPolynomial oEGSDensity(0.001003773308, -0.00000043857183, 0.00000001365689, -0.00000000006419, 0.00000000000013);
+	const CPolynomial oEGSSpecificHeat(4.301651536642, - 0.011554722573, 0.00020328187235, - 0.0000011433197, 0.00000000217642);
 
 	// Min geothermal fluid outlet temperatures to prevent Si precipitation
 	// If fluid temp >= 356 degrees F (180 C), use quartz curve
-	CPolynomial oMinimumTemperatureQuartz(-159.597976, 0.69792956, 0.00035129);
+	const CPolynomial oMinimumTemperatureQuartz(-159.597976, 0.69792956, 0.00035129);
 	// If fluid temp < 356 degrees F (180 C), use chalcedony curve
-	CPolynomial oMinimumTemperatureChalcedony(-127.71, 0.8229);
+	const CPolynomial oMinimumTemperatureChalcedony(-127.71, 0.8229);
 
 	// The constants for the following 19 objects were only used within the CGETEMGlobals class
-	CPolynomial oDHaUnder150(60.251233, -0.28682223, 0.0049745244, -0.000050841601, 0.00000026431087, -0.00000000054076309);
-	CPolynomial oDHa150To1500(53.67656, -0.02861559, 0.0000469389, -0.000000047788062, 0.000000000024733176, -5.0493347E-15);
-	CPolynomial oDHaOver1500(123.86562, -0.18362579, 0.00016780015, -0.000000077555328, 0.000000000017815452, -1.6323827E-15);
-	CPolynomial oDHbUnder150(-2.1991099, 1.4133748, -0.019163136, 0.0001766481, -0.00000087079731, 0.0000000017257066);
-	CPolynomial oDHb150To1500(33.304544, 0.27192791, -0.00045591346, 0.000000443209, -0.00000000022501399, 4.5323448E-14);
-	CPolynomial oDHbOver1500(740.43412, -1.5040745, 0.0014334909, -0.00000067364263, 0.00000000015600207, -1.4371477E-14);
+	const CPolynomial oDHaUnder150(60.251233, -0.28682223, 0.0049745244, -0.000050841601, 0.00000026431087, -0.00000000054076309);
+	const CPolynomial oDHa150To1500(53.67656, -0.02861559, 0.0000469389, -0.000000047788062, 0.000000000024733176, -5.0493347E-15);
+	const CPolynomial oDHaOver1500(123.86562, -0.18362579, 0.00016780015, -0.000000077555328, 0.000000000017815452, -1.6323827E-15);
+	const CPolynomial oDHbUnder150(-2.1991099, 1.4133748, -0.019163136, 0.0001766481, -0.00000087079731, 0.0000000017257066);
+	const CPolynomial oDHb150To1500(33.304544, 0.27192791, -0.00045591346, 0.000000443209, -0.00000000022501399, 4.5323448E-14);
+	const CPolynomial oDHbOver1500(740.43412, -1.5040745, 0.0014334909, -0.00000067364263, 0.00000000015600207, -1.4371477E-14);
 
 	// Getting enthalpy from temperature
-	CPolynomial oFlashEnthalpyFUnder125(-32.479184, 1.0234315, -0.00034115062, 0.0000020320904, -0.000000004480902);
-	CPolynomial oFlashEnthalpyF125To325(-31.760088, 0.9998551, -0.000027703224, 0.000000073480055, 0.00000000025563678);
-	CPolynomial oFlashEnthalpyF325To675(-1137.0718729, 13.426933583, -0.055373746094, 0.00012227602697, -0.00000013378773724, 5.8634263518E-11);
-	CPolynomial oFlashEnthalpyFOver675(-5658291651.7, 41194401.715, -119960.00955, 174.6587566, -0.12714518982, 0.000037021613128);
+	const CPolynomial oFlashEnthalpyFUnder125(-32.479184, 1.0234315, -0.00034115062, 0.0000020320904, -0.000000004480902);
+	const CPolynomial oFlashEnthalpyF125To325(-31.760088, 0.9998551, -0.000027703224, 0.000000073480055, 0.00000000025563678);
+	const CPolynomial oFlashEnthalpyF325To675(-1137.0718729, 13.426933583, -0.055373746094, 0.00012227602697, -0.00000013378773724, 5.8634263518E-11);
+	const CPolynomial oFlashEnthalpyFOver675(-5658291651.7, 41194401.715, -119960.00955, 174.6587566, -0.12714518982, 0.000037021613128);
 
-	CPolynomial oFlashEnthalpyGUnder125(1061.0996074, 0.44148580795, -0.000030268712038, -0.00000015844186585, -7.2150559138E-10);
-	CPolynomial oFlashEnthalpyG125To325(1061.9537518, 0.42367961566, 0.000099006018886, -0.00000051596852593, -0.0000000005035389718);
-	CPolynomial oFlashEnthalpyG325To675(-3413.791688, 60.38391862, -0.33157805684, 0.00096963380389, -0.0000015842735401, 0.0000000013698021251, -4.9118123157E-13);
-	CPolynomial oFlashEnthalpyGOver675(7355226428.1, -53551582.984, 155953.29919, -227.07686319, 0.16531315908, -0.000048138033984);
+	const CPolynomial oFlashEnthalpyGUnder125(1061.0996074, 0.44148580795, -0.000030268712038, -0.00000015844186585, -7.2150559138E-10);
+	const CPolynomial oFlashEnthalpyG125To325(1061.9537518, 0.42367961566, 0.000099006018886, -0.00000051596852593, -0.0000000005035389718);
+	const CPolynomial oFlashEnthalpyG325To675(-3413.791688, 60.38391862, -0.33157805684, 0.00096963380389, -0.0000015842735401, 0.0000000013698021251, -4.9118123157E-13);
+	const CPolynomial oFlashEnthalpyGOver675(7355226428.1, -53551582.984, 155953.29919, -227.07686319, 0.16531315908, -0.000048138033984);
 
 	// Getting temperature from pressure
-	CPolynomial oFlashTemperatureUnder2(14.788238833, 255.85632577, -403.56297354, 400.57269432, -222.30982965, 63.304761377, -7.1864066799);
-	CPolynomial oFlashTemperature2To20(78.871966537, 31.491049082, -4.8016701723, 0.49468791547, -0.029734376328, 0.00094358038872, -0.000012178121702);
-	CPolynomial oFlashTemperature20To200(161.40853789, 4.3688747745, -0.062604066919, 0.00061292292067, -0.0000034988475881, 0.00000001053096688, -1.2878309875E-11);
-	CPolynomial oFlashTemperature200To1000(256.29706201, 0.93056131917, -0.0020724712921, 0.0000034048164769, -0.0000000034275245432, 1.8867165569E-12, -4.3371351471E-16);
-	CPolynomial oFlashTemperatureOver1000(342.90613285, 0.33345911089, -0.00020256473758, 0.000000094407417758, -2.7823504188E-11, 4.589696886E-15, -3.2288675486E-19);
+	const CPolynomial oFlashTemperatureUnder2(14.788238833, 255.85632577, -403.56297354, 400.57269432, -222.30982965, 63.304761377, -7.1864066799);
+	const CPolynomial oFlashTemperature2To20(78.871966537, 31.491049082, -4.8016701723, 0.49468791547, -0.029734376328, 0.00094358038872, -0.000012178121702);
+	const CPolynomial oFlashTemperature20To200(161.40853789, 4.3688747745, -0.062604066919, 0.00061292292067, -0.0000034988475881, 0.00000001053096688, -1.2878309875E-11);
+	const CPolynomial oFlashTemperature200To1000(256.29706201, 0.93056131917, -0.0020724712921, 0.0000034048164769, -0.0000000034275245432, 1.8867165569E-12, -4.3371351471E-16);
+	const CPolynomial oFlashTemperatureOver1000(342.90613285, 0.33345911089, -0.00020256473758, 0.000000094407417758, -2.7823504188E-11, 4.589696886E-15, -3.2288675486E-19);
 
 	// Second law equations, used in FractionOfMaxEfficiency
-	CPolynomial oSecondLawConstantsBinary(130.8952, -426.5406, 462.9957, -166.3503); // ("6Ab. Makeup-Annl%").Range("R24:R27")
-	CPolynomial oSecondLawConstantsSingleFlash(-3637.06, 25.7411, -0.0684072, 0.0000808782, -0.0000000359423);	// ("6Ef.Flash Makeup").Range("R20:V20")
-	CPolynomial oSecondLawConstantsDualFlashNoTempConstraint(-2762.4048, 18.637876, -0.047198813, 0.000053163057, -0.000000022497296); // ("6Ef.Flash Makeup").Range("R22:V22")
-	CPolynomial oSecondLawConstantsDualFlashWithTempConstraint(-4424.6599, 31.149268, -0.082103498, 0.000096016499, -0.00000004211223);	// ("6Ef.Flash Makeup").Range("R21:V21")
+	const CPolynomial oSecondLawConstantsBinary(130.8952, -426.5406, 462.9957, -166.3503); // ("6Ab. Makeup-Annl%").Range("R24:R27")
+	const CPolynomial oSecondLawConstantsSingleFlash(-3637.06, 25.7411, -0.0684072, 0.0000808782, -0.0000000359423);	// ("6Ef.Flash Makeup").Range("R20:V20")
+	const CPolynomial oSecondLawConstantsDualFlashNoTempConstraint(-2762.4048, 18.637876, -0.047198813, 0.000053163057, -0.000000022497296); // ("6Ef.Flash Makeup").Range("R22:V22")
+	const CPolynomial oSecondLawConstantsDualFlashWithTempConstraint(-4424.6599, 31.149268, -0.082103498, 0.000096016499, -0.00000004211223);	// ("6Ef.Flash Makeup").Range("R21:V21")
 
 
 	//Specific Volume Coefficients (Used in Flass Vessels Cost Calculation):
@@ -67,6 +67,7 @@ const char *iec61853_module_t::par_names[PARMAX] = { "IL", "IO", "RS", "RSH", "A
 iec61853_module_t::iec61853_module_t()
 {
 	_imsg = 0;
+	Solver = SINGLE_DIODE_ITERATIVE;
 	alphaIsc = n = Il = Io = C1 = C2 = C3
 			= D1 = D2 = D3 = Egref = std::numeric_limits<double>::quiet_NaN();
 		
@@ -933,20 +934,25 @@ bool iec61853_module_t::operator() ( pvinput_t &input, double TcellC, double opv
 		//if ( Rsop > 1000 ) Rsop = 10000;
 		//if ( Rshop > 25000 ) Rshop = 25000;
 
-		double V_oc = openvoltage_5par( Voc0, aop, Ilop, Ioop, Rshop );
+		double V_oc = ( Solver == SINGLE_DIODE_LAMBERTW ) ? openvoltage_5par_lambertw( aop, Ilop, Ioop, Rshop )
+			: openvoltage_5par( Voc0, aop, Ilop, Ioop, Rshop );
 		double I_sc = Ilop/(1+Rsop/Rshop);
 		
 		double P, V, I;
 		
 		if ( opvoltage < 0 )
 		{
-			P = maxpower_5par( V_oc, aop, Ilop, Ioop, Rsop, Rshop, &V, &I );
+			if ( Solver == SINGLE_DIODE_LAMBERTW )
+				P = maxpower_5par_lambertw( aop, Ilop, Ioop, Rsop, Rshop, &V, &I );
+			else
+				P = maxpower_5par( V_oc, aop, Ilop, Ioop, Rsop, Rshop, &V, &I );
 			if ( P < 0 ) P = 0;
 		}
 		else
 		{ // calculate power at specified operating voltage
 			V = opvoltage;
 			if (V >= V_oc) I = 0;
+			else if ( Solver == SINGLE_DIODE_LAMBERTW ) I = current_5par_lambertw( V, aop, Ilop, Ioop, Rsop, Rshop );
 			else I = current_5par( V, 0.9*Ilop, aop, Ilop, Ioop, Rsop, Rshop );
 
 			if ( I < 0 ) { I=0; V=0; }
@@ -965,3 +971,8 @@ bool iec61853_module_t::operator() ( pvinput_t &input, double TcellC, double opv
 
 	return out.Power >= 0;
 }
+
+bool iec61853_module_t::calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] )
+{
+	return pvmodule_calc_array( *this, n, input, TcellC, opvoltage, output );
+}
@@ -93,6 +93,7 @@ public:
 	double Area;
 	bool GlassAR;
 	double AMA[5];
+	int Solver; // SINGLE_DIODE_ITERATIVE or SINGLE_DIODE_LAMBERTW
 
 	Imessage_api *_imsg;
 
@@ -117,6 +118,7 @@ public:
 	virtual double VocRef() { return Voc0; }
 	virtual double IscRef() { return Isc0; }
 	virtual bool operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &output );
+	virtual bool calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] );
 };
 
 
@@ -95,7 +95,8 @@ static int day_of_year( int month, int day_of_month ) /* returns 1-365 */
 	return iday + day_of_month;
 }
 
-void solarpos(int year,int month,int day,int hour,double minute,double lat,double lng,double tz,double sunn[9])
+// sine, cosine and tangent of the latitude are passed in so that solarpos_array() can compute them once for all timesteps
+static void solarpos_calc(int year,int month,int day,int hour,double minute,double sinlat,double coslat,double tanlat,double lng,double tz,double sunn[9])
 {
 /* 
 	Revised 5/15/98. Replaced algorithm for solar azimuth with one by Iqbal
@@ -172,9 +173,7 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 	else if( ha > M_PI )
 		ha = ha - 2*M_PI;             /* Hour angle in radians between -pi and pi */
 
-	lat = lat*DTOR;                /* Change latitude to radians */
-
-	arg = sin(dec)*sin(lat) + cos(dec)*cos(lat)*cos(ha);  /* For elevation in radians */
+	arg = sin(dec)*sinlat + cos(dec)*coslat*cos(ha);  /* For elevation in radians */
 	if( arg > 1.0 )
 		elv = M_PI/2.0;
 	else if( arg < -1.0 )
@@ -188,7 +187,7 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 		}
 	else
 		{                 /* For solar azimuth in radians per Iqbal */
-		arg = ((sin(elv)*sin(lat)-sin(dec))/(cos(elv)*cos(lat))); /* for azimuth */
+		arg = ((sin(elv)*sinlat-sin(dec))/(cos(elv)*coslat)); /* for azimuth */
 		if( arg > 1.0 )
 			azm = 0.0;              /* Azimuth(radians)*/
 		else if( arg < -1.0 )
@@ -218,7 +217,7 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 	else if( E > 0.33 )
 		E = E - 24.0;
 
-	arg = -tan(lat)*tan(dec);
+	arg = -tanlat*tan(dec);
 	if( arg >= 1.0 )
 		ws = 0.0;                         /* No sunrise, continuous nights */
 	else if( arg <= -1.0 )
@@ -269,6 +268,108 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 }
 
 
+void solarpos(int year,int month,int day,int hour,double minute,double lat,double lng,double tz,double sunn[9])
+{
+	lat = lat*DTOR;                /* Change latitude to radians */
+	solarpos_calc(year, month, day, hour, minute, sin(lat), cos(lat), tan(lat), lng, tz, sunn);
+}
+
+void solarpos_array(size_t n, const int year[], const int month[], const int day[], const int hour[], const double minute[],
+	double lat, double lng, double tz, double *sunn[9])
+{
+	lat = lat*DTOR;
+	double sinlat = sin(lat), coslat = cos(lat), tanlat = tan(lat);
+	double sun[9];
+	for (size_t i = 0; i < n; i++)
+	{
+		solarpos_calc(year[i], month[i], day[i], hour[i], minute[i], sinlat, coslat, tanlat, lng, tz, sun);
+		for (int k = 0; k < 9; k++)
+			if (sunn[k]) sunn[k][i] = sun[k];
+	}
+}
+
+// effective sun position of a timestep as used by irrad::calc, noon is the solarpos output at noon of the same day
+static void solarpos_timestep_calc(int year, int month, int day, int hour, double minute, double delt, const double noon[9],
+	double sinlat, double coslat, double tanlat, double lng, double tz, int tsp[3], double sunn[9])
+{
+	for (int k = 0; k < 9; k++)
+		sunn[k] = noon[k];
+
+	double t_cur = hour + minute/60.0;
+	double t_sunrise = noon[4];
+	double t_sunset = noon[5];
+
+	// recall: if delt <= 0.0, do not interpolate sunrise and sunset hours, just use specified time stamp
+	if ( delt > 0
+		&& t_cur >= t_sunrise - delt/2.0
+		&& t_cur < t_sunrise + delt/2.0 )
+	{
+		// time step encompasses the sunrise
+		double t_calc = (t_sunrise + (t_cur+delt/2.0))/2.0; // midpoint of sunrise and end of timestep
+		int hr_calc = (int)t_calc;
+		double min_calc = (t_calc-hr_calc)*60.0;
+
+		tsp[0] = hr_calc;
+		tsp[1] = (int)min_calc;
+		solarpos_calc(year, month, day, hr_calc, min_calc, sinlat, coslat, tanlat, lng, tz, sunn);
+		tsp[2] = 2;
+	}
+	else if ( delt > 0
+		&& t_cur > t_sunset - delt/2.0
+		&& t_cur <= t_sunset + delt/2.0 )
+	{
+		// timestep encompasses the sunset
+		double t_calc = ( (t_cur-delt/2.0) + t_sunset )/2.0; // midpoint of beginning of timestep and sunset
+		int hr_calc = (int)t_calc;
+		double min_calc = (t_calc-hr_calc)*60.0;
+
+		tsp[0] = hr_calc;
+		tsp[1] = (int)min_calc;
+		solarpos_calc(year, month, day, hr_calc, min_calc, sinlat, coslat, tanlat, lng, tz, sunn);
+		tsp[2] = 3;
+	}
+	else if (t_cur >= t_sunrise && t_cur <= t_sunset)
+	{
+		// timestep is not sunrise nor sunset, but sun is up  (calculate position at provided t_cur)
+		tsp[0] = hour;
+		tsp[1] = (int)minute;
+		solarpos_calc(year, month, day, hour, minute, sinlat, coslat, tanlat, lng, tz, sunn);
+		tsp[2] = 1;
+	}
+	else
+	{
+		// sun is down, assign sundown values
+		sunn[0] = -999*DTOR; //avoid returning a junk azimuth angle (return in radians)
+		sunn[1] = -999*DTOR; //avoid returning a junk zenith angle (return in radians)
+		sunn[2] = -999*DTOR; //avoid returning a junk elevation angle (return in radians)
+		tsp[0] = 0;
+		tsp[1] = 0;
+		tsp[2] = 0;
+	}
+}
+
+void solarpos_timestep_array(size_t n, const int year[], const int month[], const int day[], const int hour[], const double minute[],
+	double delt, double lat, double lng, double tz, int *tsp[3], double *sunn[9])
+{
+	lat = lat*DTOR;
+	double sinlat = sin(lat), coslat = cos(lat), tanlat = tan(lat);
+	double noon[9], sun[9];
+	int ts[3];
+	for (size_t i = 0; i < n; i++)
+	{
+		// sunrise and sunset hours in local standard time, once for each day
+		if (i == 0 || year[i] != year[i-1] || month[i] != month[i-1] || day[i] != day[i-1])
+			solarpos_calc(year[i], month[i], day[i], 12, 0.0, sinlat, coslat, tanlat, lng, tz, noon);
+
+		solarpos_timestep_calc(year[i], month[i], day[i], hour[i], minute[i], delt, noon, sinlat, coslat, tanlat, lng, tz, ts, sun);
+		for (int k = 0; k < 3; k++)
+			if (tsp[k]) tsp[k][i] = ts[k];
+		for (int k = 0; k < 9; k++)
+			if (sunn[k]) sunn[k][i] = sun[k];
+	}
+}
+
+
 void incidence(int mode,double tilt,double sazm,double rlim,double zen,double azm, bool en_backtrack, double gcr, double angle[5])
 {
 	// Azimuth angles are for N=0 or 2pi, E=pi/2, S=pi, and W=3pi/2.  8/13/98
@@ -434,6 +535,68 @@ void incidence(int mode,double tilt,double sazm,double rlim,double zen,double az
 	angle[4] = btdiff;
 }
 
+void incidence_array(int mode, double tilt, double sazm, double rlim, size_t n, const double zen[], const double azm[], bool en_backtrack, double gcr, double *angle[5])
+{
+	double ang[5];
+
+	if (mode == 0 || mode == 4)
+	{
+		// fixed surface: the surface terms are the same for every timestep
+		double tilt_r = tilt*DTOR;
+		double sazm_r = sazm*DTOR;
+		double sintilt = sin(tilt_r), costilt = cos(tilt_r);
+		for (size_t i = 0; i < n; i++)
+		{
+			double arg = sin(zen[i])*cos(azm[i]-sazm_r)*sintilt + cos(zen[i])*costilt;
+			if (arg < -1.0) ang[0] = M_PI;
+			else if (arg > 1.0) ang[0] = 0.0;
+			else ang[0] = acos(arg);
+
+			ang[1] = tilt_r;
+			ang[2] = sazm_r;
+			ang[3] = ang[4] = 0;
+			for (int k = 0; k < 5; k++)
+				if (angle[k]) angle[k][i] = ang[k];
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			incidence(mode, tilt, sazm, rlim, zen[i], azm[i], en_backtrack, gcr, ang);
+			for (int k = 0; k < 5; k++)
+				if (angle[k]) angle[k][i] = ang[k];
+		}
+	}
+}
+
+void skymodel_array(int model, size_t n, const double hextra[], const double dn[], const double df[], const double alb[],
+	const double inc[], const double tilt[], const double zen[], double *poa[3], double *diffc[3])
+{
+	double p[3], d[3];
+	for (size_t i = 0; i < n; i++)
+	{
+		switch (model)
+		{
+		case 0:
+			isotropic(hextra[i], dn[i], df[i], alb[i], inc[i], tilt[i], zen[i], p, d);
+			break;
+		case 1:
+			hdkr(hextra[i], dn[i], df[i], alb[i], inc[i], tilt[i], zen[i], p, d);
+			break;
+		default:
+			perez(hextra[i], dn[i], df[i], alb[i], inc[i], tilt[i], zen[i], p, d);
+			break;
+		}
+
+		for (int k = 0; k < 3; k++)
+		{
+			if (poa[k]) poa[k][i] = p[k];
+			if (diffc && diffc[k]) diffc[k][i] = d[k];
+		}
+	}
+}
+
 #define SMALL 1e-6
 
 void hdkr( double hextra, double dn, double df, double alb, double inc, double tilt, double zen, double poa[3], double diffc[3] /* can be null */ )
@@ -861,6 +1024,7 @@ void irrad::setup()
 	planeOfArrayIrradianceFront[0] = planeOfArrayIrradianceFront[1] = planeOfArrayIrradianceFront[2] = diffuseIrradianceFront[0] = diffuseIrradianceFront[1] = diffuseIrradianceFront[2] = std::numeric_limits<double>::quiet_NaN();
 	planeOfArrayIrradianceRear[0] = planeOfArrayIrradianceRear[1] = planeOfArrayIrradianceRear[2] = diffuseIrradianceRear[0] = diffuseIrradianceRear[1] = diffuseIrradianceRear[2] = std::numeric_limits<double>::quiet_NaN();
 	timeStepSunPosition[0] = timeStepSunPosition[1] = timeStepSunPosition[2] = -999;
+	sunPositionSupplied = false;
 	planeOfArrayIrradianceRearAverage = 0;
 
 	calculatedDirectNormal = directNormal;
@@ -998,6 +1162,7 @@ void irrad::set_time( int y, int m, int d, int h, double min, double delt_hr )
 	this->hour = h;
 	this->minute = min;
 	this->delt = delt_hr;
+	this->sunPositionSupplied = false;
 }
 
 void irrad::set_location( double latDegrees, double longDegrees, double tz )
@@ -1063,6 +1228,15 @@ void irrad::set_sun_component(size_t index, double value)
 	}
 }
 
+void irrad::set_sun_position(const int tsp[3], const double sun[9])
+{
+	for (int k = 0; k < 3; k++)
+		timeStepSunPosition[k] = tsp[k];
+	for (int k = 0; k < 9; k++)
+		sunAnglesRadians[k] = sun[k];
+	sunPositionSupplied = true;
+}
+
 int irrad::calc()
 {
 	int code = check();
@@ -1079,66 +1253,16 @@ int irrad::calc()
 	planeOfArrayIrradianceFront: result from sky model
 	diff: broken out diffuse components from sky model
 */	
-	double t_cur = hour + minute/60.0;
-
-	// calculate sunrise and sunset hours in local standard time for the current day
-	solarpos( year, month, day, 12, 0.0, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
-
-	double t_sunrise = sunAnglesRadians[4];
-	double t_sunset = sunAnglesRadians[5];
-
-	// recall: if delt <= 0.0, do not interpolate sunrise and sunset hours, just use specified time stamp
-	if ( delt > 0
-		&& t_cur >= t_sunrise - delt/2.0
-		&& t_cur < t_sunrise + delt/2.0 )
+	if ( !sunPositionSupplied )
 	{
-		// time step encompasses the sunrise
-		double t_calc = (t_sunrise + (t_cur+delt/2.0))/2.0; // midpoint of sunrise and end of timestep
-		int hr_calc = (int)t_calc;
-		double min_calc = (t_calc-hr_calc)*60.0;
-
-		timeStepSunPosition[0] = hr_calc;
-		timeStepSunPosition[1] = (int)min_calc;
-				
-		solarpos( year, month, day, hr_calc, min_calc, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
-
-		timeStepSunPosition[2] = 2;				
-	}
-	else if ( delt > 0
-		&& t_cur > t_sunset - delt/2.0
-		&& t_cur <= t_sunset + delt/2.0 )
-	{
-		// timestep encompasses the sunset
-		double t_calc = ( (t_cur-delt/2.0) + t_sunset )/2.0; // midpoint of beginning of timestep and sunset
-		int hr_calc = (int)t_calc;
-		double min_calc = (t_calc-hr_calc)*60.0;
-
-		timeStepSunPosition[0] = hr_calc;
-		timeStepSunPosition[1] = (int)min_calc;
-				
-		solarpos( year, month, day, hr_calc, min_calc, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
-
-		timeStepSunPosition[2] = 3;
+		// calculate sunrise and sunset hours in local standard time for the current day
+		double lat = latitudeDegrees*DTOR;
+		double sinlat = sin(lat), coslat = cos(lat), tanlat = tan(lat);
+		double noon[9];
+		solarpos_calc( year, month, day, 12, 0.0, sinlat, coslat, tanlat, longitudeDegrees, timezone, noon );
+		solarpos_timestep_calc( year, month, day, hour, minute, delt, noon, sinlat, coslat, tanlat, longitudeDegrees, timezone,
+			timeStepSunPosition, sunAnglesRadians );
 	}
-	else if (t_cur >= t_sunrise && t_cur <= t_sunset)
-	{
-		// timestep is not sunrise nor sunset, but sun is up  (calculate position at provided t_cur)			
-		timeStepSunPosition[0] = hour;
-		timeStepSunPosition[1] = (int)minute;
-		solarpos( year, month, day, hour, minute, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
-		timeStepSunPosition[2] = 1;
-	}
-	else
-	{	
-		// sun is down, assign sundown values
-		sunAnglesRadians[0] = -999*DTOR; //avoid returning a junk azimuth angle (return in radians)
-		sunAnglesRadians[1] = -999*DTOR; //avoid returning a junk zenith angle (return in radians)
-		sunAnglesRadians[2] = -999*DTOR; //avoid returning a junk elevation angle (return in radians)
-		timeStepSunPosition[0] = 0;
-		timeStepSunPosition[1] = 0;
-		timeStepSunPosition[2] = 0;
-	}
-
 			
 	planeOfArrayIrradianceFront[0]=planeOfArrayIrradianceFront[1]=planeOfArrayIrradianceFront[2] = 0;
 	diffuseIrradianceFront[0]=diffuseIrradianceFront[1]=diffuseIrradianceFront[2] = 0;
@@ -1211,7 +1335,7 @@ int irrad::calc()
 
 }
 
-int irrad::calc_rear_side(double transmissionFactor, double bifaciality, double groundClearanceHeight, double slopeLength)
+int irrad::calc_rear_side(double transmissionFactor, double bifaciality, double groundClearanceHeight, double slopeLength, bifacial_geometry *geometry)
 {
 	// do irradiance calculations if sun is up
 	if (timeStepSunPosition[2] > 0)
@@ -1231,29 +1355,37 @@ int irrad::calc_rear_side(double transmissionFactor, double bifaciality, double
 		double verticalHeight = slopeLength * sin(tiltRadian);
 		double horizontalLength = slopeLength * cos(tiltRadian);
 
-		// Determine the factors for points on the ground from the leading edge of one row of PV panels to the edge of the next row of panels behind
-		std::vector<double> rearSkyConfigFactors, frontSkyConfigFactors;
-		this->getSkyConfigurationFactors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, rearSkyConfigFactors, frontSkyConfigFactors);
+		bifacial_geometry local;
+		bifacial_geometry &g = geometry ? *geometry : local;
+
+		// Determine the factors for points on the ground from the leading edge of one row of PV panels to the edge of the next row of panels behind.
+		// These depend only on the geometry, so they are kept until the row geometry changes
+		if (g.rearSkyConfigFactors.empty() || g.rowToRow != rowToRow || g.verticalHeight != verticalHeight || g.clearanceGround != clearanceGround
+			|| g.distanceBetweenRows != distanceBetweenRows || g.horizontalLength != horizontalLength)
+		{
+			this->getSkyConfigurationFactors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, g.rearSkyConfigFactors, g.frontSkyConfigFactors);
+			g.rowToRow = rowToRow;
+			g.verticalHeight = verticalHeight;
+			g.clearanceGround = clearanceGround;
+			g.distanceBetweenRows = distanceBetweenRows;
+			g.horizontalLength = horizontalLength;
+		}
 
 		// Determine if ground is shading from direct beam radio for points on the ground from leading edge of PV panels to leading edge of next row behind
 		double pvBackShadeFraction, pvFrontShadeFraction, maxShadow;
 		pvBackShadeFraction = pvFrontShadeFraction = maxShadow = 0;
-		std::vector<int> rearGroundShade, frontGroundShade;
-		this->getGroundShadeFactors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, sunAnglesRadians[0], sunAnglesRadians[2], rearGroundShade, frontGroundShade, maxShadow, pvBackShadeFraction, pvFrontShadeFraction);
+		this->getGroundShadeFactors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, sunAnglesRadians[0], sunAnglesRadians[2], g.rearGroundShade, g.frontGroundShade, maxShadow, pvBackShadeFraction, pvFrontShadeFraction);
 
 		// Get the rear ground GHI
-		std::vector<double> rearGroundGHI, frontGroundGHI;
-		this->getGroundGHI(transmissionFactor, rearSkyConfigFactors, frontSkyConfigFactors, rearGroundShade, frontGroundShade, rearGroundGHI, frontGroundGHI);
+		this->getGroundGHI(transmissionFactor, g.rearSkyConfigFactors, g.frontSkyConfigFactors, g.rearGroundShade, g.frontGroundShade, g.rearGroundGHI, g.frontGroundGHI);
 
 		// Calculate the irradiance on the front of the PV module (to get front reflected)
-		std::vector<double> frontIrradiancePerCellrow, frontReflected;
 		double frontAverageIrradiance = 0;
-		getFrontSurfaceIrradiances(pvFrontShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, frontGroundGHI, frontIrradiancePerCellrow, frontAverageIrradiance, frontReflected);
+		getFrontSurfaceIrradiances(pvFrontShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, g.frontGroundGHI, g.frontIrradiance, frontAverageIrradiance, g.frontReflected);
 
 		// Calculate the irradiance on the back of the PV module
-		std::vector<double> rearIrradiancePerCellrow;
 		double rearAverageIrradiance = 0;
-		getBackSurfaceIrradiances(pvBackShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, rearGroundGHI, frontGroundGHI, frontReflected, rearIrradiancePerCellrow, rearAverageIrradiance);
+		getBackSurfaceIrradiances(pvBackShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, g.rearGroundGHI, g.frontGroundGHI, g.frontReflected, g.rearIrradiance, rearAverageIrradiance);
 		planeOfArrayIrradianceRearAverage = rearAverageIrradiance * bifaciality;
 	}
 	return true;
@@ -1266,6 +1398,8 @@ void irrad::getSkyConfigurationFactors(double rowToRow, double verticalHeight, d
 	double deltaInterval = static_cast<double>(rowToRow / intervals);
 	double x = -deltaInterval / 2.0;
 
+	rearSkyConfigFactors.clear();
+	frontSkyConfigFactors.clear();
 	for (size_t i = 0; i != intervals; i++)
 	{
 		x += deltaInterval;
@@ -1427,6 +1561,8 @@ void irrad::getGroundShadeFactors(double rowToRow, double verticalHeight, double
 
 	}
 	double x = -deltaInterval / 2.0;
+	rearGroundShade.clear();
+	frontGroundShade.clear();
 	for (size_t i = 0; i != intervals; i++)
 	{
 		x += deltaInterval;
@@ -1444,7 +1580,7 @@ void irrad::getGroundShadeFactors(double rowToRow, double verticalHeight, double
 	maxShadow = fmax(shadingStart1, shadingEnd1);
 }
 
-void irrad::getGroundGHI(double transmissionFactor, std::vector<double> rearSkyConfigFactors, std::vector<double> frontSkyConfigFactors, std::vector<int> rearGroundShade, std::vector<int> frontGroundShade, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI)
+void irrad::getGroundGHI(double transmissionFactor, const std::vector<double> & rearSkyConfigFactors, const std::vector<double> & frontSkyConfigFactors, const std::vector<int> & rearGroundShade, const std::vector<int> & frontGroundShade, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI)
 {
 	// Calculate the diffuse components of irradiance
 	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal,albedo, sunAnglesRadians[1], 0.0, sunAnglesRadians[1], planeOfArrayIrradianceRear, diffuseIrradianceRear);
@@ -1452,6 +1588,9 @@ void irrad::getGroundGHI(double transmissionFactor, std::vector<double> rearSkyC
 	double isotropicDiffuse = diffuseIrradianceRear[0];
 	double circumsolarDiffuse = diffuseIrradianceRear[1];
 
+	rearGroundGHI.clear();
+	frontGroundGHI.clear();
+
 	// Sum the irradiance components for each of the ground segments to the front and rear of the front of the PV row
 	for (size_t i = 0; i != 100; i++)
 	{
@@ -1480,7 +1619,7 @@ void irrad::getGroundGHI(double transmissionFactor, std::vector<double> rearSkyC
 	}
 }
 
-void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> frontGroundGHI, std::vector<double> & frontIrradiance, double & frontAverageIrradiance, std::vector<double> & frontReflected)
+void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const std::vector<double> & frontGroundGHI, std::vector<double> & frontIrradiance, double & frontAverageIrradiance, std::vector<double> & frontReflected)
 {
 	// front surface assumed to be glass
 	double n2 = 1.526;
@@ -1518,6 +1657,8 @@ void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowTo
 
 	// Calculate diffuse and direct component irradiances for each cell row (assuming 6 rows)
 	size_t cellRows = 6;
+	frontIrradiance.clear();
+	frontReflected.clear();
 	for (size_t i = 0; i != cellRows; i++)
 	{
 		// Calculate diffuse irradiances and reflected amounts for each cell row over its field of view of 180 degrees, 
@@ -1640,7 +1781,7 @@ void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowTo
 	}
 }
 
-void irrad::getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double , double horizontalLength, std::vector<double> rearGroundGHI, std::vector<double> frontGroundGHI, std::vector<double> frontReflected, std::vector<double> & rearIrradiance, double & rearAverageIrradiance)
+void irrad::getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double , double horizontalLength, const std::vector<double> & rearGroundGHI, const std::vector<double> & frontGroundGHI, const std::vector<double> & frontReflected, std::vector<double> & rearIrradiance, double & rearAverageIrradiance)
 {
 	// front surface assumed to be glass
 	double n2 = 1.526;
@@ -1676,6 +1817,7 @@ void irrad::getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRo
 
 	// Calculate diffuse and direct component irradiances for each cell row (assuming 6 rows)
 	size_t cellRows = 6;
+	rearIrradiance.clear();
 	for (size_t i = 0; i != cellRows; i++)
 	{
 		// Calculate diffuse irradiances and reflected amounts for each cell row over its field of view of 180 degrees, 
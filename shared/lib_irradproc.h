@@ -97,6 +97,28 @@ struct poaDecompReq;
 */
 void solarpos(int year,int month,int day,int hour,double minute,double lat,double lng,double tz,double sunn[9]);
 
+/**
+* solarpos_array calculates the sun position for a series of timesteps at one location, see solarpos().
+* Inputs are parallel arrays of length n, and the outputs are returned in structure-of-arrays form: sunn[k]
+* is an array of length n that receives element k of solarpos() output for every timestep, or NULL if that
+* output is not needed. Terms that depend only on the location are computed once. Timesteps are independent,
+* so a long series can be split into ranges computed on separate threads.
+*/
+void solarpos_array(size_t n, const int year[], const int month[], const int day[], const int hour[], const double minute[],
+	double lat, double lng, double tz, double *sunn[9]);
+
+/**
+* solarpos_timestep_array calculates the sun position used by irrad::calc() for a series of timesteps at one location.
+* For timesteps of length delt hours that contain sunrise or sunset, the position is taken at the middle of the part
+* of the timestep when the sun is up, and for timesteps when the sun is down, the azimuth, zenith and elevation are
+* -999 degrees in radians. A delt of IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET uses the time stamps as they are.
+* The sunrise and sunset of each day are computed once. tsp[k] is an array of length n that receives element k of
+* the effective hour, minute and sun up code of irrad::calc(), and sunn[k] receives element k of the sun angles,
+* either can be NULL if not needed.
+*/
+void solarpos_timestep_array(size_t n, const int year[], const int month[], const int day[], const int hour[], const double minute[],
+	double delt, double lat, double lng, double tz, int *tsp[3], double *sunn[9]);
+
 /**
 * incidence function calculates the incident angle of direct beam radiation to a surface.
 * The calculation is done for a given sun position, latitude, and surface orientation. 
@@ -119,6 +141,14 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 */
 void incidence(int mode,double tilt,double sazm,double rlim,double zen,double azm, bool en_backtrack, double gcr, double angle[5]);
 
+/**
+* incidence_array calculates incidence and surface angles for a series of sun positions, see incidence().
+* zen and azm are arrays of length n in radians, and angle[k] is an array of length n that receives element k
+* of incidence() output for every timestep, or NULL if not needed. For fixed surfaces the surface terms are
+* computed once.
+*/
+void incidence_array(int mode, double tilt, double sazm, double rlim, size_t n, const double zen[], const double azm[], bool en_backtrack, double gcr, double *angle[5]);
+
 
 /**
 * Perez function for calculating values of diffuse + direct 
@@ -188,6 +218,15 @@ void isotropic( double hextra, double dn, double df, double alb, double inc, dou
 */
 void hdkr( double hextra, double dn, double df, double alb, double inc, double tilt, double zen, double poa[3], double diffc[3] /* can be NULL */ );
 
+/**
+* skymodel_array calculates plane-of-array irradiance for a series of timesteps with the isotropic (model 0),
+* HDKR (model 1) or Perez (model 2) sky model. All inputs are arrays of length n, see perez() for their
+* definitions. poa[k] and diffc[k] are arrays of length n that receive the corresponding outputs, or NULL if not
+* needed, and diffc itself can be NULL.
+*/
+void skymodel_array(int model, size_t n, const double hextra[], const double dn[], const double df[], const double alb[],
+	const double inc[], const double tilt[], const double zen[], double *poa[3], double *diffc[3] /* can be NULL */ );
+
 
 /**
 * poaDecomp is a function to decompose input plane-of-array irradiance into direct normal, diffuse horizontal, and global horizontal.
@@ -276,6 +315,25 @@ double shadeFraction1x(double solazi, double solzen, double tilt, double azimuth
 double backtrack(double solazi, double solzen, double tilt, double azimuth, double rotlim, double gcr, double rotation);
 
 
+/**
+* bifacial_geometry holds the rear-side irradiance terms that depend only on the row geometry, along with scratch
+* storage for the per-timestep ground and cell row irradiances. A caller keeps one per subarray across timesteps and
+* passes it to irrad::calc_rear_side(), so the sky configuration factors are only recomputed when the geometry changes
+* (i.e. for trackers) and no vectors are allocated once the buffers have grown to size.
+*/
+struct bifacial_geometry
+{
+	bifacial_geometry() : rowToRow(-1), verticalHeight(-1), clearanceGround(-1), distanceBetweenRows(-1), horizontalLength(-1) { }
+
+	/// Geometry that the sky configuration factors were computed for
+	double rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength;
+	std::vector<double> rearSkyConfigFactors, frontSkyConfigFactors;
+
+	/// Scratch storage reused each timestep
+	std::vector<int> rearGroundShade, frontGroundShade;
+	std::vector<double> rearGroundGHI, frontGroundGHI, frontIrradiance, frontReflected, rearIrradiance;
+};
+
 /**
 * \class irrad
 *
@@ -327,6 +385,7 @@ protected:
 	double diffuseIrradianceFront[3];		///< Front-side diffuse irradiance for isotropic, circumsolar, and horizon (W/m2)
 	double diffuseIrradianceRear[3];		///< Rear-side diffuse irradiance for isotropic, circumsolar, and horizon (W/m2)
 	int timeStepSunPosition[3];				///< [0] effective hour of day used for sun position, [1] effective minute of hour used for sun position, [2] is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
+	bool sunPositionSupplied;				///< True if the sun position of the timestep was set with set_sun_position() instead of calculated
 	double planeOfArrayIrradianceRearAverage; ///< Average rear side plane-of-array irradiance (W/m2)
 
 public:
@@ -384,11 +443,14 @@ public:
 	/// Function to overwrite internally calculated sun position values, primarily to enable testing against other libraries using different sun position calculations
 	void set_sun_component(size_t index, double value);
 
+	/// Supply the sun position of the current timestep as calculated by solarpos_timestep_array(), so that calc() does not calculate it again, cleared by set_time()
+	void set_sun_position(const int tsp[3], const double sun[9]);
+
 	/// Run the irradiance processor and calculate the plane-of-array irradiance and diffuse components of irradiance
 	int calc();
 
-	/// Run the irradiance processor for the rear-side of the surface to calculate rear-side plane-of-array irradiance
-	int calc_rear_side(double transmissionFactor, double bifaciality, double groundClearanceHeight, double slopeLength);
+	/// Run the irradiance processor for the rear-side of the surface to calculate rear-side plane-of-array irradiance, optionally reusing geometry kept by the caller
+	int calc_rear_side(double transmissionFactor, double bifaciality, double groundClearanceHeight, double slopeLength, bifacial_geometry *geometry = 0);
 	
 	/// Return the calculated sun angles, some of which are converted to degrees
 	void get_sun( double *solazi,
@@ -435,13 +497,13 @@ public:
 	void getGroundShadeFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, std::vector<int> & rearGroundFactors, std::vector<int> & frontGroundFactors, double & maxShadow, double & pvBackShadeFraction, double & pvFrontShadeFraction);
 
 	/// Return the ground global-horizonal irradiance, used by \link calc_rear_side()
-	void getGroundGHI(double transmissionFactor, std::vector<double> rearSkyConfigFactors, std::vector<double> frontSkyConfigFactors, std::vector<int> rearGroundShadeFactors, std::vector<int> frontGroundShadeFactors, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI);
+	void getGroundGHI(double transmissionFactor, const std::vector<double> & rearSkyConfigFactors, const std::vector<double> & frontSkyConfigFactors, const std::vector<int> & rearGroundShadeFactors, const std::vector<int> & frontGroundShadeFactors, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI);
 
 	/// Return the back surface irradiances, used by \link calc_rear_side()
-	void getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> rearGroundGHI, std::vector<double> frontGroundGHI, std::vector<double> frontReflected, std::vector<double> & rearIrradiance, double & rearAverageIrradiance);
+	void getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const std::vector<double> & rearGroundGHI, const std::vector<double> & frontGroundGHI, const std::vector<double> & frontReflected, std::vector<double> & rearIrradiance, double & rearAverageIrradiance);
 
 	/// Return the front surface irradiances, used by \link calc_rear_side()
-	void getFrontSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> frontGroundGHI, std::vector<double> & frontIrradiance, double & frontAverageIrradiance, std::vector<double> & frontReflected);
+	void getFrontSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const std::vector<double> & frontGroundGHI, std::vector<double> & frontIrradiance, double & frontAverageIrradiance, std::vector<double> & frontReflected);
 
 	enum RADMODE { DN_DF, DN_GH, GH_DF, POA_R, POA_P };
 	enum SKYMODEL { ISOTROPIC, HDKR, PEREZ };
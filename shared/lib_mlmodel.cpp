@@ -92,6 +92,7 @@ static const int AM_MODE_LEE_PANCHULA = 4;
 mlmodel_module_t::mlmodel_module_t()
           {
 	m_bspline3 = BSpline(1);
+	Solver = SINGLE_DIODE_ITERATIVE;
 	Width = Length = V_mp_ref = I_mp_ref = V_oc_ref = I_sc_ref = S_ref = T_ref
 		= R_shref = R_sh0 = R_shexp = R_s
 		= alpha_isc = beta_voc_spec = E_g = n_0 = mu_n = D2MuTau = T_c_no_tnoct
@@ -247,18 +248,25 @@ bool mlmodel_module_t::operator() (pvinput_t &input, double T_C, double opvoltag
 
 			R_sh = R_shref + (R_sh0 - R_shref) * exp(-R_shexp * (S / S_ref));
 
-			V_oc = openvoltage_5par_rec(V_oc, a, I_L, I_0, R_sh, D2MuTau, Vbi);
+			// the explicit solution does not include the recombination loss term
+			bool lambertw = (Solver == SINGLE_DIODE_LAMBERTW && D2MuTau == 0);
+
+			V_oc = lambertw ? openvoltage_5par_lambertw(a, I_L, I_0, R_sh) : openvoltage_5par_rec(V_oc, a, I_L, I_0, R_sh, D2MuTau, Vbi);
 			I_sc = I_L / (1 + R_s / R_sh);
 
 			if (opvoltage < 0)
 			{
-				P = maxpower_5par_rec(V_oc, a, I_L, I_0, R_s, R_sh, D2MuTau, Vbi, &V, &I);
+				if (lambertw)
+					P = maxpower_5par_lambertw(a, I_L, I_0, R_s, R_sh, &V, &I);
+				else
+					P = maxpower_5par_rec(V_oc, a, I_L, I_0, R_s, R_sh, D2MuTau, Vbi, &V, &I);
 			}
 			else
 			{ // calculate power at specified operating voltage
 				V = opvoltage;
 
 				if (V >= V_oc) I = 0;
+				else if (lambertw) I = current_5par_lambertw(V, a, I_L, I_0, R_s, R_sh);
 				else I = current_5par_rec(V, 0.9*I_L, a, I_L, I_0, R_s, R_sh, D2MuTau, Vbi);
 				P = V*I;
 			}
@@ -277,6 +285,11 @@ bool mlmodel_module_t::operator() (pvinput_t &input, double T_C, double opvoltag
 	return out.Power >= 0;
 }
 
+bool mlmodel_module_t::calc_array(size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[])
+{
+	return pvmodule_calc_array(*this, n, input, TcellC, opvoltage, output);
+}
+
 // mockup cell temperature model
 // to be used in cases when Tcell is calculated within the module model
 bool mock_celltemp_t::operator() (pvinput_t &, pvmodule_t &, double, double &Tcell)
@@ -284,3 +297,8 @@ bool mock_celltemp_t::operator() (pvinput_t &, pvmodule_t &, double, double &Tce
 	Tcell = -999;
 	return true;
 }
+
+bool mock_celltemp_t::calc_array(size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[])
+{
+	return pvcelltemp_calc_array(*this, n, input, module, opvoltage, Tcell);
+}
@@ -109,6 +109,8 @@ public:
 
 	double groundRelfectionFraction;
 
+	int Solver; // SINGLE_DIODE_ITERATIVE or SINGLE_DIODE_LAMBERTW, iterative is always used with recombination losses
+
 	mlmodel_module_t();
 
 	virtual double AreaRef() { return (Width * Length); }
@@ -117,6 +119,7 @@ public:
 	virtual double VocRef() { return V_oc_ref; }
 	virtual double IscRef() { return I_sc_ref; }
 	virtual bool operator() (pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &output);
+	virtual bool calc_array(size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[]);
 	virtual void initializeManual();
 
 private:
@@ -134,6 +137,7 @@ class mock_celltemp_t : public pvcelltemp_t
 {
 public:
 	virtual bool operator() (pvinput_t &input, pvmodule_t &module, double opvoltage, double &Tcell);
+	virtual bool calc_array(size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[]);
 };
 
 #endif
\ No newline at end of file
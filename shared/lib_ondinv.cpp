@@ -57,6 +57,8 @@
 #include <limits>
 #include <vector>
 #include <stdexcept>
+#include <list>
+#include <mutex>
 
 #include "lib_ondinv.h"
 #include "bsplinebuilder.h"
@@ -66,6 +68,126 @@
 const int TEMP_DERATE_ARRAY_LENGTH = 6;
 // test commit
 
+ond_spline::ond_spline(BSpline &bspline)
+{
+	knots = bspline.getKnotVectors()[0];
+	degree = bspline.getBasisDegrees()[0];
+	DenseVector c = bspline.getCoefficients();
+	coefficients.resize((size_t)c.size());
+	for (size_t i = 0; i < coefficients.size(); i++)
+		coefficients[i] = c(i);
+}
+
+double ond_spline::eval(double x) const
+{
+	size_t n = coefficients.size();
+	if (n < 1 || degree > 7 || knots.size() != n + degree + 1)
+		return 0;
+	if (x < knots[degree] || x > knots[n])
+		return 0;
+
+	// knot span with knots[k] <= x < knots[k+1], using the last nonempty span at the upper end
+	size_t k = degree;
+	while (k < n - 1 && knots[k + 1] <= x)
+		k++;
+
+	// de Boor's algorithm
+	double d[8];
+	for (size_t j = 0; j <= degree; j++)
+		d[j] = coefficients[j + k - degree];
+	for (size_t r = 1; r <= degree; r++)
+	{
+		for (size_t j = degree; j >= r; j--)
+		{
+			double t0 = knots[j + k - degree];
+			double t1 = knots[j + 1 + k - r];
+			double alpha = (t1 > t0) ? (x - t0) / (t1 - t0) : 0;
+			d[j] = (1 - alpha) * d[j - 1] + alpha * d[j];
+		}
+	}
+	return d[degree];
+}
+
+// efficiency curve fits are kept in a small process-wide cache keyed by a hash of the curve points,
+// so that repeated simulations with the same inverter only fit each curve once
+struct ond_spline_cache_entry
+{
+	unsigned long long hash;
+	std::vector<double> x, y;
+	ond_spline spline;
+};
+
+static std::mutex ond_spline_cache_mutex;
+static std::list<ond_spline_cache_entry> ond_spline_cache; // most recently used first
+static const size_t ond_spline_cache_max = 32;
+
+static unsigned long long hash_curve_points(const std::vector<double> &x, const std::vector<double> &y)
+{
+	// 64-bit FNV-1a
+	unsigned long long h = 14695981039346656037ULL;
+	const std::vector<double> *v[2] = { &x, &y };
+	for (int i = 0; i < 2; i++)
+	{
+		const unsigned char *p = (const unsigned char*)v[i]->data();
+		size_t len = v[i]->size() * sizeof(double);
+		for (size_t j = 0; j < len; j++)
+		{
+			h ^= p[j];
+			h *= 1099511628211ULL;
+		}
+	}
+	return h;
+}
+
+static ond_spline fit_efficiency_curve(const std::vector<double> &x, const std::vector<double> &y)
+{
+	unsigned long long hash = hash_curve_points(x, y);
+	{
+		std::lock_guard<std::mutex> lock(ond_spline_cache_mutex);
+		for (std::list<ond_spline_cache_entry>::iterator it = ond_spline_cache.begin(); it != ond_spline_cache.end(); ++it)
+		{
+			if (it->hash == hash && it->x == x && it->y == y)
+			{
+				ond_spline_cache.splice(ond_spline_cache.begin(), ond_spline_cache, it);
+				return it->spline;
+			}
+		}
+	}
+
+	DenseVector xSamples(1);
+	DataTable samples;
+	for (size_t k = 0; k < x.size() && k < y.size(); k++)
+	{
+		xSamples(0) = x[k];
+		samples.addSample(xSamples, y[k]);
+	}
+	BSpline bspline = BSpline::Builder(samples).degree(3).build();
+
+	ond_spline_cache_entry entry;
+	entry.hash = hash;
+	entry.x = x;
+	entry.y = y;
+	entry.spline = ond_spline(bspline);
+
+	std::lock_guard<std::mutex> lock(ond_spline_cache_mutex);
+	ond_spline_cache.push_front(entry);
+	while (ond_spline_cache.size() > ond_spline_cache_max)
+		ond_spline_cache.pop_back();
+	return entry.spline;
+}
+
+size_t ond_inverter::splineCacheSize()
+{
+	std::lock_guard<std::mutex> lock(ond_spline_cache_mutex);
+	return ond_spline_cache.size();
+}
+
+void ond_inverter::clearSplineCache()
+{
+	std::lock_guard<std::mutex> lock(ond_spline_cache_mutex);
+	ond_spline_cache.clear();
+}
+
 ond_inverter::ond_inverter()
 {
 	PNomConv = PMaxOUT = VOutConv = VMppMin = VMPPMax = VAbsMax = PSeuil = PNomDC = PMaxDC =
@@ -219,8 +341,6 @@ void ond_inverter::initializeManual()
 		Pdc_threshold = 2;
 		std::vector<double> ondspl_X;
 		std::vector<double> ondspl_Y;
-		DenseVector xSamples(1);
-		DataTable samples;
 //		int splineIndex;
 //		bool switchoverDone;
 
@@ -287,14 +407,8 @@ void ond_inverter::initializeManual()
 			}
 			*/
 			// SPLINTER
-			samples.clear();
 			x_max[j] = ondspl_X.back();
-			for (size_t k = 0; k < ondspl_X.size() && k < ondspl_Y.size(); k++)
-			{
-				xSamples(0) = ondspl_X[k];
-				samples.addSample(xSamples, ondspl_Y[k]);
-			}
-			m_bspline3[j] = BSpline::Builder(samples).degree(3).build();
+			m_bspline3[j] = fit_efficiency_curve(ondspl_X, ondspl_Y);
 
 		}
 		ondIsInitialized = true;
@@ -304,7 +418,6 @@ void ond_inverter::initializeManual()
 double ond_inverter::calcEfficiency(double Pdc, int index_eta) {
 	double eta;
 //	int splineIndex;
-	DenseVector x(1);
 //	if (Pdc > (Pdc_threshold * PNomDC_eff)) {
 //		splineIndex = 1;
 //	}
@@ -325,8 +438,7 @@ double ond_inverter::calcEfficiency(double Pdc, int index_eta) {
 	else if (Pdc >= x_lim[index_eta]) 
 	{
 //		eta = effSpline[splineIndex][index_eta](Pdc);
-		x(0) = Pdc;
-		eta = (m_bspline3[index_eta]).eval(x);
+		eta = (m_bspline3[index_eta]).eval(Pdc);
 	}
 	else 
 	{
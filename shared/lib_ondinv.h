@@ -56,6 +56,21 @@
 using namespace std;
 using namespace SPLINTER;
 
+// B-spline curve with the knots and coefficients taken out of a SPLINTER fit, so that it
+// can be evaluated without the allocations of BSpline::eval
+class ond_spline
+{
+public:
+	ond_spline() : degree(0) {};
+	explicit ond_spline(BSpline &bspline);
+
+	double eval(double x) const; // zero outside the knot range, as BSpline::eval
+
+	std::vector<double> knots;
+	std::vector<double> coefficients;
+	unsigned int degree;
+};
+
 class ond_inverter
 {
 public:
@@ -128,13 +143,17 @@ public:
 	);
 	virtual void initializeManual();
 
+	// number of efficiency curve fits held in the cache shared by all instances
+	static size_t splineCacheSize();
+	static void clearSplineCache();
+
 private:
 	bool ondIsInitialized;
 
 	int noOfEfficiencyCurves;
 //	tk::spline effSpline[2][3];
 //	BSpline m_bspline3[2][3];
-	BSpline m_bspline3[3];
+	ond_spline m_bspline3[3];
 	double x_max[3];
 	double x_lim[3];
 	double Pdc_threshold;
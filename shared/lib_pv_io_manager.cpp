@@ -11,9 +11,9 @@ PVIOManager::PVIOManager(compute_module*  cm, std::string cmName)
 	std::unique_ptr<Simulation_IO> ptr2(new Simulation_IO(cm, *m_IrradianceIO));
 	m_SimulationIO = std::move(ptr2);
 
+	// the database itself is only loaded if a subarray uses the shading database
 	std::unique_ptr<ShadeDB8_mpp> shadeDatabase(new ShadeDB8_mpp());
 	m_shadeDatabase = std::move(shadeDatabase);
-	m_shadeDatabase->init();
 
 	std::unique_ptr<Inverter_IO> ptrInv(new Inverter_IO(cm, cmName));
 	m_InverterIO = std::move(ptrInv);
@@ -801,6 +801,12 @@ Module_IO::Module_IO(compute_module* cm, std::string cmName, double dcLoss)
 {
 	modulePowerModel = cm->as_integer("module_model");
 
+	// solution method for the single diode models
+	int singleDiodeSolver = cm->as_integer("module_single_diode_solver");
+	cecModel.Solver = singleDiodeSolver;
+	elevenParamSingleDiodeModel.Solver = singleDiodeSolver;
+	mlModuleModel.Solver = singleDiodeSolver;
+
 	simpleEfficiencyForceNoPOA = false;
 	mountingSpecificCellTemperatureForceNoPOA = false;
 	selfShadingFillFactor = 0;
@@ -932,6 +938,7 @@ Module_IO::Module_IO(compute_module* cm, std::string cmName, double dcLoss)
 			double TbackInteg; */
 
 			mountingSpecificCellTemp.DcDerate = dcLoss;  
+			mountingSpecificCellTemp.WarmStart = cm->as_boolean("cec_warm_start");
 			mountingSpecificCellTemp.MC = cm->as_integer("cec_mounting_config") + 1;
 			mountingSpecificCellTemp.HTD = cm->as_integer("cec_heat_transfer") + 1;
 			mountingSpecificCellTemp.MSO = cm->as_integer("cec_mounting_orientation") + 1;
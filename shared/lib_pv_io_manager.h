@@ -422,6 +422,7 @@ public:
 	flag usePOAFromWeatherFile;			// Flag for whether or not a shading model has been selected that means POA can't be used directly for that subarray
 	ssinputs selfShadingInputs;			// Inputs and calculation methods for self-shading of the subarray
 	ssoutputs selfShadingOutputs;		// Outputs for the self-shading of the subarray
+	ss_surface selfShadingSurface;		// Tabulated self-shading geometry, if enabled for a fixed tilt subarray
 	shading_factor_calculator shadeCalculator; // The shading calculator model for self-shading
 	flag subarrayEnableSnow;            //a copy of the enableSnowModel flag has to exist in each subarray for setting up snow model inputs specific to each subarray
 	pvsnowmodel snowModel;				// A structure to store the geometry inputs for the snow model for this subarray- even though the snow model is system wide, its effect is subarray-dependent
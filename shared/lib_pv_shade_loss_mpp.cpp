@@ -52,6 +52,7 @@
 #include <algorithm>    // std::sort
 #include <math.h> // logarithm function
 #include <cstring> // memcpy
+#include <mutex>
 
 #include "lib_miniz.h" // decompression
 #include "DB8_vmpp_impp_uint8_bin.h" // char* of binary compressed file
@@ -65,8 +66,18 @@ typedef unsigned char uint8;
 typedef unsigned short uint16;
 typedef unsigned int uint;
 
+// uint8 sizes from matlab
+static const size_t db8_vmpp_uint8_size = 12091680;
+static const size_t db8_impp_uint8_size = 12091680;
+static const size_t db8_compressed_size = 3133517; // from modified example5.c in miniz project
+
+// decompressed database shared by all ShadeDB8_mpp instances
+static std::mutex db8_mutex;
+static std::shared_ptr<const std::vector<unsigned char> > db8_shared;
+
 short ShadeDB8_mpp::get_vmpp(size_t i)
 {
+	if (!p_vmpp && !init()) return -1;
 	if (i < 6045840) // uint16 check
 		return (short)((p_vmpp[2 * i + 1] << 8) | p_vmpp[2 * i]); 
 	else 
@@ -75,6 +86,7 @@ short ShadeDB8_mpp::get_vmpp(size_t i)
 
 short ShadeDB8_mpp::get_impp(size_t i)
 { 
+	if (!p_impp && !init()) return -1;
 	if (i < 6045840) // uint16 check
 		return (short)((p_impp[2 * i + 1] << 8) | p_impp[2 * i]); 
 	else 
@@ -82,13 +94,56 @@ short ShadeDB8_mpp::get_impp(size_t i)
 };
 
 
+// offset of the first S vector for N strings, diffuse fraction d and maximum string shading t. each block is
+// preceded by all blocks with fewer strings, then by those with the same strings and a lower diffuse fraction,
+// then by those with lower maximum shading. tabulated once for all (N,d,t) since it is needed for every lookup
+size_t ShadeDB8_mpp::index_offset(size_t N, size_t d, size_t t)
+{
+	static const std::vector<size_t> offsets = []()
+	{
+		const size_t length = 8;
+		std::vector<size_t> table(9 * 11 * 11, 0);
+		for (size_t N = 1; N <= 8; N++)
+		{
+			for (size_t d = 1; d <= 10; d++)
+			{
+				for (size_t t = 1; t <= 10; t++)
+				{
+					size_t ndx = 0; // independent vectors for vmpp,impp,vs and is so offset=0
+					size_t t_ub = 11; // upper bound of t index for iteration
+					size_t d_ub = 10; // upper bound of d index for iteration
+					size_t iN = 0, id = 0, it = 0;
+					do
+					{
+						iN++;
+						d_ub = ((iN == N) ? d : 10);
+						id = 0;
+						do
+						{
+							id++;
+							t_ub = (((iN == N) && (id == d)) ? t : 11);
+							for (it = 1; it < t_ub; it++)
+							{
+								// find number of s vectors and multiply by length of each S vector
+								ndx += n_choose_k(it + iN - 1, it)*length;
+							}
+						} while (id < d_ub);
+					} while (iN < N);
+					table[(N * 11 + d) * 11 + t] = ndx;
+				}
+			}
+		}
+		return table;
+	}();
+	return offsets[(N * 11 + d) * 11 + t];
+}
+
 bool ShadeDB8_mpp::get_index(const size_t &N, const size_t &d, const  size_t &t, const size_t &S, const  db_type &DB_TYPE, size_t* ret_ndx)
 {
 	bool ret_val = false;
 	//size_t ret_ndx=-1;
 	size_t length=0;
 //	size_t length_t =10, length_d=10;
-	size_t iN = 0, id = 0, it = 0;
 
 	// ret_ndx==0 is an error condition.
 	// check N
@@ -115,29 +170,7 @@ bool ShadeDB8_mpp::get_index(const size_t &N, const size_t &d, const  size_t &t,
 			break;
 	}
 	if (length == 0) return ret_val;
-	*ret_ndx = 0; // independent vectors for vmpp,impp,vs and is so offset=0
-
-	size_t t_ub = 11; // upper bound of t index for iteration
-	size_t d_ub = 10; // upper bound of d index for iteration
-	do
-	{
-		iN++;
-		d_ub = ((iN == N) ? d : 10);
-		id = 0;
-		do
-		{
-			id++;
-			t_ub = (((iN==N) && (id==d)) ? t : 11);
-			for (it = 1; it < t_ub; it++)
-			{
-				// find number of s vectors
-				size_s = n_choose_k(it + iN - 1, it);
-				// multiply by length of each S vector
-				*ret_ndx += size_s*length;
-			}
-		} while (id < d_ub);
-	} while (iN < N);
-	*ret_ndx += (S - 1)*length;
+	*ret_ndx = index_offset(N, d, t) + (S - 1)*length;
 	ret_val = true;
 	return ret_val;
 }
@@ -184,50 +217,49 @@ std::vector<double> ShadeDB8_mpp::get_vector(const size_t &N, const size_t &d, c
 	return ret_vec;
 }
 
-void ShadeDB8_mpp::init()
+bool ShadeDB8_mpp::init()
 {
-	p_error_msg = "";
+	if (p_db) return true;
+
 	p_warning_msg = "";
-	p_vmpp_uint8_size = 12091680; // uint8 size from matlab
-	p_impp_uint8_size = 12091680; // uint8 size from matlab
-	p_vmpp = (unsigned char *)malloc(p_vmpp_uint8_size);//malloc(12091680); uint8 size
-	p_impp = (unsigned char *)malloc(p_impp_uint8_size);//malloc(12091680); uint8 size
-	p_compressed_size = 3133517; // from modified example5.c in miniz project
-	decompress_file_to_uint8();
+	p_error_msg = "";
+	{
+		std::lock_guard<std::mutex> lock(db8_mutex);
+		if (!db8_shared)
+		{
+			// only share the database once it is decompressed, so a failure is reported to the caller and retried by the next
+			std::shared_ptr<std::vector<unsigned char> > db(new std::vector<unsigned char>(db8_vmpp_uint8_size + db8_impp_uint8_size));
+			if (!decompress_file_to_uint8(*db, p_error_msg))
+				return false;
+			db8_shared = db;
+		}
+		p_db = db8_shared;
+	}
+	p_vmpp = &(*p_db)[0];
+	p_impp = p_vmpp + db8_vmpp_uint8_size;
+	return true;
 }
 
 ShadeDB8_mpp::~ShadeDB8_mpp()
 {
-	if (p_vmpp)
-		free(p_vmpp);
-	if (p_impp)
-		free(p_impp);
+	/* the shared database stays loaded for later instances */
 }
 
 
 
-bool ShadeDB8_mpp::decompress_file_to_uint8()
+bool ShadeDB8_mpp::decompress_file_to_uint8(std::vector<unsigned char> &db, std::string &error)
 {
 	size_t status;
-	uint8 *pTmp_data;
-
-	size_t mem_size = p_vmpp_uint8_size + p_impp_uint8_size;
 
-	pTmp_data = (uint8 *)malloc(mem_size);
-
-	status = tinfl_decompress_mem_to_mem((void *)pTmp_data, mem_size, pCmp_data, p_compressed_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
-
-	memcpy(p_vmpp, pTmp_data, p_vmpp_uint8_size);
-	memcpy(p_impp, pTmp_data + p_vmpp_uint8_size, p_impp_uint8_size);
-
-	free(pTmp_data);
+	// vmpp and impp are stored back to back in the decompressed data, so it is inflated in place
+	status = tinfl_decompress_mem_to_mem((void *)&db[0], db.size(), pCmp_data, db8_compressed_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
 
 	if (status == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED)
 	{
 		std::stringstream outm;
 		outm << "tinfl_decompress_mem_to_mem() failed with status " << (int)status;
-		p_error_msg = outm.str();
-		return EXIT_FAILURE;
+		error = outm.str();
+		return false;
 	}
 
 	return true;
@@ -235,191 +267,97 @@ bool ShadeDB8_mpp::decompress_file_to_uint8()
 
 double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<double> &shade_frac, bool use_pv_cell_temp, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi)
 {
-	double shade_loss = 0;
-	// shading fractions for each string
-	size_t num_strings = shade_frac.size();
 	// check for valid DB values
 	if (dpoa > gpoa)
 		dpoa = gpoa;
-	if (num_strings > 0)
+
+	string_case sc = get_string_case(shade_frac.size() > 0 ? &shade_frac[0] : NULL, shade_frac.size());
+
+	//Sort in descending order of shading and scale to 10s, as before, for callers that use the fractions afterwards
+	std::sort(shade_frac.begin(), shade_frac.end(), std::greater<double>());
+	for (size_t i = 0; i < shade_frac.size(); i++)
+		shade_frac[i] /= 10.0;
+
+	return get_shade_loss(gpoa, dpoa, sc, use_pv_cell_temp, pv_cell_temp, mods_per_str, str_vmp_stc, mppt_lo, mppt_hi);
+}
+
+ShadeDB8_mpp::string_case ShadeDB8_mpp::get_string_case(const double *shade_frac, size_t num_strings)
+{
+	string_case sc;
+	sc.num_strings = num_strings;
+	sc.s_max = -1;
+	sc.s_sum = 0;
+	sc.S = 0;
+	if (num_strings < 1) return sc;
+
+	// rounded shading of each string in tens of percent, in descending order
+	int str_shade[8];
+	for (size_t i = 0; i < num_strings; i++)
+	{
+		int s = (int)round(shade_frac[i] / 10.0);
+		if (s > sc.s_max) sc.s_max = s;
+		sc.s_sum += s;
+		if (i < 8) str_shade[i] = s;
+	}
+	if (num_strings > 8) return sc; // beyond the database
+
+	// sorting the rounded values gives the same order as rounding the sorted values, since rounding is monotonic
+	std::sort(str_shade, str_shade + num_strings, std::greater<int>());
+
+	// index of the string case among all descending cases with the same maximum, in the order the database is built:
+	// each later string from 0 up to the one before it, with the last string of the case always taken at its largest
+	// value when there are three or more strings
+	sc.S = 1;
+	if (num_strings == 2)
+		sc.S += str_shade[1];
+	else if (num_strings > 2)
 	{
-		//Sort in descending order of shading
-		std::sort(shade_frac.begin(), shade_frac.end(), std::greater<double>());
-		//Need to round them to 10s (note should be integer)
-		for (size_t i = 0; i < num_strings; i++)
-			shade_frac[i] /= 10.0;
-		std::vector<int> str_shade;
-		for (size_t i = 0; i < num_strings; i++)
-			str_shade.push_back((int)round(shade_frac[i]));
-		int s_max = -1; // = str_shade[0]
-		int s_sum = 0; // = str_shade[0] that is if first element zero then sum should be zero
-		for (size_t i = 0; i < num_strings; i++)
+		for (size_t k = 1; k + 1 < num_strings; k++)
 		{
-			if (str_shade[i] > s_max) s_max = str_shade[i];
-			s_sum += str_shade[i];
+			size_t m = num_strings - 1 - k; // strings after this one
+			for (int j = 0; j < str_shade[k]; j++)
+				sc.S += n_choose_k(j + m, m);
 		}
+		sc.S += str_shade[num_strings - 2];
+	}
+	return sc;
+}
+
+double ShadeDB8_mpp::get_shade_loss(double gpoa, double dpoa, const string_case &sc, bool use_pv_cell_temp, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi)
+{
+	double shade_loss = 0;
+	// check for valid DB values
+	if (dpoa > gpoa)
+		dpoa = gpoa;
+	if (sc.num_strings > 0)
+	{
 		//Now get the indices for the DB
-		if ((s_sum > 0) && (gpoa > 0))
+		if ((sc.s_sum > 0) && (gpoa > 0))
 		{
 			int diffuse_frac = (int)round(dpoa * 10.0 / gpoa);
 			if (diffuse_frac < 1) diffuse_frac = 1;
-			int counter = 1;
-			bool found = false;
-			if (num_strings > 1)
+
+			double vmpp[8], impp[8];
+			size_t n = 0, ndx;
+			if (sc.S > 0 && get_index(sc.num_strings, diffuse_frac, sc.s_max, sc.S, ShadeDB8_mpp::VMPP, &ndx))
 			{
-				counter = 0;
-				for (int i2 = 0; i2 <= s_max; i2++)
+				n = 8;
+				for (size_t i = 0; i < n; i++)
 				{
-					if (num_strings == 2)
-					{
-						counter++;
-						std::vector<int> cur_case; // not on OS X { s_max, i2 };
-						cur_case.push_back(s_max);
-						cur_case.push_back(i2);
-						if (str_shade == cur_case)
-							found = true;
-					}
-					else
-					{
-						for (int i3 = 0; i3 <= i2; i3++)
-						{
-							if (num_strings == 3)
-							{
-								counter++;
-								std::vector<int> cur_case; //{ s_max, i2, i3 };
-								cur_case.push_back(s_max);
-								cur_case.push_back(i2);
-								cur_case.push_back(i3);
-								if (str_shade == cur_case)
-									found = true;
-							}
-							else
-							{
-								for (int i4 = 0; i4 <= i3; i4++)
-								{
-									if (num_strings == 4)
-									{
-										counter++;
-										std::vector<int> cur_case;// { s_max, i2, i3, i4 };
-										cur_case.push_back(s_max);
-										cur_case.push_back(i2);
-										cur_case.push_back(i3);
-										cur_case.push_back(i4);
-										if (str_shade == cur_case)
-											found = true;
-									}
-									else
-									{
-										for (int i5 = 0; i5 <= i4; i5++)
-										{
-											if (num_strings == 5)
-											{
-												counter++;
-												std::vector<int> cur_case;// { s_max, i2, i3, i4, i5 };
-												cur_case.push_back(s_max);
-												cur_case.push_back(i2);
-												cur_case.push_back(i3);
-												cur_case.push_back(i4);
-												cur_case.push_back(i5);
-												if (str_shade == cur_case)
-													found = true;
-											}
-											else
-											{
-												for (int i6 = 0; i6 <= i5; i6++)
-												{
-													if (num_strings == 6)
-													{
-														counter++;
-														std::vector<int> cur_case;// { s_max, i2, i3, i4, i5, i6 };
-														cur_case.push_back(s_max);
-														cur_case.push_back(i2);
-														cur_case.push_back(i3);
-														cur_case.push_back(i4);
-														cur_case.push_back(i5);
-														cur_case.push_back(i6);
-														if (str_shade == cur_case)
-															found = true;
-													}
-													else
-													{
-														for (int i7 = 0; i7 <= i6; i7++)
-														{
-															if (num_strings == 7)
-															{
-																counter++;
-																std::vector<int> cur_case;// { s_max, i2, i3, i4, i5, i6, i7 };
-																cur_case.push_back(s_max);
-																cur_case.push_back(i2);
-																cur_case.push_back(i3);
-																cur_case.push_back(i4);
-																cur_case.push_back(i5);
-																cur_case.push_back(i6);
-																cur_case.push_back(i7);
-																if (str_shade == cur_case)
-																	found = true;
-															}
-															else
-															{
-																for (int i8 = 0; i8 <= i7; i8++)
-																{
-																	if (num_strings == 8)
-																	{
-																		counter++;
-																		std::vector<int> cur_case; // { s_max, i2, i3, i4, i5, i6, i7, i8 };
-																		cur_case.push_back(s_max);
-																		cur_case.push_back(i2);
-																		cur_case.push_back(i3);
-																		cur_case.push_back(i4);
-																		cur_case.push_back(i5);
-																		cur_case.push_back(i6);
-																		cur_case.push_back(i7);
-																		cur_case.push_back(i8);
-																		if (str_shade == cur_case)
-																			found = true;
-																	}
-																	else
-																	{
-																		// error message or throw error
-																		counter = 0;
-																	}
-																} // for i7
-																if (found) break;
-
-															}
-														} // for i7
-														if (found) break;
-													}
-												} // for i6
-												if (found) break;
-											}
-										} // for i5
-										if (found) break;
-									}
-								} // for i4
-								if (found) break;
-							}
-						} // for i3
-						if (found) break;
-					}
-					if (found) break;
-				} // for i2
-			} // (num_strings > 1)
-
-
-
-			std::vector<double>vmpp = get_vector(num_strings, diffuse_frac, s_max, counter, ShadeDB8_mpp::VMPP);
-			std::vector<double>impp = get_vector(num_strings, diffuse_frac, s_max, counter, ShadeDB8_mpp::IMPP);
+					vmpp[i] = (double)get_vmpp(ndx + i) / 1000.0;
+					impp[i] = (double)get_impp(ndx + i) / 1000.0;
+				}
+			}
 			double p_max_frac = 0;
 
 			// temp correction and out of global MPP
 			int p_max_ind = 0;
-			std::vector<double> pmp_fracs;
+			double pmp_fracs[8];
 
-			for (size_t i = 0; i < vmpp.size() && i < impp.size(); i++)
+			for (size_t i = 0; i < n; i++)
 			{
 				double pmp = vmpp[i] * impp[i];
-				if (use_pv_cell_temp) pmp_fracs.push_back(pmp);
+				pmp_fracs[i] = pmp;
 				if (pmp > p_max_frac)
 				{
 					p_max_frac = pmp;
@@ -427,7 +365,7 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 				}
 			}
 
-			if (use_pv_cell_temp)
+			if (use_pv_cell_temp && n > 0)
 			{
 				/*
 				%Try scaling the voltages using the Sandia model.Taking numbers from
@@ -435,7 +373,7 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 				%Trina 250 PA05 which the database was build from.But user may need more
 				%input into this!!!
 				*/
-				double n = 1.263;
+				double n_diode = 1.263;
 				double BetaVmp = -0.137*mods_per_str; //mult by ModsPerString because it's in V
 				double Ns = 60 * mods_per_str; //X modules, each with 60 cells
 				double C2 = -0.05871;
@@ -443,16 +381,15 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 				double k = 1.38066E-23; //J / K, Boltzmann's constant
 				double q = 1.60218E-19;  // Coulomb, elementary charge
 				double Tc = pv_cell_temp;
-				double deltaTc = n*k*(Tc + 273.15) / q; //Thermal voltage
+				double deltaTc = n_diode*k*(Tc + 273.15) / q; //Thermal voltage
 				double VMaxSTCStrUnshaded = str_vmp_stc;
 				double scale_g = gpoa / 1000.0;
 //				double TcVmpMax = vmpp[p_max_ind] * VMaxSTCStrUnshaded + C2*Ns*deltaTc*::log(scale_g) + C3*Ns*pow((deltaTc*::log(scale_g)), 2) + BetaVmp*(Tc - 25);
 //				double TcVmpScale = TcVmpMax / vmpp[p_max_ind] / VMaxSTCStrUnshaded;
 
-				std::vector<double> TcVmps;
-
-				for (size_t i = 0; i < vmpp.size(); i++)
-					TcVmps.push_back(vmpp[i] * VMaxSTCStrUnshaded + C2*Ns*deltaTc*::log(scale_g) + C3*Ns*pow((deltaTc*::log(scale_g)), 2) + BetaVmp*(Tc - 25));
+				double TcVmps[8];
+				for (size_t i = 0; i < n; i++)
+					TcVmps[i] = vmpp[i] * VMaxSTCStrUnshaded + C2*Ns*deltaTc*::log(scale_g) + C3*Ns*pow((deltaTc*::log(scale_g)), 2) + BetaVmp*(Tc - 25);
 				/*
 				%Now want to choose the point with a V in range and highest power
 				%First, figure out which max power point gives lowest loss
@@ -465,7 +402,7 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 				{
 					//	The global max power point is NOT in range
 					double p_frac = 0;
-					for (size_t i = 0; i < TcVmps.size() && i < pmp_fracs.size(); i++)
+					for (size_t i = 0; i < n; i++)
 					{
 						if ((TcVmps[i] >= mppt_lo) && (TcVmps[i] <= mppt_hi))
 						{
@@ -481,7 +418,7 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 #ifdef SHADE_DB_DEBUG
 				std::stringstream outm;
 				outm << "\ni,Vmpp,Impp,pmp_fracs,TcVmps\n";
-				for (size_t i = 0; i < TcVmps.size() && i < pmp_fracs.size(); i++)
+				for (size_t i = 0; i < n; i++)
 				{
 					outm << i << "," << vmpp[i] << "," << impp[i] << "," << pmp_fracs[i] << "," << TcVmps[i] << "\n";
 				}
@@ -490,7 +427,7 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 #endif
 
 			}
-			else // assume global max power point
+			else // assume global max power point, or no database entry for the strings
 			{
 				shade_loss = 1.0 - p_max_frac;
 			}
@@ -498,13 +435,13 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 		} //(sum >0)
 		else // either shade frac sum = 0 or global = 0
 		{
-			if (s_sum <= 0) // to match with Matlab results
+			if (sc.s_sum <= 0) // to match with Matlab results
 				shade_loss = 0.0;
 			else
 				shade_loss = 0.0;
 #ifdef SHADE_DB_DEBUG
 			std::stringstream outm;
-			outm << "\nglobal = " << gpoa << " and shade fraction = " << s_sum << " and shade loss = " << shade_loss << "\n";
+			outm << "\nglobal = " << gpoa << " and shade fraction = " << sc.s_sum << " and shade loss = " << shade_loss << "\n";
 			p_warning_msg = outm.str();
 #endif
 		}
@@ -56,9 +56,12 @@
 #include <vector>
 #include <stdlib.h>
 #include <string>
+#include <memory>
 
 extern const unsigned char pCmp_data[3133517];
 // shading database with up to 8 strings
+// the decompressed database is immutable and shared by all instances in the process. it is
+// decompressed the first time any instance needs it, either through init() or on the first lookup.
 class ShadeDB8_mpp
 {
 public:
@@ -68,7 +71,9 @@ public:
 		p_impp=NULL ;
 	};
 	~ShadeDB8_mpp();
-	void init();
+	// decompress the shared database if it isn't already, returns false and sets the error if that fails
+	bool init();
+	bool is_initialized() { return p_vmpp != NULL; }
 	short vmpp(size_t ndx){
 		return get_vmpp(ndx);
 	};
@@ -76,23 +81,34 @@ public:
 		return get_impp(ndx);
 	};
 	std::vector<double> get_vector(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE);
-	size_t n_choose_k(size_t n, size_t k);
+	static size_t n_choose_k(size_t n, size_t k);
 	bool get_index(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE, size_t* ret_ndx);
 
 	double get_shade_loss(double &gpoa, double &dpoa, std::vector<double> &shade_frac, bool use_pv_cell_temp = false, double pv_cell_temp = 0, int mods_per_str = 0, double str_vmp_stc = 0, double mppt_lo = 0, double mppt_hi = 0);
+
+	// the database case for a set of strings depends only on their shading, so for a table of string shading
+	// it can be found once per row and reused for every lookup with the row
+	struct string_case
+	{
+		size_t num_strings;
+		int s_max; // largest string shading, rounded to tens of percent
+		int s_sum; // sum of the rounded string shading
+		size_t S; // index of the case in the database, zero if there are more strings than the database has
+	};
+	static string_case get_string_case(const double *shade_frac, size_t num_strings); // shade_frac in % shaded
+	double get_shade_loss(double gpoa, double dpoa, const string_case &sc, bool use_pv_cell_temp = false, double pv_cell_temp = 0, int mods_per_str = 0, double str_vmp_stc = 0, double mppt_lo = 0, double mppt_hi = 0);
 	std::string get_warning() { return p_warning_msg; }
 	std::string get_error() { return p_error_msg; }
 
 
 private:
-	unsigned char *p_vmpp;
-	unsigned char *p_impp;
+	const unsigned char *p_vmpp;
+	const unsigned char *p_impp;
 	short get_vmpp(size_t i);
 	short get_impp(size_t i);
-	bool decompress_file_to_uint8();
-	size_t p_vmpp_uint8_size;
-	size_t p_impp_uint8_size;
-	size_t p_compressed_size;
+	static size_t index_offset(size_t N, size_t d, size_t t);
+	static bool decompress_file_to_uint8(std::vector<unsigned char> &db, std::string &error);
+	std::shared_ptr<const std::vector<unsigned char> > p_db;
 	std::string p_warning_msg;
 	std::string p_error_msg;
 };
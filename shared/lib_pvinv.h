@@ -95,6 +95,21 @@ public:
 		double *Pntloss /* Power loss due to night time tare loss (Wac) */
 		);
 
+	//same as above, with the input power for each MPPT input in a plain array so that no memory is allocated
+	bool acpower(
+		/* inputs */
+		size_t nMppt,       /* Number of MPPT inputs on the inverter */
+		const double Pdc[], /* Input power to ONE inverter at each MPPT input (Wdc) */
+
+		/* outputs */
+		double *Pac,    /* AC output power (Wac) */
+		double *Plr,    /* Part load ratio (Pdc_in/Pdc_rated, 0..1) */
+		double *Ppar,   /* AC parasitic power consumption (Wac) */
+		double *Eff,	    /* Conversion efficiency (0..1) */
+		double *Pcliploss, /* Power loss due to clipping loss (Wac) */
+		double *Pntloss /* Power loss due to night time tare loss (Wac) */
+		);
+
 } ;
 
 #endif
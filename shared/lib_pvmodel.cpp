@@ -99,6 +99,15 @@ std::string pvcelltemp_t::error()
 	return m_err;
 }
 
+bool pvcelltemp_t::calc_array( size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] )
+{
+	bool ok = true;
+	for ( size_t i = 0; i < n; i++ )
+		if ( !(*this)( input[i], module, opvoltage ? opvoltage[i] : -1.0, Tcell[i] ) )
+			ok = false;
+	return ok;
+}
+
 pvoutput_t::pvoutput_t()
 {
 	Power = Voltage = Current = Efficiency
@@ -126,6 +135,15 @@ std::string pvmodule_t::error()
 	return m_err;
 }
 
+bool pvmodule_t::calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] )
+{
+	bool ok = true;
+	for ( size_t i = 0; i < n; i++ )
+		if ( !(*this)( input[i], TcellC[i], opvoltage ? opvoltage[i] : -1.0, output[i] ) )
+			ok = false;
+	return ok;
+}
+
 spe_module_t::spe_module_t( )
 {
 	VmpNominal = 0;
@@ -185,6 +203,11 @@ bool spe_module_t::operator() ( pvinput_t &input, double TcellC, double , pvoutp
 	return true;
 }
 
+bool spe_module_t::calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] )
+{
+	return pvmodule_calc_array( *this, n, input, TcellC, opvoltage, output );
+}
+
 /******** BEGIN GOLDEN METHOD CODE FROM NR3 *********/
 
 #define GOLD 1.618034
@@ -494,3 +517,150 @@ double maxpower_5par_rec( double Voc_ubound, double a, double Il, double Io, dou
 	return P;
 }
 
+double lambertw_exp( double x )
+{
+/*
+	Solves w + ln(w) = x with Newton's method, so W(exp(x)) is found without
+	overflow for the large arguments that occur at high shunt resistance.
+	Starting below exp(1+x) keeps every iterate positive, and since the
+	function is concave the iterates approach the root from below after
+	the first step.
+*/
+	if ( x < -40 ) return exp(x); // W(z) = z - z^2 + ...
+
+	double w;
+	if ( x > 1 )
+	{
+		double lx = log(x);
+		w = x - lx + lx/x; // asymptotic expansion
+	}
+	else
+		w = exp(x)/(1+exp(x));
+
+	for ( int it = 0; it < 50; it++ )
+	{
+		double wnew = w*(1 + x - log(w))/(1 + w);
+		if ( fabs(wnew-w) <= 1e-13*wnew )
+			return wnew;
+		w = wnew;
+	}
+	return w;
+}
+
+// explicit solution of the single diode equation for current (Jain and Kapoor, 2004),
+// with the constants that do not depend on voltage worked out once
+struct lambertw_5par
+{
+	double a, Il, Io, Rs, Rsh;
+	double logc; // log of Rs Rsh Io / (a (Rs+Rsh)), the Lambert W argument at V = -Rs (Il+Io)
+	double dxdV;
+
+	lambertw_5par( double _a, double _Il, double _Io, double _Rs, double _Rsh )
+		: a(_a), Il(_Il), Io(_Io), Rs(_Rs), Rsh(_Rsh)
+	{
+		logc = ( Rs > 0 ) ? log( Rs*Rsh*Io/(a*(Rs+Rsh)) ) : 0;
+		dxdV = Rsh/(a*(Rs+Rsh));
+	}
+
+	// current and its first two derivatives with respect to voltage
+	double current( double V, double *dIdV = 0, double *d2IdV2 = 0 ) const
+	{
+		double I;
+		if ( Rs <= 0 )
+		{
+			double e = Io/a*exp(V/a);
+			I = Il - Io*(exp(V/a)-1.0) - V/Rsh;
+			if ( dIdV ) *dIdV = -e - 1/Rsh;
+			if ( d2IdV2 ) *d2IdV2 = -e/a;
+		}
+		else
+		{
+			double x = logc + dxdV*(Rs*(Il+Io) + V);
+			double w = lambertw_exp( x );
+
+			// the shunt current and the Lambert W term nearly cancel when the argument is large,
+			// so then w + ln(w) = x is used to write the current without the subtraction
+			if ( x > 10 )
+				I = ( a*(log(w) - logc) - V )/Rs;
+			else
+				I = (Rsh*(Il+Io) - V)/(Rs+Rsh) - a/Rs*w;
+
+			double dwdx = w/(1+w);
+			if ( dIdV ) *dIdV = -( 1 + Rsh/Rs*dwdx )/(Rs+Rsh);
+			if ( d2IdV2 ) *d2IdV2 = -Rsh/Rs/(Rs+Rsh) * dwdx/((1+w)*(1+w)) * dxdV;
+		}
+		return I;
+	}
+};
+
+double current_5par_lambertw( double V, double A, double IL, double IO, double RS, double RSH )
+{
+	lambertw_5par m( A, IL, IO, RS, RSH );
+	return max(0.0, m.current( V ));
+}
+
+double openvoltage_5par_lambertw( double a, double IL, double IO, double Rsh )
+{
+/*
+	Explicit solution for open-circuit voltage, V = a ln( a W / (IO Rsh) ), with
+	W evaluated at IO Rsh/a exp( Rsh (IL+IO)/a )
+*/
+	if ( IL <= 0 ) return 0;
+	double w = lambertw_exp( log(IO*Rsh/a) + Rsh*(IL+IO)/a );
+	return a*log( a*w/(IO*Rsh) );
+}
+
+double maxpower_5par_lambertw( double a, double Il, double Io, double Rs, double Rsh, double *__Vmp, double *__Imp, double *__Voc )
+{
+/*
+	Newton's method on dP/dV = I + V dI/dV, which falls from Isc at short circuit
+	to a negative value at open circuit.  Steps that leave the bracket around the
+	zero are replaced by bisection.
+*/
+	double P = 0, V = 0, I = 0;
+	double Voc = openvoltage_5par_lambertw( a, Il, Io, Rsh );
+	if ( Voc > 0 )
+	{
+		lambertw_5par m( a, Il, Io, Rs, Rsh );
+		double vlo = 0, vhi = Voc;
+		V = 0.8*Voc;
+		for ( int it = 0; it < 100; it++ )
+		{
+			double dIdV, d2IdV2;
+			I = m.current( V, &dIdV, &d2IdV2 );
+			double f = I + V*dIdV;
+			double fprime = 2*dIdV + V*d2IdV2;
+
+			if ( f > 0 ) vlo = V;
+			else vhi = V;
+
+			double Vnew = V - f/fprime;
+			if ( !(Vnew > vlo && Vnew < vhi) )
+				Vnew = (vlo + vhi)/2;
+
+			bool done = fabs(Vnew-V) < 1e-10*Voc;
+			V = Vnew;
+			if ( done ) break;
+		}
+		I = max(0.0, m.current( V ));
+		P = V*I;
+	}
+
+	if ( __Vmp ) *__Vmp = V;
+	if ( __Imp ) *__Imp = I;
+	if ( __Voc ) *__Voc = Voc;
+	return P;
+}
+
+void maxpower_5par_batch( size_t n, const double *a, const double *Il, const double *Io, const double *Rs, const double *Rsh,
+	double *Pmp, double *Vmp, double *Imp, double *Voc )
+{
+	for ( size_t i = 0; i < n; i++ )
+	{
+		double V, I, V_oc;
+		Pmp[i] = maxpower_5par_lambertw( a[i], Il[i], Io[i], Rs[i], Rsh[i], &V, &I, &V_oc );
+		if ( Vmp ) Vmp[i] = V;
+		if ( Imp ) Imp[i] = I;
+		if ( Voc ) Voc[i] = V_oc;
+	}
+}
@@ -51,6 +51,7 @@
 #define __pvmodulemodel_h
 
 #include <string>
+#include <cstddef>
 
 class pvcelltemp_t;
 class pvpower_t;
@@ -112,6 +113,10 @@ protected:
 public:
 	
 	virtual bool operator() ( pvinput_t &input, pvmodule_t &module, double opvoltage, double &Tcell ) = 0;
+
+	// cell temperature for n timesteps in one call, opvoltage may be NULL for operation at max power.
+	// returns false if any timestep failed.  the default calls operator() for each timestep
+	virtual bool calc_array( size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] );
 	std::string error();
 
 	virtual ~pvcelltemp_t() {};
@@ -131,6 +136,10 @@ public:
 
 
 	virtual bool operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &output ) = 0;
+
+	// module output for n timesteps in one call, opvoltage may be NULL for operation at max power.
+	// returns false if any timestep failed.  the default calls operator() for each timestep
+	virtual bool calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] );
 	std::string error();
 
 	virtual ~pvmodule_t() {};
@@ -161,10 +170,36 @@ public:
 	virtual double VocRef() { return VocNominal; }
 	virtual double IscRef() { return ImpRef()*1.3; }
 	virtual bool operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &output);
+	virtual bool calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] );
 
 	virtual ~spe_module_t() {};
 };
 
+/*
+	Loops over the operator() of model class T for each timestep, naming the class so that the calls are
+	bound at compile time and can be inlined.  The models implement calc_array with these in the same
+	source file as their operator().
+*/
+template< typename T >
+bool pvmodule_calc_array( T &model, size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] )
+{
+	bool ok = true;
+	for ( size_t i = 0; i < n; i++ )
+		if ( !model.T::operator()( input[i], TcellC[i], opvoltage ? opvoltage[i] : -1.0, output[i] ) )
+			ok = false;
+	return ok;
+}
+
+template< typename T >
+bool pvcelltemp_calc_array( T &model, size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] )
+{
+	bool ok = true;
+	for ( size_t i = 0; i < n; i++ )
+		if ( !model.T::operator()( input[i], module, opvoltage ? opvoltage[i] : -1.0, Tcell[i] ) )
+			ok = false;
+	return ok;
+}
+
 #define AOI_MIN 0.5
 #define AOI_MAX 89.5
 
@@ -176,6 +211,18 @@ double maxpower_5par( double Voc_ubound, double a, double Il, double Io, double
 double maxpower_5par_rec(double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double D2MuTau, double Vbi, double *__Vmp=0, double *__Imp=0);
 double air_mass_modifier( double Zenith_deg, double Elev_m, double a[5] );
 
+// Solution methods for the single diode equation in the five parameter models.  The iterative
+// method is the original golden section search, the Lambert W method solves the equation explicitly
+// and is used where there is no recombination loss term
+enum { SINGLE_DIODE_ITERATIVE, SINGLE_DIODE_LAMBERTW };
+
+double lambertw_exp( double x ); // principal branch of the Lambert W function evaluated at exp(x)
+double current_5par_lambertw( double V, double A, double IL, double IO, double RS, double RSH );
+double openvoltage_5par_lambertw( double a, double IL, double IO, double Rsh );
+double maxpower_5par_lambertw( double a, double Il, double Io, double Rs, double Rsh, double *Vmp=0, double *Imp=0, double *Voc=0 );
+void maxpower_5par_batch( size_t n, const double *a, const double *Il, const double *Io, const double *Rs, const double *Rsh,
+	double *Pmp, double *Vmp=0, double *Imp=0, double *Voc=0 );
+
 
 
 #endif
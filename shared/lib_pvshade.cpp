@@ -94,14 +94,14 @@ double mask_angle_func(double x, double R, double B, double tilt_eff)
 #define K 5
 #define FUNC(x,R,B,tilt) ((*func)(x,R,B,tilt))
 
-double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n)
+// s is the estimate from the previous refinement (n-1), passed in rather than kept in a static so that the integration is reentrant
+double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n, double s)
 {
 	double x,tnm,sum,del;
-	static double s;
 	int it,j;
 	if (n == 1) 
 	{
-		return (s=0.5*(b-a)*(FUNC(a,R,B,tilt)+FUNC(b,R,B,tilt)));
+		return 0.5*(b-a)*(FUNC(a,R,B,tilt)+FUNC(b,R,B,tilt));
 	} 
 	else 
 	{
@@ -160,7 +160,7 @@ void polint(double xa[], double ya[], int n, double x, double *y, double *dy)
 double qromb(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt)
 {
 	void polint(double xa[], double ya[], int n, double x, double *y, double *dy);
-	double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n);
+	double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n, double s);
 	void nrerror(char error_text[]);
 	double ss,dss;
 	double s[JMAXP],h[JMAXP+1];
@@ -168,7 +168,7 @@ double qromb(double (*func)(double,double,double,double), double a, double b, do
 	h[1]=1.0;
 	for (j=1;j<=JMAX;j++) 
 	{
-		s[j]=trapzd(func,a,b,R,B,tilt,j);
+		s[j]=trapzd(func,a,b,R,B,tilt,j,(j > 1) ? s[j-1] : 0.0);
 		if (j >= K) 
 		{
 			polint(&h[j-K],&s[j-K],K,0.0,&ss,&dss);
@@ -303,116 +303,65 @@ void selfshade_xs_horstr(bool landscape,
 	}
 }
 
-// self-shading calculation function
-/*
-
-Chris Deline 4/9/2012 - updated 4/19/2012 - update 4/23/2012
-see SAM shade geometry_v2.docx
-Updated 1/18/13 to match new published coefficients in Solar Energy "A simplified model of uniform shading in large photovoltaic arrays"
-
-Definitions of X and S in SAM for the four layout conditions  portrait, landscape and vertical / horizontal strings.
-Definitions:
-S: Fraction of submodules that are shaded in a given parallel string
-X: Fraction of parallel strings in the system that are shaded
-m: modules along side of row
-n: modules along bottom of row
-d:  # of diodes per module
-W: module width
-L: module length
-r: number of rows
-Hs: shadow height along inclined plane from Applebaum eqn. A13
-g: shadow distance from row edge from Applebaum eq. A12
-
-B: array length along side (m*L in portrait, m*W in landscape configuration) = Appelbaum paper A
-beta: effective tilt angle
-alpha: solar elevation angle
-R: inter-row spacing
-phi_bar: average masking angle
-
-*/
-bool ss_exec(
-	
-	const ssinputs &inputs,
-
-	double tilt,		// module tilt (constant for fixed tilt, varies for one-axis)
-	double azimuth,		// module azimuth (constant for fixed tilt, varies for one-axis)
-	double solzen,		// solar zenith (deg)
-	double solazi,		// solar azimuth (deg)
-	double Gb_nor,		// beam normal irradiance (W/m2)
-	double Gb_poa,		// POA beam irradiance (W/m2)
-	double Gd_poa,		// POA diffuse, sky+gnd (W/m2)
-	double albedo,		// used to calculate reduced relected irradiance
-	bool trackmode,		// 0 for fixed tilt, 1 for one-axis tracking
-	bool linear,		// 0 for non-linear shading (C. Deline's full algorithm), 1 to stop at linear shading
-	double shade_frac_1x,	// geometric calculation of the fraction of one-axis row that is shaded (0-1), not used if fixed tilt 
-
-	ssoutputs &outputs)
+// translate inputs to variable names consistent with C. Deline's self-shading paper for clarity
+struct ss_dimensions
 {
+	double m_m, m_n, m_d, m_W, m_L, m_r, m_R;
+	double m_B;				// length of the side of a row
+	double m_row_length;	// length of the row
 
-	// ***********************************
-	// VARIABLE ASSIGNMENTS
-	// ***********************************
-
-	// translate inputs to variable names consistent with C. Deline's self-shading paper for clarity
-	double m_m = inputs.nmody;
-	double m_n = inputs.nmodx;
-	double m_d = inputs.ndiode;
-	double m_W = inputs.width;
-	double m_L = inputs.length;
-	double m_r = inputs.nrows;
-	double m_R = inputs.row_space;
-
-	// check for divide by zero issues with Row spacing per email from Chris 5/2/12
-	if (m_R < M_EPS) m_R = M_EPS;
-
-	// calculate the mask angle
-	// NOTE THAT B HERE IS PER CHRIS DELINE'S PAPER: B IS THE LENGTH OF THE SIDE OF A ROW
-	double m_B;
-	if (inputs.mod_orient == 0) m_B = m_L * m_m;	// Portrait Mode
-	else m_B = m_W * m_m;	// Landscape Mode
-
-	// calculate the length of the row also
-	double m_row_length;
-	if (inputs.mod_orient == 0) m_row_length = m_n * m_W; //Portrait Mode
-	else m_row_length = m_n * m_L; //Landscape Mode
+	ss_dimensions(const ssinputs &inputs)
+	{
+		m_m = inputs.nmody;
+		m_n = inputs.nmodx;
+		m_d = inputs.ndiode;
+		m_W = inputs.width;
+		m_L = inputs.length;
+		m_r = inputs.nrows;
+		m_R = inputs.row_space;
+
+		// check for divide by zero issues with Row spacing per email from Chris 5/2/12
+		if (m_R < M_EPS) m_R = M_EPS;
+
+		// NOTE THAT B HERE IS PER CHRIS DELINE'S PAPER: B IS THE LENGTH OF THE SIDE OF A ROW
+		if (inputs.mod_orient == 0) m_B = m_L * m_m;	// Portrait Mode
+		else m_B = m_W * m_m;	// Landscape Mode
+
+		// calculate the length of the row also
+		if (inputs.mod_orient == 0) m_row_length = m_n * m_W; //Portrait Mode
+		else m_row_length = m_n * m_L; //Landscape Mode
+	}
+};
 
-	double a = 0.0, b = m_B;
+// mask angle (degrees), which depends only on the layout and the tilt
+static double ss_mask_angle(const ssinputs &inputs, const ss_dimensions &dim, double tilt)
+{
+	double a = 0.0, b = dim.m_B;
 	
 	double mask_angle;
 	if (inputs.mask_angle_calc_method == 1)
 	{
 	// average over entire array
-		mask_angle = qromb( mask_angle_func, a, b, m_R, m_B, tilt) / m_B;
+		mask_angle = qromb( mask_angle_func, a, b, dim.m_R, dim.m_B, tilt) / dim.m_B;
 	}
 	else
 	{
 	// worst case (default)
 	// updated to phi(0) per email from Chris Deline 5/2/12
-		mask_angle = atan2( ( m_B * sind( tilt ) ), ( m_R - m_B * cosd( tilt ) ) );
+		mask_angle = atan2( ( dim.m_B * sind( tilt ) ), ( dim.m_R - dim.m_B * cosd( tilt ) ) );
 	}
-	mask_angle *= 180.0/M_PI; // change to degrees to pass into functions later
-
-	// ***********************************
-	// SHADOW DIMENSION CALCULATIONS
-	// ***********************************
-	// Reference Appelbaum and Bany "Shadow effect of adjacent solar collectors in large scale systems" Solar Energy 1979 Vol 23. No. 6
+	return mask_angle * 180.0/M_PI; // change to degrees to pass into functions later
+}
 
+// shadow dimensions g and Hs before the limits are applied
+// Reference Appelbaum and Bany "Shadow effect of adjacent solar collectors in large scale systems" Solar Energy 1979 Vol 23. No. 6
+static void ss_shadow(const ss_dimensions &dim, double tilt, double az_eff, double solzen, double &g, double &Hs)
+{
 	double m_A; //NOTE THAT THIS IS APPLEBAUM A, WHICH IS THE ROW SIDE WIDTH, NOT DELINE A, WHICH IS THE ROW LENGTH
 	// APPLEBAUM A IS EQUAL TO DELINE B
-	m_A = m_B;
+	m_A = dim.m_B;
 
 	double px, py;
-	double S,X;
-
-	// AppelBaum Appendix A
-	double g, Hs;
-
-	/* two assumptions in Applebaum paper:
-		1. Azimuth = 0 is facing toward sun (south in northern hemisphere)
-		2. Array azimuth is 0 degrees
-	   to reconcile these assumptions, use an effective azimuth (az_eff) that is the difference between array az and solar az
-	*/
-	double az_eff = solazi - azimuth;
 
 	// if no effective tilt, or sun is down, then no array self-shading
 	if ((solzen < 90.0) && (tilt != 0) && (fabs(az_eff) < 90.0) )
@@ -432,7 +381,36 @@ bool ss_exec(
 	if (py == 0)
 		g = 0;
 	else
-		g = m_R * px / py;
+		g = dim.m_R * px / py;
+
+	// Appelbaum equation A13  Hs = EF = A(1 - R/Py)
+	if (py == 0)
+		Hs = 0;
+	else
+		Hs = m_A * (1.0 - dim.m_R / py);
+}
+
+// limits on the shadow dimensions, then the shaded fraction or the diffuse and dc derates
+static bool ss_derate(
+	const ssinputs &inputs,
+	const ss_dimensions &dim,
+	double tilt, double solzen, double Gb_nor, double Gb_poa, double Gd_poa, double albedo,
+	bool trackmode, bool linear, double shade_frac_1x, double mask_angle,
+	double g, double Hs,
+	ssoutputs &outputs)
+{
+	double m_m = dim.m_m;
+	double m_n = dim.m_n;
+	double m_d = dim.m_d;
+	double m_W = dim.m_W;
+	double m_L = dim.m_L;
+	double m_r = dim.m_r;
+	double m_R = dim.m_R;
+	double m_B = dim.m_B;
+	double m_row_length = dim.m_row_length;
+	double m_A = m_B;
+
+	double S,X;
 
 	// Additional constraints from Chris 4/11/12
 	g = fmax(g, 0); //fabs(g);	//g must be positive
@@ -445,12 +423,6 @@ bool ss_exec(
 		g = 0;
 	}
 
-	// Appelbaum equation A13  Hs = EF = A(1 - R/Py)
-	if (py == 0)
-		Hs = 0;
-	else
-		Hs = m_A * (1.0 - m_R / py);
-
 	//overwrite Hs using geometrically calculated shade fraction for one-axis trackers
 	if (trackmode == 1)
 	{
@@ -534,3 +506,177 @@ bool ss_exec(
 
 	return true;
 }
+
+// self-shading calculation function
+/*
+
+Chris Deline 4/9/2012 - updated 4/19/2012 - update 4/23/2012
+see SAM shade geometry_v2.docx
+Updated 1/18/13 to match new published coefficients in Solar Energy "A simplified model of uniform shading in large photovoltaic arrays"
+
+Definitions of X and S in SAM for the four layout conditions  portrait, landscape and vertical / horizontal strings.
+Definitions:
+S: Fraction of submodules that are shaded in a given parallel string
+X: Fraction of parallel strings in the system that are shaded
+m: modules along side of row
+n: modules along bottom of row
+d:  # of diodes per module
+W: module width
+L: module length
+r: number of rows
+Hs: shadow height along inclined plane from Applebaum eqn. A13
+g: shadow distance from row edge from Applebaum eq. A12
+
+B: array length along side (m*L in portrait, m*W in landscape configuration) = Appelbaum paper A
+beta: effective tilt angle
+alpha: solar elevation angle
+R: inter-row spacing
+phi_bar: average masking angle
+
+*/
+bool ss_exec(
+	
+	const ssinputs &inputs,
+
+	double tilt,		// module tilt (constant for fixed tilt, varies for one-axis)
+	double azimuth,		// module azimuth (constant for fixed tilt, varies for one-axis)
+	double solzen,		// solar zenith (deg)
+	double solazi,		// solar azimuth (deg)
+	double Gb_nor,		// beam normal irradiance (W/m2)
+	double Gb_poa,		// POA beam irradiance (W/m2)
+	double Gd_poa,		// POA diffuse, sky+gnd (W/m2)
+	double albedo,		// used to calculate reduced relected irradiance
+	bool trackmode,		// 0 for fixed tilt, 1 for one-axis tracking
+	bool linear,		// 0 for non-linear shading (C. Deline's full algorithm), 1 to stop at linear shading
+	double shade_frac_1x,	// geometric calculation of the fraction of one-axis row that is shaded (0-1), not used if fixed tilt 
+
+	ssoutputs &outputs)
+{
+	ss_dimensions dim(inputs);
+
+	// calculate the mask angle
+	double mask_angle = ss_mask_angle(inputs, dim, tilt);
+
+	// ***********************************
+	// SHADOW DIMENSION CALCULATIONS
+	// ***********************************
+
+	/* two assumptions in Applebaum paper:
+		1. Azimuth = 0 is facing toward sun (south in northern hemisphere)
+		2. Array azimuth is 0 degrees
+	   to reconcile these assumptions, use an effective azimuth (az_eff) that is the difference between array az and solar az
+	*/
+	double az_eff = solazi - azimuth;
+
+	// AppelBaum Appendix A
+	double g, Hs;
+	ss_shadow(dim, tilt, az_eff, solzen, g, Hs);
+
+	return ss_derate(inputs, dim, tilt, solzen, Gb_nor, Gb_poa, Gd_poa, albedo, trackmode, linear, shade_frac_1x, mask_angle, g, Hs, outputs);
+}
+
+#define ZENITH_MAX 85.0
+
+ss_surface::ss_surface()
+	: m_tilt(0), m_azimuth(0), m_mask_angle(0), m_naz(0), m_nzen(0), m_daz(0), m_dzen(0),
+	m_max_error_linear(0), m_max_error_derate(0)
+{
+}
+
+bool ss_surface::setup(const ssinputs &inputs, double tilt, double azimuth, double resolution)
+{
+	m_naz = m_nzen = 0;
+	m_g.clear();
+	m_Hs.clear();
+	m_max_error_linear = m_max_error_derate = 0;
+	if (resolution <= 0 || resolution > 45 || tilt == 0)
+		return false;
+
+	m_inputs = inputs;
+	m_tilt = tilt;
+	m_azimuth = azimuth;
+
+	ss_dimensions dim(m_inputs);
+	m_mask_angle = ss_mask_angle(m_inputs, dim, m_tilt);
+
+	// effective azimuth from -90 to 90 and zenith from 0 to ZENITH_MAX. closer to the horizon the shadow
+	// changes too quickly to interpolate at the sides of the array, and is calculated directly instead
+	m_naz = (size_t)ceil(180.0 / resolution) + 1;
+	m_daz = 180.0 / (m_naz - 1);
+	size_t nsteps = (size_t)ceil(90.0 / resolution);
+	m_dzen = 90.0 / nsteps;
+	m_nzen = (size_t)floor(ZENITH_MAX / m_dzen + 1e-9) + 1;
+
+	// the shadow grows without bound towards the horizon at the sides of the array.  the grid values are kept within
+	// one row length and one row side beyond the limits applied in ss_derate, which leaves the interpolation where the
+	// limits take effect unchanged but stops the unbounded values from spreading into neighboring cells
+	m_g.resize(m_naz * m_nzen);
+	m_Hs.resize(m_naz * m_nzen);
+	for (size_t j = 0; j < m_nzen; j++)
+	{
+		for (size_t i = 0; i < m_naz; i++)
+		{
+			size_t k = j*m_naz + i;
+			ss_shadow(dim, m_tilt, -90.0 + i * m_daz, j * m_dzen, m_g[k], m_Hs[k]);
+			m_g[k] = fmin(fmax(m_g[k], -dim.m_row_length), 2 * dim.m_row_length);
+			m_Hs[k] = fmin(fmax(m_Hs[k], -dim.m_B), 2 * dim.m_B);
+		}
+	}
+
+	// compare with the direct calculation at the center of each cell, where the interpolation is least accurate,
+	// with a nominal clear sky irradiance
+	ssoutputs direct, interp;
+	for (size_t j = 0; j + 1 < m_nzen; j++)
+	{
+		for (size_t i = 0; i + 1 < m_naz; i++)
+		{
+			double zen = (j + 0.5) * m_dzen;
+			double azi = m_azimuth - 90.0 + (i + 0.5) * m_daz;
+			double Gb_nor = 900, Gb_poa = 700, Gd_poa = 150, albedo = 0.2;
+
+			ss_exec(m_inputs, m_tilt, m_azimuth, zen, azi, Gb_nor, Gb_poa, Gd_poa, albedo, false, true, 0, direct);
+			exec(zen, azi, Gb_nor, Gb_poa, Gd_poa, albedo, true, interp);
+			m_max_error_linear = fmax(m_max_error_linear, fabs(interp.m_shade_frac_fixed - direct.m_shade_frac_fixed));
+
+			ss_exec(m_inputs, m_tilt, m_azimuth, zen, azi, Gb_nor, Gb_poa, Gd_poa, albedo, false, false, 0, direct);
+			exec(zen, azi, Gb_nor, Gb_poa, Gd_poa, albedo, false, interp);
+			m_max_error_derate = fmax(m_max_error_derate, fabs(interp.m_dc_derate - direct.m_dc_derate));
+		}
+	}
+
+	return true;
+}
+
+bool ss_surface::exec(double solzen, double solazi, double Gb_nor, double Gb_poa, double Gd_poa, double albedo, bool linear, ssoutputs &outputs) const
+{
+	if (m_naz == 0)
+		return false;
+
+	ss_dimensions dim(m_inputs);
+
+	double az_eff = solazi - m_azimuth;
+	double g, Hs;
+	double zmax = (m_nzen - 1) * m_dzen;
+	if (!(solzen < 90.0) || !(fabs(az_eff) < 90.0))
+		g = Hs = 0; // no self-shading
+	else if (solzen > zmax || solzen < 0)
+		ss_shadow(dim, m_tilt, az_eff, solzen, g, Hs);
+	else
+	{
+		double x = (az_eff + 90.0) / m_daz;
+		double y = solzen / m_dzen;
+		size_t i = (size_t)x;
+		size_t j = (size_t)y;
+		if (i > m_naz - 2) i = m_naz - 2;
+		if (j > m_nzen - 2) j = m_nzen - 2;
+		double fx = x - i, fy = y - j;
+
+		size_t k = j * m_naz + i;
+		g = (1 - fy) * ((1 - fx) * m_g[k] + fx * m_g[k + 1])
+			+ fy * ((1 - fx) * m_g[k + m_naz] + fx * m_g[k + m_naz + 1]);
+		Hs = (1 - fy) * ((1 - fx) * m_Hs[k] + fx * m_Hs[k + 1])
+			+ fy * ((1 - fx) * m_Hs[k + m_naz] + fx * m_Hs[k + m_naz + 1]);
+	}
+
+	return ss_derate(m_inputs, dim, m_tilt, solzen, Gb_nor, Gb_poa, Gd_poa, albedo, false, linear, 0, m_mask_angle, g, Hs, outputs);
+}
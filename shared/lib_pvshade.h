@@ -51,6 +51,7 @@
 #define __pvshade_h
 
 #include <string>
+#include <vector>
 
 #include "lib_util.h"
 
@@ -165,4 +166,39 @@ bool ss_exec(
 	
 	ssoutputs &outputs);
 
+// self-shading of a fixed tilt subarray with the shadow dimensions tabulated over effective solar azimuth (solar
+// azimuth less array azimuth) and zenith at setup, for studies that repeat the same layout many times.  the shadow
+// is interpolated bilinearly between grid points and the rest of ss_exec is applied to it unchanged.  the mask angle
+// is calculated once, and the last zenith step before the horizon is calculated directly
+class ss_surface
+{
+public:
+	ss_surface();
+
+	// tabulates the shadow at the given grid resolution (deg) and estimates the interpolation error.
+	// returns false if the resolution is not in (0,45] or the array is flat
+	bool setup(const ssinputs &inputs, double tilt, double azimuth, double resolution);
+	bool is_setup() const { return m_naz > 0; }
+
+	// the surface is only valid for the tilt and azimuth it was set up with
+	bool applies(double tilt, double azimuth) const { return is_setup() && tilt == m_tilt && azimuth == m_azimuth; }
+
+	// largest difference from ss_exec at the cell centers of the shaded fraction (linear) or dc derate (non-linear)
+	double max_error(bool linear) const { return linear ? m_max_error_linear : m_max_error_derate; }
+
+	// same as ss_exec for a fixed tilt array
+	bool exec(double solzen, double solazi, double Gb_nor, double Gb_poa, double Gd_poa, double albedo, bool linear, ssoutputs &outputs) const;
+
+private:
+	ssinputs m_inputs;
+	double m_tilt, m_azimuth;
+	double m_mask_angle;
+
+	size_t m_naz, m_nzen;	// grid points in effective azimuth from -90 and in zenith from 0
+	double m_daz, m_dzen;	// grid spacing (deg)
+	std::vector<double> m_g, m_Hs; // shadow dimensions at the grid points before limits are applied, by zenith then azimuth
+
+	double m_max_error_linear, m_max_error_derate;
+};
+
 #endif
\ No newline at end of file
@@ -371,6 +371,11 @@ bool sandia_module_t::operator() ( pvinput_t &in, double TcellC, double opvoltag
 	return true;
 }
 
+bool sandia_module_t::calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] )
+{
+	return pvmodule_calc_array( *this, n, input, TcellC, opvoltage, output );
+}
+
 
 sandia_inverter_t::sandia_inverter_t( )
 {
@@ -394,10 +399,7 @@ bool sandia_inverter_t::acpower(
 )
 {
 	//pass through inputs to the multiple MPPT function as an array with only one entry
-	std::vector<double> Pdc_vec, Vdc_vec;
-	Pdc_vec.push_back(Pdc);
-	Vdc_vec.push_back(Vdc);
-	if (!acpower(Pdc_vec, Vdc_vec, Pac, Ppar, Plr, Eff, Pcliploss, Psoloss, Pntloss))
+	if (!acpower(1, &Pdc, &Vdc, Pac, Ppar, Plr, Eff, Pcliploss, Psoloss, Pntloss))
 		return false;
 
 	return true;
@@ -408,6 +410,25 @@ bool sandia_inverter_t::acpower(
 	std::vector<double> Pdc,     /* Input power to inverter (Wdc) */
 	std::vector<double> Vdc,     /* Vector of Input power to inverter (Wdc), one per MPPT input on the inverter. Note that with several inverters, this is the power to ONE inverter.*/
 
+	/* outputs */
+	double *Pac,    /* AC output power (Wac) */
+	double *Ppar,   /* AC parasitic power consumption (Wac) */
+	double *Plr,    /* Part load ratio (Pdc_in/Pdc_rated, 0..1) */
+	double *Eff,	    /* Conversion efficiency (0..1) */
+	double *Pcliploss, /* Power loss due to clipping loss (Wac) */
+	double *Psoloss, /* Power loss due to operating power consumption (Wdc) */
+	double *Pntloss /* Power loss due to night time tare loss (Wac) */
+	)
+{
+	return acpower(Pdc.size(), Pdc.data(), Vdc.data(), Pac, Ppar, Plr, Eff, Pcliploss, Psoloss, Pntloss);
+}
+
+bool sandia_inverter_t::acpower(
+	/* inputs */
+	size_t nMppt,       /* Number of MPPT inputs on the inverter */
+	const double Pdc[], /* Input power to ONE inverter at each MPPT input (Wdc) */
+	const double Vdc[], /* Voltage at each MPPT input (Vdc) */
+
 	/* outputs */
 	double *Pac,    /* AC output power (Wac) */
 	double *Ppar,   /* AC parasitic power consumption (Wac) */
@@ -425,15 +446,12 @@ bool sandia_inverter_t::acpower(
 	*Pntloss = 0.0;
 	*Pcliploss = 0.0;
 	double Pdc_total = 0;
-	std::vector<double> Pac_each;
-	std::vector<double> PacNoPso_each;
+	double Pac_sum = 0;
+	double Psoloss_sum = 0;
 
 	//loop through each MPPT input
-	for (size_t m = 0; m < Pdc.size(); m++) 
+	for (size_t m = 0; m < nMppt; m++) 
 	{
-		Pac_each.push_back(0);
-		PacNoPso_each.push_back(0);
-
 		double A = Pdco * (1.0 + C1 * (Vdc[m] - Vdco));
 		double B = Pso * (1.0 + C2 * (Vdc[m] - Vdco));
 		double C = C0 * (1.0 + C3 * (Vdc[m] - Vdco));
@@ -444,8 +462,10 @@ bool sandia_inverter_t::acpower(
 		if (B < 0.5 * Pso) B = 0.5 * Pso;
 		if (B > 2.0 * Pso) B = 2.0 * Pso;
 
-		Pac_each[m] = ((Paco / (A - B)) - C * (A - B)) * (Pdc[m] - B) + C0 * (Pdc[m] - B) * (Pdc[m] - B); //calculate Pac for this MPPT input and save it
-		PacNoPso_each[m] = ((Paco / A) - C * A) * Pdc[m] + C0 * Pdc[m] * Pdc[m]; //calculate Pac without operating losses (Pso = 0) for each MPPT input to store as Pso losses later
+		double Pac_each = ((Paco / (A - B)) - C * (A - B)) * (Pdc[m] - B) + C0 * (Pdc[m] - B) * (Pdc[m] - B); //calculate Pac for this MPPT input
+		double PacNoPso_each = ((Paco / A) - C * A) * Pdc[m] + C0 * Pdc[m] * Pdc[m]; //calculate Pac without operating losses (Pso = 0) for each MPPT input to store as Pso losses later
+		Psoloss_sum += PacNoPso_each - Pac_each;
+		Pac_sum += Pac_each;
 		Pdc_total += Pdc[m];
 	}
 
@@ -458,11 +478,10 @@ bool sandia_inverter_t::acpower(
 	}
 	// day time: calculate total Pac; power loss is the Pso loss, use values calculated above
 	else
-		for (size_t m = 0; m < Vdc.size(); m++)
-		{
-			*Psoloss += PacNoPso_each[m] - Pac_each[m];
-			*Pac += Pac_each[m];
-		}
+	{
+		*Psoloss = Psoloss_sum;
+		*Pac = Pac_sum;
+	}
 	
 	// clipping loss Wac (note that the Pso=0 may have no clipping)
 	double PacNoClip = *Pac;
@@ -529,3 +548,8 @@ bool sandia_celltemp_t::operator() ( pvinput_t &input, pvmodule_t &, double , do
 	Tcell = sandia_tcell_from_tmodule( tmod, Itotal, fd, DT0 );
 	return true;
 }
+
+bool sandia_celltemp_t::calc_array( size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] )
+{
+	return pvcelltemp_calc_array( *this, n, input, module, opvoltage, Tcell );
+}
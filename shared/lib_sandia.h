@@ -84,6 +84,7 @@ public:
 	virtual double VocRef() { return Voc0; }
 	virtual double IscRef() { return Isc0; }
 	virtual bool operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &output);
+	virtual bool calc_array( size_t n, pvinput_t input[], const double TcellC[], const double opvoltage[], pvoutput_t output[] );
 };
 
 
@@ -93,6 +94,7 @@ class sandia_celltemp_t : public pvcelltemp_t
 public:
 	double a, b, DT0, fd;	
 	virtual bool operator() ( pvinput_t &input, pvmodule_t &module, double opvoltage, double &Tcell );
+	virtual bool calc_array( size_t n, pvinput_t input[], pvmodule_t &module, const double opvoltage[], double Tcell[] );
 		
 	static double sandia_tcell_from_tmodule( double Tm, double poaIrr, double fd, double DT0);
 	static double sandia_module_temperature( double poaIrr, double Ws, double Ta, double fd, double a, double b );
@@ -156,6 +158,23 @@ public:
 		double *Pntloss /* Power loss due to night time tare loss (Wac) */
 	);
 
+	//same as above, with the inputs for each MPPT input in plain arrays so that no memory is allocated
+	bool acpower(
+		/* inputs */
+		size_t nMppt,       /* Number of MPPT inputs on the inverter */
+		const double Pdc[], /* Input power to ONE inverter at each MPPT input (Wdc) */
+		const double Vdc[], /* Voltage at each MPPT input (Vdc) */
+
+		/* outputs */
+		double *Pac,    /* AC output power (Wac) */
+		double *Ppar,   /* AC parasitic power consumption (Wac) */
+		double *Plr,    /* Part load ratio (Pdc_in/Pdc_rated, 0..1) */
+		double *Eff,	    /* Conversion efficiency (0..1) */
+		double *Pcliploss, /* Power loss due to clipping loss (Wac) */
+		double *Psoloss, /* Power loss due to operating power consumption (Wdc) */
+		double *Pntloss /* Power loss due to night time tare loss (Wac) */
+	);
+
 } ;
 
 #endif
@@ -180,41 +180,109 @@ void SharedInverter::calculateACPower(const double powerDC_kW_in, const double D
 
 /* This function takes input inverter DC power (kW) per MPPT input for a SINGLE multi-mppt inverter, DC voltage (V) per input, and ambient temperature (deg C), and calculates output for the total number of inverters in the system */
 void SharedInverter::calculateACPower(const std::vector<double> powerDC_kW_in, const std::vector<double> DCStringVoltage, double T)
+{
+	calculateACPower(powerDC_kW_in.size(), powerDC_kW_in.data(), DCStringVoltage.data(), T);
+}
+
+void SharedInverter::calculateACPower(size_t nMppt, const double powerDC_kW_in[], const double DCStringVoltage[], double T)
 {
 	double P_par, P_lr;
 
 	//need to convert to watts and divide power by m_num_inverters
-	std::vector<double> powerDC_Watts_one_inv;
-	for (size_t i = 0; i < powerDC_kW_in.size(); i++)
-		powerDC_Watts_one_inv.push_back(powerDC_kW_in[i] * util::kilowatt_to_watt/ m_numInverters);
+	m_powerDC_Watts_one_inv.resize(nMppt);
+	for (size_t i = 0; i < nMppt; i++)
+		m_powerDC_Watts_one_inv[i] = powerDC_kW_in[i] * util::kilowatt_to_watt/ m_numInverters;
 
 	// Power quantities go in and come out in units of W
 	double powerAC_Watts = 0;
 	if (m_inverterType == SANDIA_INVERTER || m_inverterType == DATASHEET_INVERTER || m_inverterType == COEFFICIENT_GENERATOR)
-		m_sandiaInverter->acpower(powerDC_Watts_one_inv, DCStringVoltage, &powerAC_Watts, &P_par, &P_lr, &efficiencyAC, &powerClipLoss_kW, &powerConsumptionLoss_kW, &powerNightLoss_kW);
+		m_sandiaInverter->acpower(nMppt, m_powerDC_Watts_one_inv.data(), DCStringVoltage, &powerAC_Watts, &P_par, &P_lr, &efficiencyAC, &powerClipLoss_kW, &powerConsumptionLoss_kW, &powerNightLoss_kW);
 	else if (m_inverterType == PARTLOAD_INVERTER)
-		m_partloadInverter->acpower(powerDC_Watts_one_inv, &powerAC_Watts, &P_lr, &P_par, &efficiencyAC, &powerClipLoss_kW, &powerNightLoss_kW);
+		m_partloadInverter->acpower(nMppt, m_powerDC_Watts_one_inv.data(), &powerAC_Watts, &P_lr, &P_par, &efficiencyAC, &powerClipLoss_kW, &powerNightLoss_kW);
 
 	double tempLoss = 0.0;
 	if (m_tempEnabled){
 		//use average of the DC voltages to pick which temp curve to use- a weighted average might be better but we don't have that information here
 		double avgDCVoltage = 0;
-		for (size_t i = 0; i < DCStringVoltage.size(); i++)
+		for (size_t i = 0; i < nMppt; i++)
 			avgDCVoltage += DCStringVoltage[i];
-		avgDCVoltage /= DCStringVoltage.size();
+		avgDCVoltage /= nMppt;
 		calculateTempDerate(avgDCVoltage, T, powerAC_Watts, efficiencyAC, tempLoss);
 	}
 
 	// Scale to total system size
-	// Do not need to scale back up by m_numInverters because scaling them down was a separate vector, powerDC_Watts_one_inv
+	// Do not need to scale back up by m_numInverters because scaling them down was a separate vector, m_powerDC_Watts_one_inv
 	powerDC_kW = 0;
-	for (size_t i = 0; i < powerDC_kW_in.size(); i++)
+	for (size_t i = 0; i < nMppt; i++)
 		powerDC_kW += powerDC_kW_in[i];
 
 	//Convert units to kW and scale to total array for all other outputs
 	convertOutputsToKWandScale(tempLoss, powerAC_Watts);
 }
 
+void SharedInverterSeries::resize(size_t n)
+{
+	powerDC_kW.resize(n);
+	powerAC_kW.resize(n);
+	efficiencyAC.resize(n);
+	powerClipLoss_kW.resize(n);
+	powerConsumptionLoss_kW.resize(n);
+	powerNightLoss_kW.resize(n);
+	powerTempLoss_kW.resize(n);
+	powerLossTotal_kW.resize(n);
+	dcWiringLoss_ond_kW.resize(n);
+	acWiringLoss_ond_kW.resize(n);
+}
+
+/* Runs the inverter over a series of timesteps, for when the DC power is known ahead of time (no DC-connected battery) */
+void SharedInverter::calculateACPower(size_t n, const std::vector<const double*> &powerDC_kW_in, const std::vector<const double*> &DCStringVoltage, const double T[], SharedInverterSeries &series)
+{
+	size_t nMppt = std::min(powerDC_kW_in.size(), DCStringVoltage.size());
+	series.resize(n);
+	if (nMppt == 0) return;
+
+	std::vector<double> P(nMppt), V(nMppt);
+	for (size_t i = 0; i < n; i++)
+	{
+		if (m_inverterType == OND_INVERTER)
+			calculateACPower(powerDC_kW_in[0][i], DCStringVoltage[0][i], T[i]);
+		else
+		{
+			for (size_t m = 0; m < nMppt; m++)
+			{
+				P[m] = powerDC_kW_in[m][i];
+				V[m] = DCStringVoltage[m][i];
+			}
+			calculateACPower(nMppt, P.data(), V.data(), T[i]);
+		}
+
+		series.powerDC_kW[i] = powerDC_kW;
+		series.powerAC_kW[i] = powerAC_kW;
+		series.efficiencyAC[i] = efficiencyAC;
+		series.powerClipLoss_kW[i] = powerClipLoss_kW;
+		series.powerConsumptionLoss_kW[i] = powerConsumptionLoss_kW;
+		series.powerNightLoss_kW[i] = powerNightLoss_kW;
+		series.powerTempLoss_kW[i] = powerTempLoss_kW;
+		series.powerLossTotal_kW[i] = powerLossTotal_kW;
+		series.dcWiringLoss_ond_kW[i] = dcWiringLoss_ond_kW;
+		series.acWiringLoss_ond_kW[i] = acWiringLoss_ond_kW;
+	}
+}
+
+void SharedInverter::setTimestep(const SharedInverterSeries &series, size_t i)
+{
+	powerDC_kW = series.powerDC_kW[i];
+	powerAC_kW = series.powerAC_kW[i];
+	efficiencyAC = series.efficiencyAC[i];
+	powerClipLoss_kW = series.powerClipLoss_kW[i];
+	powerConsumptionLoss_kW = series.powerConsumptionLoss_kW[i];
+	powerNightLoss_kW = series.powerNightLoss_kW[i];
+	powerTempLoss_kW = series.powerTempLoss_kW[i];
+	powerLossTotal_kW = series.powerLossTotal_kW[i];
+	dcWiringLoss_ond_kW = series.dcWiringLoss_ond_kW[i];
+	acWiringLoss_ond_kW = series.acWiringLoss_ond_kW[i];
+}
+
 double SharedInverter::getInverterDCNominalVoltage()
 {
 	if (m_inverterType == SANDIA_INVERTER || m_inverterType == DATASHEET_INVERTER || m_inverterType == COEFFICIENT_GENERATOR)
@@ -6,6 +6,29 @@
 #include "lib_ondinv.h"
 #include <vector>
 
+/**
+*
+* \struct SharedInverterSeries
+*
+*  The calculated values of a SharedInverter for a series of timesteps, one entry per timestep
+*/
+struct SharedInverterSeries
+{
+	std::vector<double> powerDC_kW;
+	std::vector<double> powerAC_kW;
+	std::vector<double> efficiencyAC;
+	std::vector<double> powerClipLoss_kW;
+	std::vector<double> powerConsumptionLoss_kW;
+	std::vector<double> powerNightLoss_kW;
+	std::vector<double> powerTempLoss_kW;
+	std::vector<double> powerLossTotal_kW;
+	std::vector<double> dcWiringLoss_ond_kW;
+	std::vector<double> acWiringLoss_ond_kW;
+
+	void resize(size_t n);
+	size_t size() const { return powerAC_kW.size(); }
+};
+
 /**
 *
 * \class SharedInverter
@@ -35,6 +58,13 @@ public:
 	/// Given the combined PV plus battery DC power (kW), voltage and ambient T, compute the AC power (kW) for a single inverter with multiple MPPT inputs
 	void calculateACPower(const std::vector<double> powerDC_kW, const std::vector<double> DCStringVoltage, double ambientT);
 
+	/// Compute the AC power for n timesteps in one pass, given arrays of n DC powers (kW) and voltages for each MPPT input and the ambient T at each timestep.
+	/// Gives the same results as calling the single input version (OND inverter) or the multiple input version (all others) at each timestep
+	void calculateACPower(size_t n, const std::vector<const double*> &powerDC_kW, const std::vector<const double*> &DCStringVoltage, const double ambientT[], SharedInverterSeries &series);
+
+	/// Set the calculated values for the current timestep to those of timestep i of a series
+	void setTimestep(const SharedInverterSeries &series, size_t i);
+
 	/// Return the nominal DC voltage input
 	double getInverterDCNominalVoltage();
 
@@ -81,6 +111,11 @@ private:
 
 	void convertOutputsToKWandScale(double tempLoss, double powerAC_watts);
 
+	/// The multiple MPPT input calculation, with the power and voltage of each input in plain arrays
+	void calculateACPower(size_t nMppt, const double powerDC_kW[], const double DCStringVoltage[], double ambientT);
+
+	std::vector<double> m_powerDC_Watts_one_inv; ///< scratch space for the DC power (W) to one inverter at each MPPT input
+
 };
 
 
@@ -87,6 +87,7 @@ pvsnowmodel::pvsnowmodel()
 	maxBadValues = 500;
 	coverage = 0;
 	pCvg = 0;
+	skippedSteps = 0;
 
 	good = true;
 	msg = "";
@@ -188,3 +189,59 @@ bool pvsnowmodel::getLoss(float poa, float tilt, float , float tdry, float snowD
 	if (isGood) return true;
 	else return false;
 }
+
+bool pvsnowmodel::isSnowFree(float snowDepth) const
+{
+	// same as the validity check and coverage override #1 in getLoss
+	return snowDepth >= 0 && snowDepth <= 610 && snowDepth < depthThreshold;
+}
+
+bool pvsnowmodel::canSkip(float snowDepth, float tilt, int sunup) const
+{
+	// sliding only removes coverage if the tilt used for it is between 0 and 180 degrees
+	if (sunup == 0) tilt = baseTilt;
+	return isSnowFree(snowDepth) && tilt >= 0 && tilt <= 180;
+}
+
+void pvsnowmodel::skipStep(float snowDepth)
+{
+	coverage = 0;
+	previousDepth = snowDepth;
+	pCvg = coverage;
+	skippedSteps++;
+}
+
+bool pvsnowmodel::getLosses(size_t n, const float poa[], const float tilt[], const float tdry[], const float snowDepth[], const int sunup[], float dt, float loss[], size_t &nDone)
+{
+	// pre-scan for the snow free steps
+	std::vector<bool> snowFree(n);
+	for (size_t i = 0; i < n; i++)
+		snowFree[i] = canSkip(snowDepth[i], tilt[i], sunup[i]);
+
+	size_t i = 0;
+	while (i < n)
+	{
+		// skip a run of snow free steps: only the depth at the end of it is needed for the next snow fall detection
+		if (snowFree[i])
+		{
+			size_t start = i;
+			while (i < n && snowFree[i])
+				loss[i++] = 0;
+			skippedSteps += i - start - 1;
+			skipStep(snowDepth[i - 1]);
+			continue;
+		}
+
+		// then the snowy steps up to the next snow free run
+		for (; i < n && !snowFree[i]; i++)
+		{
+			if (!getLoss(poa[i], tilt[i], 0, tdry[i], snowDepth[i], sunup[i], dt, loss[i]))
+			{
+				nDone = i + 1;
+				return false;
+			}
+		}
+	}
+	nDone = n;
+	return true;
+}
@@ -51,6 +51,7 @@
 #define __lib_snowmodel_h
 
 #include <string>
+#include <vector>
 
 class pvsnowmodel
 {
@@ -62,6 +63,19 @@ public:
 
 	bool getLoss(float poa, float tilt, float wspd, float tdry, float snowDepth, int sunup, float dt, float &returnLoss);
 
+	// A step is snow free if its snow depth is valid and below the detection threshold. The coverage is then zero
+	//  whatever the irradiance and temperature, so the step can be skipped as long as sliding cannot add coverage
+	bool isSnowFree(float snowDepth) const;
+	bool canSkip(float snowDepth, float tilt, int sunup) const;
+
+	// Advances the model over a snow free step without the coverage calculation, same as getLoss with zero loss
+	void skipStep(float snowDepth);
+
+	// Runs the model over n steps, marking the snow free steps first and then skipping each run of them, with the
+	//  steps between the runs passed to getLoss in turn. Stops and returns false where getLoss does, with nDone
+	//  set to the number of steps done including that one
+	bool getLosses(size_t n, const float poa[], const float tilt[], const float tdry[], const float snowDepth[], const int sunup[], float dt, float loss[], size_t &nDone);
+
 	float baseTilt,		// The default tilt for 1-axis tracking systems
 		mSlope,			// This is a value given by fig. 4 in [1]
 		sSlope,			// This is a value given by fig. 7 in [1]
@@ -75,6 +89,8 @@ public:
 		badValues,		// keeps track of the number of detected bad snow depth values
 		maxBadValues;	// The number of maximum bad snow depth values that is acceptable
 
+	size_t skippedSteps;	// The number of snow free steps that were skipped, as a diagnostic
+
 	std::string msg;		// This is a string used to return error messages
 	bool good;				// This an error flag that will be set to false
 							//  if an error has occured
@@ -53,6 +53,7 @@
 #include <cstdlib>
 #include <limits>
 #include <numeric>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -1095,6 +1096,111 @@ double util::bilinear( double rowval, double colval, const matrix_t<double> &mat
 		+  mat.at(ridx,   cidx  ) * (rowval-r1)*(colval-c1) / denom;
 }
 
+util::bilinear_table::bilinear_table()
+{
+	m_rows.increasing = m_rows.uniform = false;
+	m_cols.increasing = m_cols.uniform = false;
+	m_rows.x1 = m_rows.inv_step = m_cols.x1 = m_cols.inv_step = 0;
+}
+
+util::bilinear_table::bilinear_table( const matrix_t<double> &mat )
+{
+	set( mat );
+}
+
+void util::bilinear_table::set( const matrix_t<double> &mat )
+{
+	m_mat.copy( mat );
+
+	std::vector<double> rows( mat.nrows() ), cols( mat.ncols() );
+	for ( size_t r = 0; r < mat.nrows(); r++ )
+		rows[r] = mat.at(r, 0);
+	for ( size_t c = 0; c < mat.ncols(); c++ )
+		cols[c] = mat.at(0, c);
+
+	m_rows.set( rows );
+	m_cols.set( cols );
+}
+
+void util::bilinear_table::axis::set( const std::vector<double> &values )
+{
+	x = values;
+	increasing = uniform = false;
+	x1 = inv_step = 0;
+
+	size_t n = x.size();
+	if ( n < 3 ) return;
+
+	increasing = true;
+	for ( size_t i = 2; i < n; i++ )
+		if ( !(x[i] > x[i-1]) )
+			increasing = false;
+	if ( !increasing ) return;
+
+	// evenly spaced to within rounding; find() corrects any off-by-one from the direct estimate
+	double step = (x[n-1] - x[1]) / (double)(n-2);
+	uniform = true;
+	for ( size_t i = 2; i < n; i++ )
+		if ( fabs( x[i] - (x[1] + (i-1)*step) ) > 1e-6*step )
+			uniform = false;
+
+	x1 = x[1];
+	inv_step = 1.0 / step;
+}
+
+// first index from 2 at which val <= x[i], or the last index if there is none, as in bilinear()
+size_t util::bilinear_table::axis::find( double val ) const
+{
+	size_t n = x.size();
+	size_t i = 2;
+	if ( uniform )
+	{
+		double g = (val - x1) * inv_step + 1.0;
+		if ( g > (double)n ) i = n;
+		else if ( g > 2.0 )
+		{
+			i = (size_t)g;
+			if ( (double)i < g ) i++;
+		}
+		while ( i > 2 && val <= x[i-1] ) i--;
+		while ( i < n && val > x[i] ) i++;
+	}
+	else if ( increasing )
+		i = std::lower_bound( x.begin() + 2, x.end(), val ) - x.begin();
+	else
+	{
+		while ( i < n && val > x[i] )
+			i++;
+	}
+
+	if ( i == n ) i--;
+	return i;
+}
+
+double util::bilinear_table::operator()( double rowval, double colval ) const
+{
+	if (m_mat.nrows() < 3 || m_mat.ncols() < 3)
+		return std::numeric_limits<double>::quiet_NaN();
+
+	size_t ridx = m_rows.find( rowval );
+	size_t cidx = m_cols.find( colval );
+
+	double r1,c1,r2,c2;
+
+	r1 = m_mat.at(ridx-1, 0);
+	r2 = m_mat.at(ridx, 0);
+
+	c1 = m_mat.at(0, cidx-1);
+	c2 = m_mat.at(0, cidx);
+
+	double denom = (r2-r1)*(c2-c1);
+
+	return m_mat.at(ridx-1, cidx-1) * (r2-rowval)*(c2-colval) / denom
+		+  m_mat.at(ridx,   cidx-1) * (rowval-r1)*(c2-colval) / denom
+		+  m_mat.at(ridx-1, cidx  ) * (r2-rowval)*(colval-c1) / denom
+		+  m_mat.at(ridx,   cidx  ) * (rowval-r1)*(colval-c1) / denom;
+}
+
 // this will interpolate or extrapolate as necessary
 // if slope is infinite (x1 = x2), it will just return the first Y value
 double util::interpolate(double x1, double y1, double x2, double y2, double xValueToGetYValueFor)
@@ -54,6 +54,7 @@
 #include <string>
 #include <vector>
 #include <cassert>
+#include <type_traits>
 
 #include <unordered_map>
 using std::unordered_map;
@@ -284,15 +285,74 @@ namespace util
 	template< typename T >
 	class matrix_t
 	{
+	public:
+		// optional allocator hook used for all heap storage of matrix_t<T>. it must be
+		// installed before any matrix_t<T> allocates, and the deallocator must accept
+		// any pointer returned by the allocator.
+		typedef T *(*allocate_func)( size_t count );
+		typedef void (*deallocate_func)( T *p );
+
+		static void set_allocator( allocate_func af, deallocate_func df )
+		{
+			s_allocate = af;
+			s_deallocate = df;
+		}
+
+		static T *allocate( size_t count )
+		{
+			return s_allocate ? (*s_allocate)( count ) : new T[ count ];
+		}
+
+		static void deallocate( T *p )
+		{
+			if ( s_deallocate ) (*s_deallocate)( p );
+			else delete [] p;
+		}
+
+		// scalars and short vectors of plain types are stored inline, without a heap allocation
+		static const size_t small_size = std::is_trivial<T>::value ? 4 : 1;
+
 	protected:
 		T *t_array;
 		size_t n_rows, n_cols;
+		T t_small[ small_size ];
+
+		static allocate_func s_allocate;
+		static deallocate_func s_deallocate;
+
+		void free_array()
+		{
+			if (t_array && t_array != t_small) deallocate( t_array );
+			t_array = NULL;
+		}
+
+		void reset_small()
+		{
+			t_array = t_small;
+			n_rows = n_cols = 1;
+		}
+
+		void take( matrix_t &mv )
+		{
+			if ( mv.t_array == mv.t_small )
+			{
+				t_array = t_small;
+				for (size_t i=0;i<small_size;i++)
+					t_small[i] = mv.t_small[i];
+			}
+			else
+				t_array = mv.t_array;
+
+			n_rows = mv.n_rows;
+			n_cols = mv.n_cols;
+			mv.reset_small();
+		}
+
 	public:
 
 		matrix_t()
 		{
-			t_array = new T[1];
-			n_rows = n_cols = 1;
+			reset_small();
 		}
 
 		matrix_t( const matrix_t &cc )
@@ -301,6 +361,11 @@ namespace util
 			t_array = NULL;
 			copy( cc );
 		}
+
+		matrix_t( matrix_t &&mv ) noexcept
+		{
+			take( mv );
+		}
 		
 		matrix_t(size_t len)
 		{
@@ -343,14 +408,13 @@ namespace util
 
 		virtual ~matrix_t()
 		{
-			if (t_array) delete [] t_array;
+			free_array();
 		}
 		
 		void clear()
 		{
-			if (t_array) delete [] t_array;
-			n_rows = n_cols = 1;
-			t_array = new T[1];
+			free_array();
+			reset_small();
 		}
 		
 		void copy( const matrix_t &rhs )
@@ -390,6 +454,43 @@ namespace util
 
 			return *this;
 		}
+
+		matrix_t &operator=(matrix_t &&rhs) noexcept
+		{
+			if ( this != &rhs )
+			{
+				free_array();
+				take( rhs );
+			}
+
+			return *this;
+		}
+
+		// take ownership of an array obtained from matrix_t<T>::allocate( nr*nc ), no copy is made
+		void adopt( T *pvalues, size_t nr, size_t nc )
+		{
+			if (!pvalues || nr < 1 || nc < 1 || pvalues == t_array) return;
+			free_array();
+			t_array = pvalues;
+			n_rows = nr;
+			n_cols = nc;
+		}
+
+		// give up ownership of the underlying array, which must then be freed by the caller
+		// with matrix_t<T>::deallocate( ). the matrix is left with a single element, as after clear( )
+		T *release()
+		{
+			T *p = t_array;
+			if ( t_array == t_small )
+			{
+				size_t nn = n_rows*n_cols;
+				p = allocate( nn );
+				for (size_t i=0;i<nn;i++)
+					p[i] = t_small[i];
+			}
+			reset_small();
+			return p;
+		}
 		
 		matrix_t &operator=(const T &val)
 		{
@@ -437,8 +538,16 @@ namespace util
 			if (nr < 1 || nc < 1) return;
 			if (nr == n_rows && nc == n_cols) return;
 			
-			if (t_array) delete [] t_array;
-			t_array = new T[ nr * nc ];
+			// same number of cells, so the existing storage can be reshaped
+			if (t_array && nr*nc == n_rows*n_cols)
+			{
+				n_rows = nr;
+				n_cols = nc;
+				return;
+			}
+
+			free_array();
+			t_array = ( nr*nc <= small_size ) ? t_small : allocate( nr*nc );
 			n_rows = nr;
 			n_cols = nc;
 		}
@@ -590,6 +699,12 @@ namespace util
 		}
 	};
 
+	template< typename T >
+	typename matrix_t<T>::allocate_func matrix_t<T>::s_allocate = NULL;
+
+	template< typename T >
+	typename matrix_t<T>::deallocate_func matrix_t<T>::s_deallocate = NULL;
+
 	template< typename T >
 	class block_t
 	{
@@ -817,6 +932,36 @@ namespace util
 	};
 
 	double bilinear( double rowval, double colval, const matrix_t<double> &mat );
+
+	/* bilinear interpolation over a table laid out as for bilinear() above, with the row axis in column zero and
+	the column axis in row zero.  the axes are examined once when the table is set so that the interpolation cell
+	is found directly on evenly spaced axes and by bisection on other increasing axes, falling back to the same
+	linear search as bilinear() otherwise.  the results are identical to bilinear() on the same matrix */
+	class bilinear_table
+	{
+	public:
+		bilinear_table();
+		explicit bilinear_table( const matrix_t<double> &mat );
+
+		void set( const matrix_t<double> &mat );
+		double operator()( double rowval, double colval ) const;
+
+	private:
+		struct axis
+		{
+			std::vector<double> x; // x[0] is the corner of the table and is not used
+			bool increasing;
+			bool uniform;
+			double x1, inv_step;
+
+			void set( const std::vector<double> &values );
+			size_t find( double val ) const;
+		};
+
+		matrix_t<double> m_mat;
+		axis m_rows, m_cols;
+	};
+
 	double interpolate(double x1, double y1, double x2, double y2, double xValueToGetYValueFor);
 	double linterp_col( const matrix_t<double> &mat, size_t ixcol, double xval, size_t iycol );
 	bool translate_schedule(int tod[8760], const matrix_t<float> &wkday, const matrix_t<float> &wkend, int min_val, int max_val);
@@ -58,6 +58,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <list>
+#include <memory>
+#include <mutex>
 
 #if defined(__WINDOWS__)||defined(WIN32)||defined(_WIN32)
 #define CASECMP(a,b) _stricmp(a,b)
@@ -90,14 +93,31 @@ static std::string trimboth(std::string &buf)
 	return buf.substr(strBegin, strRange);
 }
 
+// splits into a caller-owned vector so that the token strings keep their storage between data lines
+static std::vector<std::string> &split(const std::string &buf, std::vector<std::string> &tokens, char delim = ',')
+{
+	size_t n = 0;
+	const char *p = buf.c_str();
+	const char *end = p + buf.length();
+	while (p < end)
+	{
+		const char *q = (const char*)memchr(p, delim, end - p);
+		if (!q) q = end;
+		if (n < tokens.size())
+			tokens[n].assign(p, q);
+		else
+			tokens.push_back(std::string(p, q));
+		n++;
+		p = q + 1;
+	}
+	tokens.resize(n);
+	return tokens;
+}
+
 static std::vector<std::string> split(const std::string &buf, char delim = ',')
 {
-	std::string token;
 	std::vector<std::string> tokens;
-	std::istringstream tokenStream(buf);
-	while (std::getline(tokenStream, token, delim))
-		tokens.push_back(token);
-	return tokens;
+	return split(buf, tokens, delim);
 }
 
 /*
@@ -113,6 +133,16 @@ static float col_or_zero(const std::string &s)
 }
 */
 
+// same as stof, but converts in place rather than through a temporary string
+static float field_to_float(const char *p)
+{
+	char *end = 0;
+	float f = strtof(p, &end);
+	if (end == p)
+		throw std::invalid_argument("field_to_float");
+	return f;
+}
+
 static float col_or_nan(const std::string &s)
 {
 	if (!s.empty() &&
@@ -120,15 +150,14 @@ static float col_or_nan(const std::string &s)
 	{
 		if (::isdigit(s[0]))
 		{
-			return (float)stof(s);
+			return field_to_float(s.c_str());
 		}
 		else
 		{
-			std::string x = s.substr(1, s.length() - 1);
 			if (s[0] == '-')
-				return (float)(0.0-stof(x));
+				return (float)(0.0-field_to_float(s.c_str() + 1));
 			else
-				return (float)stof(x);
+				return field_to_float(s.c_str() + 1);
 		}
 	}
 	else
@@ -576,7 +605,120 @@ bool weatherfile::timeStepChecks(int hdr_step_sec) {
 	return true;
 }
 
+// parsed weather files are kept in a small process-wide cache keyed by a hash of the file contents,
+// so that sweeps running many simulations against the same files only parse each file once
+struct weatherfile_cache_entry
+{
+	unsigned long long hash;
+	size_t length;
+	std::string ext; // the format is detected from the extension, so it is part of the key
+	std::shared_ptr<const weatherfile> data;
+};
+
+static std::mutex wf_cache_mutex;
+static std::list<weatherfile_cache_entry> wf_cache; // most recently used first
+static size_t wf_cache_max = 16;
+
+static bool hash_file_contents(const std::string &file, unsigned long long *hash, size_t *length)
+{
+	std::ifstream ifs(file, std::ios::in | std::ios::binary);
+	if (!ifs.is_open()) return false;
+
+	// 64-bit FNV-1a
+	unsigned long long h = 14695981039346656037ULL;
+	size_t len = 0;
+	char buf[65536];
+	while (ifs.read(buf, sizeof(buf)) || ifs.gcount() > 0)
+	{
+		size_t n = (size_t)ifs.gcount();
+		for (size_t i = 0; i < n; i++)
+		{
+			h ^= (unsigned char)buf[i];
+			h *= 1099511628211ULL;
+		}
+		len += n;
+	}
+
+	*hash = h;
+	*length = len;
+	return true;
+}
+
+void weatherfile::set_cache_size(size_t max_files)
+{
+	std::lock_guard<std::mutex> lock(wf_cache_mutex);
+	wf_cache_max = max_files;
+	while (wf_cache.size() > wf_cache_max)
+		wf_cache.pop_back();
+}
+
+void weatherfile::clear_cache()
+{
+	std::lock_guard<std::mutex> lock(wf_cache_mutex);
+	wf_cache.clear();
+}
+
 bool weatherfile::open(const std::string &file, bool header_only)
+{
+	unsigned long long hash = 0;
+	size_t length = 0;
+	std::string ext = util::lower_case(util::ext_only(file));
+	bool use_cache = false;
+	{
+		std::lock_guard<std::mutex> lock(wf_cache_mutex);
+		use_cache = wf_cache_max > 0;
+	}
+
+	if (use_cache && !file.empty() && hash_file_contents(file, &hash, &length))
+	{
+		std::shared_ptr<const weatherfile> cached;
+		{
+			std::lock_guard<std::mutex> lock(wf_cache_mutex);
+			for (std::list<weatherfile_cache_entry>::iterator it = wf_cache.begin(); it != wf_cache.end(); ++it)
+			{
+				if (it->hash == hash && it->length == length && it->ext == ext)
+				{
+					cached = it->data;
+					wf_cache.splice(wf_cache.begin(), wf_cache, it);
+					break;
+				}
+			}
+		}
+
+		if (cached)
+		{
+			bool ok = m_ok; // open() itself does not change the status
+			*this = *cached;
+			m_ok = ok;
+			m_file = file;
+			m_index = 0;
+			return true;
+		}
+	}
+	else
+		use_cache = false;
+
+	if (!parse_file(file, header_only))
+		return false;
+
+	if (use_cache && !header_only)
+	{
+		weatherfile_cache_entry entry;
+		entry.hash = hash;
+		entry.length = length;
+		entry.ext = ext;
+		entry.data = std::make_shared<const weatherfile>(*this);
+
+		std::lock_guard<std::mutex> lock(wf_cache_mutex);
+		wf_cache.push_front(entry);
+		while (wf_cache.size() > wf_cache_max)
+			wf_cache.pop_back();
+	}
+
+	return true;
+}
+
+bool weatherfile::parse_file(const std::string &file, bool header_only)
 {
 	if (file.empty())
 	{
@@ -1073,6 +1215,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	// from 1-24 standard to 0-23
 	int tmy3_hour_shift = 1;
 	int n_leap_data_removed = 0;
+	std::vector<std::string> fields;
 
 	for (int i = 0; i < (int)m_nRecords; i++)
 	{
@@ -1169,7 +1312,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			for (;;)
 			{
 				getline(ifs, buf);
-				auto cols = split(buf);
+				std::vector<std::string> &cols = split(buf, fields);
 				//				if (cols.size() < 68)
 				//				{
 				//					m_message = "TMY3: data line does not have at least 68 fields at record " + util::to_string(i);
@@ -1253,7 +1396,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			for (;;)
 			{
 				getline(ifs, buf);
-				auto cols = split(buf);
+				std::vector<std::string> &cols = split(buf, fields);
 
 				if (cols.size() < 32)
 				{
@@ -1308,7 +1451,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		else if (m_type == SMW)
 		{
 			getline(ifs, buf);
-			auto cols = split(buf);
+			std::vector<std::string> &cols = split(buf, fields);
 
 			if (cols.size() < 12)
 			{
@@ -1363,7 +1506,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 					return false;
 				}
 
-				auto cols = split(buf);
+				std::vector<std::string> &cols = split(buf, fields);
 				int ncols = (int)cols.size();
 				for (size_t k = 0; k < _MAXCOL_; k++)
 				{
@@ -239,6 +239,8 @@ private:
 	};
 	column m_columns[_MAXCOL_];
 
+	bool parse_file( const std::string &file, bool header_only );
+
 public:
 	weatherfile();
 	/* Detects file format, read header information, detects which data columns are available and at what index
@@ -265,6 +267,10 @@ public:
 	
 	static std::string normalize_city( const std::string &in );
 	static bool convert_to_wfcsv( const std::string &input, const std::string &output );
+
+	/// Parsed files are cached in memory by content, set the number of files kept (0 disables caching)
+	static void set_cache_size( size_t max_files );
+	static void clear_cache();
 	
 };
 
@@ -54,6 +54,7 @@
 #include "core.h"
 #include "lib_battery.h"
 #include "lib_battery_dispatch.h"
+#include "lib_battery_dispatch_lp.h"
 #include "lib_battery_powerflow.h"
 #include "lib_power_electronics.h"
 #include "lib_shared_inverter.h"
@@ -177,6 +178,7 @@ var_info vtab_battery_inputs[] = {
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_auto_gridcharge_max_daily",              "Allowed grid charging percent per day for automated dispatch","kW",  "",                     "Battery",       "",                           "",                             "" },
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_look_ahead_hours",                       "Hours to look ahead in automated dispatch",              "hours",    "",                     "Battery",       "",                           "",                             "" },
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_dispatch_update_frequency_hours",        "Frequency to update the look-ahead dispatch",            "hours",    "",                     "Battery",       "",                           "",                             "" },
+	{ SSC_INPUT,        SSC_NUMBER,     "batt_dispatch_lp",                            "Optimize automated dispatch with a rolling-horizon linear program", "0/1", "0=Heuristic,1=LinearProgram", "Battery", "?=0",                  "BOOLEAN",                      "" },
 
 	//  cycle cost inputs
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_cycle_cost_choice",                      "Use SAM model for cycle costs or input custom",           "0/1",     "0=UseCostModel,1=InputCost", "Battery", "",                           "",                             "" },
@@ -264,6 +266,10 @@ var_info vtab_battery_outputs[] = {
 	{ SSC_OUTPUT,        SSC_NUMBER,     "average_battery_roundtrip_efficiency",       "Battery average roundtrip efficiency",                  "%",        "",                      "Annual",        "",                           "",                               "" },
 	{ SSC_OUTPUT,        SSC_NUMBER,     "batt_pv_charge_percent",                     "Battery percent energy charged from PV",                "%",        "",                      "Annual",        "",                           "",                               "" },
 	{ SSC_OUTPUT,        SSC_NUMBER,     "batt_bank_installed_capacity",               "Battery bank installed capacity",                       "kWh",      "",                      "Annual",        "",                           "",                               "" },
+	{ SSC_OUTPUT,        SSC_NUMBER,     "batt_dispatch_lp_solves",                    "Dispatch linear program solves",                        "",         "",                      "Battery",       "",                           "",                               "" },
+	{ SSC_OUTPUT,        SSC_NUMBER,     "batt_dispatch_lp_failures",                  "Dispatch linear program solves without a solution",     "",         "",                      "Battery",       "",                           "",                               "" },
+	{ SSC_OUTPUT,        SSC_NUMBER,     "batt_dispatch_lp_iterations",                "Dispatch linear program simplex iterations",            "",         "",                      "Battery",       "",                           "",                               "" },
+	{ SSC_OUTPUT,        SSC_NUMBER,     "batt_dispatch_lp_solve_time",                "Dispatch linear program solve time",                    "s",        "",                      "Battery",       "",                           "",                               "" },
 
 	// test matrix output
 	{ SSC_OUTPUT,        SSC_MATRIX,     "batt_dispatch_sched",                        "Battery dispatch schedule",                              "",        "",                     "Battery",       "",                           "",                               "ROW_LABEL=MONTHS,COL_LABEL=HOURS_OF_DAY"  },
@@ -497,6 +503,10 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 			if (cm.is_assigned("batt_dispatch_auto_can_fuelcellcharge")) {
 				batt_vars->batt_dispatch_auto_can_fuelcellcharge = cm.as_boolean("batt_dispatch_auto_can_fuelcellcharge");
 			}
+			batt_vars->batt_dispatch_lp = false;
+			if (cm.is_assigned("batt_dispatch_lp")) {
+				batt_vars->batt_dispatch_lp = cm.as_boolean("batt_dispatch_lp");
+			}
 
 			// Battery bank replacement
 			batt_vars->batt_cost_per_kwh = cm.as_vector_double("om_replacement_cost1")[0];
@@ -916,6 +926,10 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 		}
 	}
 
+	if (dispatch_automatic_t * dispatch_auto = dynamic_cast<dispatch_automatic_t*>(dispatch_model)) {
+		dispatch_auto->set_lp_dispatch(batt_vars->batt_dispatch_lp);
+	}
+
 	if (batt_vars->batt_topology == ChargeController::AC_CONNECTED) {
 		charge_control = new ACBatteryController(dispatch_model, battery_metrics, batt_vars->batt_ac_dc_efficiency, batt_vars->batt_dc_ac_efficiency);
 	}
@@ -1296,6 +1310,16 @@ void battstor::calculate_monthly_and_annual_outputs( compute_module &cm )
 	cm.assign("batt_pv_charge_percent", var_data((ssc_number_t)outPVChargePercent));
 	cm.assign("batt_bank_installed_capacity", (ssc_number_t)batt_vars->batt_kwh);
 
+	// linear program dispatch metrics
+	if (dispatch_automatic_t * dispatch_auto = dynamic_cast<dispatch_automatic_t*>(dispatch_model)) {
+		if (const dispatch_lp_t * lp = dispatch_auto->lp_dispatch()) {
+			cm.assign("batt_dispatch_lp_solves", var_data((ssc_number_t)lp->solve_count()));
+			cm.assign("batt_dispatch_lp_failures", var_data((ssc_number_t)lp->failure_count()));
+			cm.assign("batt_dispatch_lp_iterations", var_data((ssc_number_t)lp->iterations()));
+			cm.assign("batt_dispatch_lp_solve_time", var_data((ssc_number_t)lp->solve_time()));
+		}
+	}
+
 	// monthly outputs
 	cm.accumulate_monthly_for_year("pv_to_batt", "monthly_pv_to_batt", _dt_hour, step_per_hour);
 	cm.accumulate_monthly_for_year("grid_to_batt", "monthly_grid_to_batt", _dt_hour, step_per_hour);
@@ -1321,6 +1345,9 @@ void battstor::process_messages(compute_module &cm)
 		cm.log(dispatch_messages.construct_log_count_string(i), SSC_NOTICE);
 	for (int i = 0; i != (int)thermal_messages.total_message_count(); i++)
 		cm.log(thermal_messages.construct_log_count_string(i), SSC_NOTICE);
+
+	if (size_t skipped = dispatch_model->idle_steps_skipped())
+		cm.log(util::format("The battery model advanced %d idle timesteps together with an earlier step.", (int)skipped), SSC_NOTICE);
 }
 
 ///////////////////////////////////////////////////
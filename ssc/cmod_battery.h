@@ -140,6 +140,9 @@ struct batt_variables
 	/*! The frequency to update the look-ahead automated dispatch */
 	double batt_dispatch_update_frequency_hours;
 
+	/*! Determines if the automated dispatch is optimized with a rolling-horizon linear program */
+	bool batt_dispatch_lp;
+
 	util::matrix_t<double>  batt_lifetime_matrix;
 	util::matrix_t<double> batt_calendar_lifetime_matrix;
 	util::matrix_t<double> batt_voltage_matrix;
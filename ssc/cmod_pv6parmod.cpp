@@ -53,6 +53,8 @@
 #define M_PI 3.141592653589793238462643
 #endif
 
+#include <vector>
+
 #include "core.h"
 
 #include "lib_cec6par.h"
@@ -174,35 +176,54 @@ public:
 		ssc_number_t *p_eff = allocate("eff", arr_len);
 		ssc_number_t *p_dc = allocate("dc", arr_len);
 
+		std::vector<pvinput_t> in( arr_len );
+		std::vector<double> opv( arr_len, -1 ); // by default, calculate MPPT
+		std::vector<double> tcell( arr_len );
+		std::vector<pvoutput_t> out( arr_len );
 		for (size_t i = 0; i < arr_len; i++ )
 		{
-			pvinput_t in;
-			in.Ibeam = (double) p_poabeam[i];
-			in.Idiff = (double) p_poaskydiff[i];
-			in.Ignd = (double) p_poagnddiff[i];
-			in.Tdry = (double) p_tdry[i];
-			in.Wspd = (double) p_wspd[i];
-			in.Wdir = (double) p_wdir[i];
-			in.Zenith = (double) p_zen[i];
-			in.IncAng = (double) p_inc[i];
-			in.Elev = site_elevation;
-			in.Tilt = (double) p_stilt[i];
-
-			pvoutput_t out;
-
-			double opv = -1; // by default, calculate MPPT
+			in[i].Ibeam = (double) p_poabeam[i];
+			in[i].Idiff = (double) p_poaskydiff[i];
+			in[i].Ignd = (double) p_poagnddiff[i];
+			in[i].Tdry = (double) p_tdry[i];
+			in[i].Wspd = (double) p_wspd[i];
+			in[i].Wdir = (double) p_wdir[i];
+			in[i].Zenith = (double) p_zen[i];
+			in[i].IncAng = (double) p_inc[i];
+			in[i].Elev = site_elevation;
+			in[i].Tilt = (double) p_stilt[i];
+
 			if ( opvoltage != 0 )
-				opv = opvoltage[i];
+				opv[i] = opvoltage[i];
 
-			double tcell = in.Tdry;
-			if (! tc( in, mod, opv, tcell ) ) throw general_error("error calculating cell temperature", (float)i);
-			if (! mod( in, tcell, opv, out ) ) throw general_error( "error calculating module power and temperature with given parameters", (float) i);
+			tcell[i] = in[i].Tdry;
+		}
+
+		// all timesteps are calculated together, and only if that fails are they repeated one by one to find the bad input.
+		// the failed batch may have left the cell temperatures partly updated, so each one starts again from the ambient
+		if ( arr_len > 0 && !tc.calc_array( arr_len, &in[0], mod, &opv[0], &tcell[0] ) )
+		{
+			for (size_t i = 0; i < arr_len; i++ )
+			{
+				tcell[i] = in[i].Tdry;
+				if (! tc( in[i], mod, opv[i], tcell[i] ) ) throw general_error("error calculating cell temperature", (float)i);
+			}
+			throw general_error("error calculating cell temperature");
+		}
+		if ( arr_len > 0 && !mod.calc_array( arr_len, &in[0], &tcell[0], &opv[0], &out[0] ) )
+		{
+			for (size_t i = 0; i < arr_len; i++ )
+				if (! mod( in[i], tcell[i], opv[i], out[i] ) ) throw general_error( "error calculating module power and temperature with given parameters", (float) i);
+			throw general_error( "error calculating module power and temperature with given parameters" );
+		}
 
-			p_tcell[i] = (ssc_number_t)out.CellTemp;
-			p_volt[i] = (ssc_number_t)out.Voltage;
-			p_amp[i] = (ssc_number_t)out.Current;
-			p_eff[i] = (ssc_number_t)out.Efficiency;
-			p_dc[i] = (ssc_number_t)out.Power;
+		for (size_t i = 0; i < arr_len; i++ )
+		{
+			p_tcell[i] = (ssc_number_t)out[i].CellTemp;
+			p_volt[i] = (ssc_number_t)out[i].Voltage;
+			p_amp[i] = (ssc_number_t)out[i].Current;
+			p_eff[i] = (ssc_number_t)out[i].Efficiency;
+			p_dc[i] = (ssc_number_t)out[i].Power;
 		}
 	}
 };
@@ -164,7 +164,8 @@ public:
 		if (num_strings > 0)
 		{
 			ShadeDB8_mpp db8;
-			db8.init();
+			if (!db8.init())
+				throw exec_error("pv_get_shade_loss_mpp", "failed to load the shading database: " + db8.get_error());
 
 			for (size_t irec = 0; irec < nrec; irec++)
 			{
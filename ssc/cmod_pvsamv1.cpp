@@ -47,6 +47,10 @@
 *  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************************************/
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "cmod_pvsamv1.h"
 #include "lib_pv_io_manager.h"
 
@@ -74,6 +78,10 @@ static var_info _cm_vtab_pvsamv1[] = {
 	{ SSC_INPUT,        SSC_NUMBER,      "en_ac_lifetime_losses",                       "Enable lifetime daily AC losses",                      "0/1",      "",                              "pvsamv1",             "?=0",                        "INTEGER,MIN=0,MAX=1",          "" },
 	{ SSC_INPUT,        SSC_ARRAY,       "ac_lifetime_losses",                          "Lifetime daily AC losses",                             "%",        "",                              "pvsamv1",             "en_ac_lifetime_losses=1",    "",                             "" },
 
+	{ SSC_INPUT,        SSC_NUMBER,      "subarray_threads",                            "Threads for the subarray irradiance calculations",     "",         "0=hardware threads, at most one per enabled subarray",    "pvsamv1",             "?=1",                        "INTEGER,MIN=0",                "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "reuse_irradiance",                            "Reuse year one subarray irradiance in later years",    "0/1",      "",                              "pvsamv1",             "?=1",                        "BOOLEAN",                      "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "ss_surface_resolution",                       "Grid resolution for tabulated fixed tilt self-shading", "deg",     "0=calculate at each timestep",  "pvsamv1",             "?=0",                        "MIN=0,MAX=45",                 "" },
+
 	//SEV: Activating the snow model
 	{ SSC_INPUT,        SSC_NUMBER,      "en_snow_model",                               "Toggle snow loss estimation",                          "0/1",      "",                              "snowmodel",            "?=0",                       "BOOLEAN",                      "" },
 	{ SSC_INPUT,        SSC_NUMBER,      "system_capacity",                             "DC Nameplate capacity",                                "kWdc",       "",                            "pvsamv1",              "*",                         "",                             "" },
@@ -218,6 +226,7 @@ static var_info _cm_vtab_pvsamv1[] = {
 	{ SSC_INPUT,        SSC_NUMBER,      "subarray4_backtrack",                         "Sub-array 4 Backtracking enabled",                        "",       "0=no backtracking,1=backtrack", "pvsamv1",              "",                         "BOOLEAN",                       "" },
 
 	{ SSC_INPUT,        SSC_NUMBER,      "module_model",                                "Photovoltaic module model specifier",                     "",       "0=spe,1=cec,2=6par_user,3=snl,4=sd11-iec61853,5=PVYield", "pvsamv1",              "*",                        "INTEGER,MIN=0,MAX=5",           "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "module_single_diode_solver",                  "Single diode equation solution method",                   "",       "0=iterative,1=Lambert W",                                 "pvsamv1",              "?=0",                      "INTEGER,MIN=0,MAX=1",           "" },
 	{ SSC_INPUT,        SSC_NUMBER,      "module_aspect_ratio",                         "Module aspect ratio",                                     "",       "",                              "pvsamv1",              "?=1.7",                    "",                              "POSITIVE" },
 	{ SSC_INPUT,        SSC_NUMBER,      "spe_area",                                    "Module area",                                             "m2",     "",                              "pvsamv1",              "module_model=0",           "",                              "" },
 	{ SSC_INPUT,        SSC_NUMBER,      "spe_rad0",                                    "Irradiance level 0",                                      "W/m2",   "",                              "pvsamv1",              "module_model=0",           "",                              "" },
@@ -280,6 +289,7 @@ static var_info _cm_vtab_pvsamv1[] = {
 	{ SSC_INPUT,        SSC_NUMBER,      "cec_array_rows",                              "Rows of modules in array",                                "",       "",                                                                  "pvsamv1",       "module_model=1&cec_temp_corr_mode=1",      "",                          "" },
 	{ SSC_INPUT,        SSC_NUMBER,      "cec_array_cols",                              "Columns of modules in array",                             "",       "",                                                                  "pvsamv1",       "module_model=1&cec_temp_corr_mode=1",      "",                          "" },
 	{ SSC_INPUT,        SSC_NUMBER,      "cec_backside_temp",                           "Module backside temperature",                             "C",      "",                                                                  "pvsamv1",       "module_model=1&cec_temp_corr_mode=1",      "POSITIVE",                  "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "cec_warm_start",                              "Start the cell temperature solution from the last timestep", "0/1", "",                                                                  "pvsamv1",       "?=0",                                      "BOOLEAN",                   "" },
 
 	{ SSC_INPUT,        SSC_NUMBER,      "6par_celltech",                               "Solar cell technology type",                              "",       "monoSi=0,multiSi=1,CdTe=2,CIS=3,CIGS=4,Amorphous=5",                "pvsamv1",       "module_model=2",                           "INTEGER,MIN=0,MAX=5",       "" },
 	{ SSC_INPUT,        SSC_NUMBER,      "6par_vmp",                                    "Maximum power point voltage",                             "V",      "",                                                                  "pvsamv1",       "module_model=2",                           "",                              "" },
@@ -873,6 +883,7 @@ static var_info _cm_vtab_pvsamv1[] = {
 	//miscellaneous outputs
 	{ SSC_OUTPUT,        SSC_NUMBER,     "ts_shift_hours",                            "Sun position time offset",   "hours",  "",  "Miscellaneous", "*",                       "",                          "" },
 	{ SSC_OUTPUT,        SSC_NUMBER,     "nameplate_dc_rating",                        "System nameplate DC rating", "kW",     "",  "Miscellaneous",       "*",                    "",                              "" },
+	{ SSC_OUTPUT,        SSC_ARRAY,      "ss_surface_max_error",                       "Tabulated self-shading largest factor error by subarray", "frac", "", "Miscellaneous",       "",                     "",                              "" },
 
 
 // test outputs
@@ -950,6 +961,23 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 	std::vector<Subarray_IO *> Subarrays = IOManager->getSubarrays();
 	PVSystem_IO * PVSystem = IOManager->getPVSystemIO();
 	ShadeDB8_mpp * shadeDatabase = IOManager->getShadeDatabase();
+
+	// rear-side geometry factors and scratch storage, kept per subarray across timesteps
+	std::vector<bifacial_geometry> bifacialGeometry(Subarrays.size());
+
+	// load the shared shading database up front, and only if a subarray uses it
+	for (size_t nn = 0; nn < Subarrays.size(); nn++)
+	{
+		if (Subarrays[nn]->shadeCalculator.use_shade_db())
+		{
+			if (!shadeDatabase->init())
+				throw exec_error("pvsamv1", "failed to load the shading database: " + shadeDatabase->get_error());
+			break;
+		}
+	}
+
+	// each subarray gets its own handle on the shared database, so that subarrays can be calculated on separate threads
+	std::vector<ShadeDB8_mpp> shadeDatabases(Subarrays.size(), *shadeDatabase);
 	
 	size_t nrec = Simulation->numberOfWeatherFileRecords;
 	size_t nlifetime = Simulation->numberOfSteps;
@@ -989,6 +1017,24 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		Subarrays[nn]->selfShadingInputs.row_space = b / Subarrays[nn]->groundCoverageRatio;
 	}
 
+	// tabulate the self-shading geometry of fixed tilt subarrays if requested
+	double ss_surface_resolution = as_double("ss_surface_resolution");
+	if (ss_surface_resolution > 0)
+	{
+		ssc_number_t *p_ss_surface_error = allocate("ss_surface_max_error", num_subarrays);
+		for (size_t nn = 0; nn < num_subarrays; nn++)
+		{
+			p_ss_surface_error[nn] = 0;
+			if (Subarrays[nn]->trackMode == 0 && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2)
+				&& Subarrays[nn]->selfShadingSurface.setup(Subarrays[nn]->selfShadingInputs, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, ss_surface_resolution))
+			{
+				double err = Subarrays[nn]->selfShadingSurface.max_error(Subarrays[nn]->shadeMode == 2);
+				p_ss_surface_error[nn] = (ssc_number_t)err;
+				log(util::format("Subarray %d self-shading tabulated at %lg deg, largest factor error %lg", (int)nn + 1, ss_surface_resolution, err), SSC_NOTICE);
+			}
+		}
+	}
+
 	double nameplate_kw = 0;
 	for (size_t nn = 0; nn < num_subarrays; nn++)
 	{
@@ -1070,16 +1116,12 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 	/* *********************************************************************************************
 	PV DC calculation
 	*********************************************************************************************** */
-	std::vector<double> dcPowerNetPerMppt_kW; //Vector of Net DC power in kW for each MPPT input on the system for THIS TIMESTEP ONLY
 	std::vector<double> dcPowerNetPerSubarray; //Net DC power in W for each subarray for THIS TIMESTEP ONLY
-	std::vector<double> dcVoltagePerMppt; //Voltage in V at each MPPT input on the system for THIS TIMESTEP ONLY	
 	std::vector<std::vector<double>> dcStringVoltage; // Voltage of string for each subarray
 	double dcPowerNetTotalSystem = 0; //Net DC power in W for the entire system (sum of all subarrays)
 
 	for (size_t mpptInput = 0; mpptInput < PVSystem->Inverter->nMpptInputs; mpptInput++)
 	{
-		dcPowerNetPerMppt_kW.push_back(0);
-		dcVoltagePerMppt.push_back(0);
 		PVSystem->p_dcPowerNetPerMppt[mpptInput][idx] = 0;		
 	}
 	for (size_t nn = 0; nn < PVSystem->numberOfSubarrays; nn++) {
@@ -1087,6 +1129,450 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		std::vector<double> tmp;
 		dcStringVoltage.push_back(tmp);
 	}
+
+	// The irradiance, shading and soiling calculations for a subarray only depend on the weather and on that subarray,
+	// so they are run ahead of the module and inverter calculations one block of timesteps at a time, with each subarray
+	// on its own thread if requested. The results are used below in timestep and subarray order, so the outputs and
+	// messages do not depend on the number of threads.
+	size_t nEnabledSubarrays = 0;
+	for (size_t nn = 0; nn < num_subarrays; nn++)
+		if (Subarrays[nn]->enable && Subarrays[nn]->nStrings >= 1)
+			nEnabledSubarrays++;
+	size_t nthreads = (size_t)as_integer("subarray_threads");
+	if (nthreads < 1) nthreads = (size_t)std::thread::hardware_concurrency();
+	if (nthreads > nEnabledSubarrays) nthreads = nEnabledSubarrays;
+	if (nthreads < 1) nthreads = 1;
+
+	const size_t blockHours = 168;
+	size_t blockStart = 0;
+	std::vector<weather_record> blockWeather;
+	std::vector<int> blockYear, blockMonth, blockDay, blockHour;
+	std::vector<double> blockMinute;
+	std::vector<int> blockSunPosition[3]; // sun position of each step of the block, shared by the subarrays
+	std::vector<double> blockSunAngles[9];
+	std::vector<std::vector<subarray_irradiance> > blockIrradiance(num_subarrays);
+	std::vector<ssc_number_t> topOfHourBeam(num_subarrays, 0); // beam irradiance at the top of the hour for self-shading
+
+	// the weather file is rewound for each year of a lifetime simulation, so the year one results are kept and the
+	// irradiance calculations are skipped for later years. only the degradation dependent module and inverter
+	// calculations are repeated.
+	bool reuseIrradiance = (nyears > 1) && as_boolean("reuse_irradiance");
+	std::vector<subarray_irradiance_history> irradianceHistory(num_subarrays);
+	if (reuseIrradiance)
+	{
+		for (size_t nn = 0; nn < num_subarrays; nn++)
+			if (Subarrays[nn]->enable && Subarrays[nn]->nStrings >= 1)
+				irradianceHistory[nn].resize(8760 * step_per_hour);
+	}
+
+	auto subarrayIrradiance = [&](size_t nn, size_t iyear, size_t hour, size_t jj, size_t idx, const weather_record &wf,
+		const int sunPosition[3], const double sunAngles[9], subarray_irradiance &r)
+	{
+		//update POA data structure indicies if radmode is POA model is enabled
+		if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+			Subarrays[nn]->poa.poaAll->tDew = wf.tdew;
+			Subarrays[nn]->poa.poaAll->i = idx;
+			if (jj == 0 && wf.hour == 0) {
+				Subarrays[nn]->poa.poaAll->dayStart = idx;
+				Subarrays[nn]->poa.poaAll->doy += 1;
+			}
+		}
+
+		irrad irr(wf, Irradiance->weatherHeader,
+			Irradiance->skyModel, Irradiance->radiationMode, Subarrays[nn]->trackMode,
+			Irradiance->useWeatherFileAlbedo, Irradiance->instantaneous, Subarrays[nn]->backtrackingEnabled,
+			Irradiance->dtHour, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->trackerRotationLimitDegrees, Subarrays[nn]->groundCoverageRatio,
+			Subarrays[nn]->monthlyTiltDegrees, Irradiance->userSpecifiedMonthlyAlbedo,
+			Subarrays[nn]->poa.poaAll.get());
+		irr.set_sun_position(sunPosition, sunAngles);
+								
+		int code = irr.calc();
+
+		if (code < 0) //jmf updated 11/30/18 so that negative numbers are errors, positive numbers are warnings, 0 is everything correct. implemented in patch for POA model only, will be added to develop for other irrad models as well
+			throw exec_error("pvsamv1",
+			util::format("failed to calculate irradiance incident on surface (POA) %d (code: %d) [y:%d m:%d d:%d h:%d]",
+			nn + 1, code, wf.year, wf.month, wf.day, wf.hour));
+
+		if (code == 40)
+			r.log(util::format("SAM calculated negative direct normal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+				wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+		else if (code == 41)
+			r.log(util::format("SAM calculated negative diffuse horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+				wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+		else if (code == 42)
+			r.log(util::format("SAM calculated negative global horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+				wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+						   					 
+		// p_irrad_calc is only weather file records long...
+		if (radmode == irrad::POA_R || radmode == irrad::POA_P) {
+			double gh_temp, df_temp, dn_temp;
+			gh_temp = df_temp = dn_temp = 0;
+			irr.get_irrad(&gh_temp, &dn_temp, &df_temp);
+			if (iyear == 0)
+			{
+				r.setIrradianceCalculated(1, (ssc_number_t)df_temp);
+				r.setIrradianceCalculated(2, (ssc_number_t)dn_temp);
+			}
+			if (jj == 0) topOfHourBeam[nn] = (ssc_number_t)dn_temp;
+		}
+		// beam, skydiff, and grounddiff IN THE PLANE OF ARRAY (W/m2)
+		double ibeam, iskydiff, ignddiff;
+		double aoi, stilt, sazi, rot, btd;
+
+		// Ensure that the usePOAFromWF flag is false unless a reference cell has been used. 
+		//  This will later get forced to false if any shading has been applied (in any scenario)
+		//  also this will also be forced to false if using the cec mcsp thermal model OR if using the spe module model with a diffuse util. factor < 1.0
+		Subarrays[nn]->poa.usePOAFromWF = false;
+		if (radmode == irrad::POA_R){
+			r.ipoa = wf.poa;
+			Subarrays[nn]->poa.usePOAFromWF = true;
+		}
+		else if (radmode == irrad::POA_P){
+			r.ipoa = wf.poa;
+		}
+
+		if (Subarrays[nn]->Module->simpleEfficiencyForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){  // only will be true if using a poa model AND spe module model AND spe_fp is < 1
+			Subarrays[nn]->poa.usePOAFromWF = false;
+			if (idx == 0)
+				r.log("The combination of POA irradiance as in input, single point efficiency module model, and module diffuse utilization factor less than one means that SAM must use a POA decomposition model to calculate the incident diffuse irradiance", SSC_WARNING);
+		}
+
+		if (Subarrays[nn]->Module->mountingSpecificCellTemperatureForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){
+			Subarrays[nn]->poa.usePOAFromWF = false;
+			if (idx == 0)
+				r.log("The combination of POA irradiance as input and heat transfer method for cell temperature means that SAM must use a POA decomposition model to calculate the beam irradiance required by the cell temperature model", SSC_WARNING);
+		}
+
+
+		// Get Incident angles and irradiances
+		double solazi = 0, solzen = 0, solalt = 0, alb = 0;
+		int sunup = 0;
+		irr.get_sun(&solazi, &solzen, &solalt, 0, 0, 0, &sunup, 0, 0, 0);
+		irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
+		irr.get_poa(&ibeam, &iskydiff, &ignddiff, 0, 0, 0);
+		alb = irr.getAlbedo();
+		r.solazi = solazi;
+		r.solzen = solzen;
+		r.solalt = solalt;
+		r.sunup = sunup;
+		r.alb = alb;
+		r.sunPositionHour = irr.get_sunpos_calc_hour();
+
+		// save weather file beam, diffuse, and global for output and for use later in pvsamv1- year 1 only
+		/*jmf 2016: these calculations are currently redundant with calculations in irrad.calc() because ibeam and idiff in that function are DNI and DHI, **NOT** in the plane of array
+		we'll have to fix this redundancy in the pvsamv1 rewrite. it will require allowing irradproc to report the errors below
+		and deciding what to do if the weather file DOES contain the third component but it's not being used in the calculations.*/
+		// calculate beam if global & diffuse are selected as inputs, this is also needed at the top of each hour for self-shading
+		if (radmode == irrad::GH_DF)
+		{
+			ssc_number_t calc = (ssc_number_t)((wf.gh - wf.df) / cos(solzen*3.1415926 / 180));
+			if (calc < -1)
+			{
+				if (iyear == 0)
+					r.log(util::format("SAM calculated negative direct normal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+						calc, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+				calc = 0;
+			}
+			if (iyear == 0) r.setIrradianceCalculated(2, calc);
+			if (jj == 0) topOfHourBeam[nn] = calc;
+		}
+
+		if (iyear == 0)
+		{
+			// calculate global if beam & diffuse are selected as inputs
+			if (radmode == irrad::DN_DF)
+			{
+				ssc_number_t calc = (ssc_number_t)(wf.df + wf.dn * cos(solzen*3.1415926 / 180));
+				if (calc < -1)
+				{
+					r.log(util::format("SAM calculated negative global horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+						calc, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+					calc = 0;
+				}
+				r.setIrradianceCalculated(0, calc);
+			}
+
+			// calculate diffuse if total & beam are selected as inputs
+			if (radmode == irrad::DN_GH)
+			{
+				ssc_number_t calc = (ssc_number_t)(wf.gh - wf.dn * cos(solzen*3.1415926 / 180));
+				if (calc < -1)
+				{
+					r.log(util::format("SAM calculated negative diffuse horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+						calc, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+					calc = 0;
+				}
+				r.setIrradianceCalculated(1, calc);
+			}
+		}
+
+		// record sub-array plane of array output before computing shading and soiling
+		if (iyear == 0)
+		{
+			if (radmode != irrad::POA_R)
+				PVSystem->p_poaNominalFront[nn][idx] = (ssc_number_t)((ibeam + iskydiff + ignddiff));
+			else
+				PVSystem->p_poaNominalFront[nn][idx] = (ssc_number_t)((r.ipoa));
+		}
+
+
+		// record sub-array contribution to total POA power for this time step  (W)
+		if (radmode != irrad::POA_R)
+			r.poaFrontNominalW = (ibeam + iskydiff + ignddiff) * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+		else
+			r.poaFrontNominalW = (r.ipoa)* ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+
+		// record sub-array contribution to total POA beam power for this time step (W)
+		r.poaFrontBeamNominalW = ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+
+		// for non-linear shading from shading database
+		if (Subarrays[nn]->shadeCalculator.use_shade_db())
+		{
+			double shadedb_gpoa = ibeam + iskydiff + ignddiff;
+			double shadedb_dpoa = iskydiff + ignddiff;
+
+			// update cell temperature - unshaded value per Sara 1/25/16
+			double tcell = wf.tdry;
+			if (sunup > 0)
+			{
+				// calculated ahead of the timestep loop, so the heat transfer model starts cold here and
+				// does not change the warm start of the timestep loop
+				pvcelltemp_t *cellTempModel = Subarrays[nn]->Module->cellTempModel;
+				mcsp_celltemp_t coldCellTemp;
+				if (cellTempModel == &Subarrays[nn]->Module->mountingSpecificCellTemp)
+				{
+					coldCellTemp = Subarrays[nn]->Module->mountingSpecificCellTemp;
+					coldCellTemp.WarmStart = false;
+					cellTempModel = &coldCellTemp;
+				}
+
+				// calculate cell temperature using selected temperature model
+				pvinput_t in(ibeam, iskydiff, ignddiff, 0, r.ipoa,
+					wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
+					solzen, aoi, hdr.elev,
+					stilt, sazi,
+					((double)wf.hour) + wf.minute / 60.0,
+					radmode, Subarrays[nn]->poa.usePOAFromWF);
+				// voltage set to -1 for max power
+				(*cellTempModel)(in, *Subarrays[nn]->Module->moduleModel, -1.0, tcell);
+			}
+			double shadedb_str_vmp_stc = Subarrays[nn]->nModulesPerString * Subarrays[nn]->Module->voltageMaxPower;
+			double shadedb_mppt_lo = PVSystem->Inverter->mpptLowVoltage;
+			double shadedb_mppt_hi = PVSystem->Inverter->mpptHiVoltage;
+			 
+			// shading database if necessary
+			if (!Subarrays[nn]->shadeCalculator.fbeam_shade_db(&shadeDatabases[nn], hour, solalt, solazi, jj, step_per_hour, shadedb_gpoa, shadedb_dpoa, tcell, Subarrays[nn]->nModulesPerString, shadedb_str_vmp_stc, shadedb_mppt_lo, shadedb_mppt_hi))
+			{
+				throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
+			}
+			if (iyear == 0)
+			{
+#ifdef SHADE_DB_OUTPUTS
+				p_shadedb_gpoa[nn][idx] = (ssc_number_t)shadedb_gpoa;
+				p_shadedb_dpoa[nn][idx] = (ssc_number_t)shadedb_dpoa;
+				p_shadedb_pv_cell_temp[nn][idx] = (ssc_number_t)tcell;
+				p_shadedb_mods_per_str[nn][idx] = (ssc_number_t)Subarrays[nn]->nModulesPerString;
+				p_shadedb_str_vmp_stc[nn][idx] = (ssc_number_t)shadedb_str_vmp_stc;
+				p_shadedb_mppt_lo[nn][idx] = (ssc_number_t)shadedb_mppt_lo;
+				p_shadedb_mppt_hi[nn][idx] = (ssc_number_t)shadedb_mppt_hi;
+				r.log("shade db hour " + util::to_string((int)hour) +"\n" + shadeCalculator->get_warning());
+#endif
+				// fraction shaded for comparison
+				PVSystem->p_shadeDBShadeFraction[nn][idx] = (ssc_number_t)(Subarrays[nn]->shadeCalculator.dc_shade_factor());
+			} 
+		}
+		else
+		{
+			if (!Subarrays[nn]->shadeCalculator.fbeam(hour, solalt, solazi, jj, step_per_hour))
+			{
+				throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
+			}
+		}
+
+		// apply hourly shading factors to beam (if none enabled, factors are 1.0) 
+		// shj 3/21/16 - update to handle negative shading loss
+		if (Subarrays[nn]->shadeCalculator.beam_shade_factor() != 1.0){
+			//							if (sa[nn].shad.beam_shade_factor() < 1.0){
+			// Sara 1/25/16 - shading database derate applied to dc only
+			// shading loss applied to beam if not from shading database
+			ibeam *= Subarrays[nn]->shadeCalculator.beam_shade_factor();
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				Subarrays[nn]->poa.usePOAFromWF = false;
+				if (Subarrays[nn]->poa.poaShadWarningCount == 0){
+					r.log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
+						wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+				}
+				else{
+					r.log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
+						wf.year, wf.month, wf.day, wf.hour), SSC_NOTICE, (float)idx);
+				}
+				Subarrays[nn]->poa.poaShadWarningCount++;
+			}
+		}
+
+		// apply sky diffuse shading factor (specified as constant, nominally 1.0 if disabled in UI)
+		if (Subarrays[nn]->shadeCalculator.fdiff() < 1.0){
+			iskydiff *= Subarrays[nn]->shadeCalculator.fdiff();
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				if (idx == 0)
+					r.log("Combining POA irradiance as input with the diffuse shading losses forces SAM to use a POA decomposition model to calculate incident diffuse irradiance", SSC_WARNING);
+				Subarrays[nn]->poa.usePOAFromWF = false;
+			}
+		}
+
+		double beam_shading_factor = Subarrays[nn]->shadeCalculator.beam_shade_factor();
+
+		//self-shading calculations
+		if (((Subarrays[nn]->trackMode == 0 || Subarrays[nn]->trackMode == 4) && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2)) //fixed tilt or timeseries tilt, self-shading (linear or non-linear) OR
+			|| (Subarrays[nn]->trackMode == 1 && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2) && Subarrays[nn]->backtrackingEnabled == 0)) //one-axis tracking, self-shading, not backtracking
+		{
+
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				if (idx == 0)
+					r.log("Combining POA irradiance as input with self shading forces SAM to employ a POA decomposition model to calculate incident beam irradiance", SSC_WARNING);
+				Subarrays[nn]->poa.usePOAFromWF = false;
+			}
+
+			// info to be passed to self-shading function
+			bool trackbool = (Subarrays[nn]->trackMode == 1);	// 0 for fixed tilt and timeseries tilt, 1 for one-axis
+			bool linear = (Subarrays[nn]->shadeMode == 2); //0 for full self-shading, 1 for linear self-shading
+
+			//geometric fraction of the array that is shaded for one-axis trackers.
+			//USES A DIFFERENT FUNCTION THAN THE SELF-SHADING BECAUSE SS IS MEANT FOR FIXED ONLY. shadeFraction1x IS FOR ONE-AXIS TRACKERS ONLY.
+			//used in the non-linear self-shading calculator for one-axis tracking only
+			double shad1xf = 0;
+			if (trackbool)
+				shad1xf = shadeFraction1x(solazi, solzen, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->groundCoverageRatio, rot);
+
+			//execute self-shading calculations
+			ssc_number_t beam_to_use; //some self-shading calculations require DNI, NOT ibeam (beam in POA). Need to know whether to use DNI from wf or calculated, depending on radmode
+			if (radmode == irrad::DN_DF || radmode == irrad::DN_GH) beam_to_use = (ssc_number_t)wf.dn;
+			else beam_to_use = topOfHourBeam[nn]; // top of hour
+
+			if (linear && trackbool) //one-axis linear
+			{
+				ibeam *= (1 - shad1xf); //derate beam irradiance linearly by the geometric shading fraction calculated above per Chris Deline 2/10/16
+				beam_shading_factor *= (1 - shad1xf);
+				if (iyear == 0)
+				{
+					PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
+					PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - shad1xf);
+					PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)1; //no diffuse derate for linear shading
+					PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)1; //no reflected derate for linear shading
+				}
+			}
+
+			else if (Subarrays[nn]->selfShadingSurface.applies(stilt, sazi) && !trackbool
+				? Subarrays[nn]->selfShadingSurface.exec(solzen, solazi, beam_to_use, ibeam, (iskydiff + ignddiff), alb, linear, Subarrays[nn]->selfShadingOutputs)
+				: ss_exec(Subarrays[nn]->selfShadingInputs, stilt, sazi, solzen, solazi, beam_to_use, ibeam, (iskydiff + ignddiff), alb, trackbool, linear, shad1xf, Subarrays[nn]->selfShadingOutputs))
+			{
+				if (linear) //fixed tilt linear
+				{
+					ibeam *= (1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
+					beam_shading_factor *= (1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
+					if (iyear == 0)
+					{
+						PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
+						PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
+						PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)1; //no diffuse derate for linear shading
+						PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)1; //no reflected derate for linear shading
+					}
+				}
+				else //non-linear: fixed tilt AND one-axis
+				{
+					if (iyear == 0)
+					{
+						PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
+						PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
+						PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_dc_derate;
+						PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)1;
+					}
+
+					// Sky diffuse and ground-reflected diffuse are derated according to C. Deline's algorithm
+					iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
+					ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
+					// Beam is not derated- all beam derate effects (linear and non-linear) are taken into account in the nonlinear_dc_shading_derate
+					Subarrays[nn]->poa.nonlinearDCShadingDerate = Subarrays[nn]->selfShadingOutputs.m_dc_derate;
+				}
+			}
+			else
+				throw exec_error("pvsamv1", util::format("Self-shading calculation failed at %d", (int)idx));
+		}
+
+		double poashad = (radmode == irrad::POA_R) ? r.ipoa : (ibeam + iskydiff + ignddiff);
+
+		// determine sub-array contribution to total shaded plane of array for this hour
+		r.poaFrontShadedW = poashad * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+
+		// apply soiling derate to all components of irradiance
+		double soiling_factor = 1.0;
+		int month_idx = wf.month - 1;
+		if (month_idx >= 0 && month_idx < 12)
+		{
+			soiling_factor = Subarrays[nn]->monthlySoiling[month_idx];
+			ibeam *= soiling_factor;
+			iskydiff *= soiling_factor;
+			ignddiff *= soiling_factor;
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+				r.ipoa *= soiling_factor;
+				if (soiling_factor < 1 && idx == 0)
+					r.log("Soiling may already be accounted for in the input POA data. Please confirm that the input data does not contain soiling effects, or remove the additional losses on the Losses page.", SSC_WARNING);
+			}
+			beam_shading_factor *= soiling_factor;
+		}
+
+		// Calculate total front irradiation after soiling added to shading
+		r.ipoaFront = ibeam + iskydiff + ignddiff;
+		r.poaFrontShadedSoiledW = r.ipoaFront * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+		
+		// Calculate rear-side irradiance for bifacial modules
+		if (Subarrays[0]->Module->isBifacial)
+		{
+			double slopeLength = Subarrays[nn]->selfShadingInputs.length * Subarrays[nn]->selfShadingInputs.nmody;
+			if (Subarrays[nn]->selfShadingInputs.mod_orient == 1) {
+				slopeLength = Subarrays[nn]->selfShadingInputs.width * Subarrays[nn]->selfShadingInputs.nmody;
+			}
+			irr.calc_rear_side(Subarrays[0]->Module->bifacialTransmissionFactor, Subarrays[0]->Module->bifaciality, Subarrays[0]->Module->groundClearanceHeight, slopeLength, &bifacialGeometry[nn]);
+			r.ipoaRear = irr.get_poa_rear();
+			r.ipoaRearAfterLosses = r.ipoaRear * (1 - Subarrays[nn]->rearIrradianceLossPercent);
+		}
+
+		r.poaRearW = r.ipoaRear * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+
+		if (iyear == 0) 
+		{
+			// save sub-array level outputs			
+			PVSystem->p_poaShadedFront[nn][idx] = (ssc_number_t)poashad;
+			PVSystem->p_poaShadedSoiledFront[nn][idx] = (ssc_number_t)r.ipoaFront;
+			PVSystem->p_poaBeamFront[nn][idx] = (ssc_number_t)ibeam;
+			PVSystem->p_poaDiffuseFront[nn][idx] = (ssc_number_t)(iskydiff + ignddiff);
+			PVSystem->p_poaRear[nn][idx] = (ssc_number_t)(r.ipoaRearAfterLosses);
+			PVSystem->p_beamShadingFactor[nn][idx] = (ssc_number_t)beam_shading_factor;
+			PVSystem->p_axisRotation[nn][idx] = (ssc_number_t)rot;
+			PVSystem->p_idealRotation[nn][idx] = (ssc_number_t)(rot - btd);
+			PVSystem->p_angleOfIncidence[nn][idx] = (ssc_number_t)aoi;
+			PVSystem->p_surfaceTilt[nn][idx] = (ssc_number_t)stilt;
+			PVSystem->p_surfaceAzimuth[nn][idx] = (ssc_number_t)sazi;
+			PVSystem->p_derateSoiling[nn][idx] = (ssc_number_t)soiling_factor;
+		}
+
+		// accumulate incident total radiation (W) in this timestep (all subarrays)
+		r.poaFrontBeamEffW = ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+
+		// save the required irradiance inputs on array plane for the module output calculations.
+		r.poaBeamFront = ibeam;
+		r.poaDiffuseFront = iskydiff;
+		r.poaGroundFront = ignddiff;
+		r.poaTotal = (radmode == irrad::POA_R) ? r.ipoa :(r.ipoaFront + r.ipoaRearAfterLosses);
+		r.angleOfIncidenceDegrees = aoi;
+		r.surfaceTiltDegrees = stilt;
+		r.surfaceAzimuthDegrees = sazi;
+		r.nonlinearDCShadingDerate = Subarrays[nn]->poa.nonlinearDCShadingDerate;
+		r.dcShadeFactor = Subarrays[nn]->shadeCalculator.dc_shade_factor();
+		r.usePOAFromWF = Subarrays[nn]->poa.usePOAFromWF;
+
+	};
+
 	for (size_t iyear = 0; iyear < nyears; iyear++)
 	{
 		for (hour = 0; hour < 8760; hour++)
@@ -1101,6 +1587,107 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 				ireplast = ireport;
 			}
 
+			// read the weather and calculate the irradiance on each subarray for the next block of timesteps
+			if (hour % blockHours == 0)
+			{
+				size_t blockSteps = (std::min(hour + blockHours, (size_t)8760) - hour) * step_per_hour;
+				blockWeather.resize(blockSteps);
+				for (size_t k = 0; k < blockSteps; k++)
+				{
+					if (!wdprov->read(&blockWeather[k]))
+						throw exec_error("pvsamv1", "could not read data line " + util::to_string((int)(idx + k + 1)) + " in weather file");
+				}
+				blockStart = idx;
+
+				// the sun position is the same for all subarrays, and is calculated once for the block
+				if (!reuseIrradiance || iyear == 0)
+				{
+					blockYear.resize(blockSteps);
+					blockMonth.resize(blockSteps);
+					blockDay.resize(blockSteps);
+					blockHour.resize(blockSteps);
+					blockMinute.resize(blockSteps);
+					for (size_t k = 0; k < blockSteps; k++)
+					{
+						blockYear[k] = blockWeather[k].year;
+						blockMonth[k] = blockWeather[k].month;
+						blockDay[k] = blockWeather[k].day;
+						blockHour[k] = blockWeather[k].hour;
+						blockMinute[k] = blockWeather[k].minute;
+					}
+
+					int *tsp[3];
+					double *sunn[9];
+					for (int i = 0; i < 3; i++)
+					{
+						blockSunPosition[i].resize(blockSteps);
+						tsp[i] = &blockSunPosition[i][0];
+					}
+					for (int i = 0; i < 9; i++)
+					{
+						blockSunAngles[i].resize(blockSteps);
+						sunn[i] = &blockSunAngles[i][0];
+					}
+					solarpos_timestep_array(blockSteps, &blockYear[0], &blockMonth[0], &blockDay[0], &blockHour[0], &blockMinute[0],
+						Irradiance->instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : Irradiance->dtHour,
+						Irradiance->weatherHeader.lat, Irradiance->weatherHeader.lon, Irradiance->weatherHeader.tz, tsp, sunn);
+				}
+
+				// workers pull the next unclaimed subarray from a shared counter
+				std::atomic<size_t> next(0);
+				auto worker = [&]()
+				{
+					size_t nn;
+					while ((nn = next++) < num_subarrays)
+					{
+						std::vector<subarray_irradiance> &block = blockIrradiance[nn];
+						block.resize(blockSteps);
+						for (size_t k = 0; k < blockSteps; k++)
+							block[k].reset();
+
+						if (!Subarrays[nn]->enable
+							|| Subarrays[nn]->nStrings < 1)
+							continue; // skip disabled subarrays
+
+						subarray_irradiance_history &history = irradianceHistory[nn];
+						if (reuseIrradiance && iyear > 0)
+						{
+							for (size_t k = 0; k < blockSteps; k++)
+								history.load(hour * step_per_hour + k, block[k]);
+							continue;
+						}
+
+						for (size_t k = 0; k < blockSteps; k++)
+						{
+							block[k].active = true;
+							try {
+								int sunPosition[3];
+								double sunAngles[9];
+								for (int i = 0; i < 3; i++) sunPosition[i] = blockSunPosition[i][k];
+								for (int i = 0; i < 9; i++) sunAngles[i] = blockSunAngles[i][k];
+								subarrayIrradiance(nn, iyear, hour + k / step_per_hour, k % step_per_hour, blockStart + k, blockWeather[k], sunPosition, sunAngles, block[k]);
+							}
+							catch (...) {
+								// rethrown when this timestep is reached below
+								block[k].error = std::current_exception();
+								break;
+							}
+							if (reuseIrradiance)
+								history.store(hour * step_per_hour + k, block[k]);
+						}
+					}
+				};
+
+				std::vector<std::thread> pool;
+				for (size_t t = 1; t < nthreads; t++)
+					pool.push_back(std::thread(worker));
+
+				worker(); // the calling thread calculates subarrays too
+
+				for (size_t t = 0; t < pool.size(); t++)
+					pool[t].join();
+			}
+
 			// only hourly electric load, even
 			// if PV simulation is subhourly.  load is assumed constant over the hour.
 			// if no load profile supplied, load = 0
@@ -1123,26 +1710,11 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 				//						iyear, hour, jj, cur_load), SSC_WARNING, (float)idx);
 				p_load_full.push_back((ssc_number_t)cur_load);
 
-				if (!wdprov->read(&Irradiance->weatherRecord))
-					throw exec_error("pvsamv1", "could not read data line " + util::to_string((int)(idx + 1)) + " in weather file");
-
-				weather_record wf = Irradiance->weatherRecord;
-
-				//update POA data structure indicies if radmode is POA model is enabled
-				if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-					for (size_t nn = 0; nn < num_subarrays; nn++){
-						if (!Subarrays[nn]->enable) continue;
+				// weather and irradiance for this timestep were read and calculated ahead for the block
+				size_t blockStep = idx - blockStart;
+				weather_record wf = blockWeather[blockStep];
+				Irradiance->weatherRecord = wf;
 
-						Subarrays[nn]->poa.poaAll->tDew = wf.tdew;
-						Subarrays[nn]->poa.poaAll->i = idx;
-						if (jj == 0 && wf.hour == 0) {
-							Subarrays[nn]->poa.poaAll->dayStart = idx;
-							Subarrays[nn]->poa.poaAll->doy += 1;
-						}
-
-					}
-				}
-				
 				double solazi = 0, solzen = 0, solalt = 0;
 				int sunup = 0;
 
@@ -1158,8 +1730,8 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 				double ts_accum_poa_total_eff = 0.0;
 				double ts_accum_poa_front_beam_eff = 0.0;
 
-				// calculate incident irradiance on each subarray
-				std::vector<double> ipoa_rear, ipoa_rear_after_losses, ipoa_front, ipoa;
+				// incident irradiance on each subarray
+				std::vector<double> ipoa_rear, ipoa_rear_after_losses, ipoa_front, ipoa, dcShadeFactor;
 				double alb;
 				alb = 0;
 
@@ -1169,384 +1741,64 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 					ipoa_rear_after_losses.push_back(0);
 					ipoa_front.push_back(0);
 					ipoa.push_back(0);
+					dcShadeFactor.push_back(Subarrays[nn]->shadeCalculator.dc_shade_factor());
 
-					if (!Subarrays[nn]->enable
-						|| Subarrays[nn]->nStrings < 1)
+					subarray_irradiance &r = blockIrradiance[nn][blockStep];
+					for (size_t m = 0; m < r.messages.size(); m++)
+						log(r.messages[m].text, r.messages[m].type, r.messages[m].time);
+					if (r.error)
+						std::rethrow_exception(r.error);
+
+					if (!r.active)
 						continue; // skip disabled subarrays
 
-					irrad irr(Irradiance->weatherRecord, Irradiance->weatherHeader,
-						Irradiance->skyModel, Irradiance->radiationMode, Subarrays[nn]->trackMode,
-						Irradiance->useWeatherFileAlbedo, Irradiance->instantaneous, Subarrays[nn]->backtrackingEnabled,
-						Irradiance->dtHour, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->trackerRotationLimitDegrees, Subarrays[nn]->groundCoverageRatio,
-						Subarrays[nn]->monthlyTiltDegrees, Irradiance->userSpecifiedMonthlyAlbedo,
-						Subarrays[nn]->poa.poaAll.get());
-											
-					int code = irr.calc();
-
-					if (code < 0) //jmf updated 11/30/18 so that negative numbers are errors, positive numbers are warnings, 0 is everything correct. implemented in patch for POA model only, will be added to develop for other irrad models as well
-						throw exec_error("pvsamv1",
-						util::format("failed to calculate irradiance incident on surface (POA) %d (code: %d) [y:%d m:%d d:%d h:%d]",
-						nn + 1, code, wf.year, wf.month, wf.day, wf.hour));
-
-					if (code == 40)
-						log(util::format("SAM calculated negative direct normal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
-							wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-					else if (code == 41)
-						log(util::format("SAM calculated negative diffuse horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
-							wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-					else if (code == 42)
-						log(util::format("SAM calculated negative global horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
-							wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-									   					 
+					solazi = r.solazi;
+					solzen = r.solzen;
+					solalt = r.solalt;
+					sunup = r.sunup;
+					alb = r.alb;
+					ipoa[nn] = r.ipoa;
+					ipoa_front[nn] = r.ipoaFront;
+					ipoa_rear[nn] = r.ipoaRear;
+					ipoa_rear_after_losses[nn] = r.ipoaRearAfterLosses;
+					dcShadeFactor[nn] = r.dcShadeFactor;
+
 					// p_irrad_calc is only weather file records long...
 					if (iyear == 0)
 					{
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P) {
-							double gh_temp, df_temp, dn_temp;
-							gh_temp = df_temp = dn_temp = 0;
-							irr.get_irrad(&gh_temp, &dn_temp, &df_temp);
-							Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)df_temp;
-							Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)dn_temp;
-						}
-					}
-					// beam, skydiff, and grounddiff IN THE PLANE OF ARRAY (W/m2)
-					double ibeam, iskydiff, ignddiff;
-					double aoi, stilt, sazi, rot, btd;
-
-					// Ensure that the usePOAFromWF flag is false unless a reference cell has been used. 
-					//  This will later get forced to false if any shading has been applied (in any scenario)
-					//  also this will also be forced to false if using the cec mcsp thermal model OR if using the spe module model with a diffuse util. factor < 1.0
-					Subarrays[nn]->poa.usePOAFromWF = false;
-					if (radmode == irrad::POA_R){
-						ipoa[nn] = wf.poa;
-						Subarrays[nn]->poa.usePOAFromWF = true;
-					}
-					else if (radmode == irrad::POA_P){
-						ipoa[nn] = wf.poa;
-					}
-
-					if (Subarrays[nn]->Module->simpleEfficiencyForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){  // only will be true if using a poa model AND spe module model AND spe_fp is < 1
-						Subarrays[nn]->poa.usePOAFromWF = false;
-						if (idx == 0)
-							log("The combination of POA irradiance as in input, single point efficiency module model, and module diffuse utilization factor less than one means that SAM must use a POA decomposition model to calculate the incident diffuse irradiance", SSC_WARNING);
-					}
-
-					if (Subarrays[nn]->Module->mountingSpecificCellTemperatureForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){
-						Subarrays[nn]->poa.usePOAFromWF = false;
-						if (idx == 0)
-							log("The combination of POA irradiance as input and heat transfer method for cell temperature means that SAM must use a POA decomposition model to calculate the beam irradiance required by the cell temperature model", SSC_WARNING);
-					}
-
-
-					// Get Incident angles and irradiances
-					irr.get_sun(&solazi, &solzen, &solalt, 0, 0, 0, &sunup, 0, 0, 0);
-					irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
-					irr.get_poa(&ibeam, &iskydiff, &ignddiff, 0, 0, 0);
-					alb = irr.getAlbedo();
-
-					if (iyear == 0)
-						Irradiance->p_sunPositionTime[idx] = (ssc_number_t)irr.get_sunpos_calc_hour();
+						for (int i = 0; i < 3; i++)
+							if (r.irradianceCalculatedSet[i])
+								Irradiance->p_IrradianceCalculated[i][idx] = r.irradianceCalculated[i];
+						Irradiance->p_sunPositionTime[idx] = (ssc_number_t)r.sunPositionHour;
 
-					// save weather file beam, diffuse, and global for output and for use later in pvsamv1- year 1 only
-					/*jmf 2016: these calculations are currently redundant with calculations in irrad.calc() because ibeam and idiff in that function are DNI and DHI, **NOT** in the plane of array
-					we'll have to fix this redundancy in the pvsamv1 rewrite. it will require allowing irradproc to report the errors below
-					and deciding what to do if the weather file DOES contain the third component but it's not being used in the calculations.*/
-					if (iyear == 0)
-					{
 						// Apply all irradiance component data from weather file (if it exists)
 						Irradiance->p_weatherFilePOA[0][idx] = (ssc_number_t)wf.poa;
 						Irradiance->p_weatherFileDNI[idx] = (ssc_number_t)wf.dn;
 						Irradiance->p_weatherFileGHI[idx] = (ssc_number_t)(wf.gh);
 						Irradiance->p_weatherFileDHI[idx] = (ssc_number_t)(wf.df);
-
-						// calculate beam if global & diffuse are selected as inputs
-						if (radmode == irrad::GH_DF)
-						{
-							Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)((wf.gh - wf.df) / cos(solzen*3.1415926 / 180));
-							if (Irradiance->p_IrradianceCalculated[2][idx] < -1)
-							{
-								log(util::format("SAM calculated negative direct normal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-									Irradiance->p_IrradianceCalculated[2][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-								Irradiance->p_IrradianceCalculated[2][idx] = 0;
-							}
-						}
-
-						// calculate global if beam & diffuse are selected as inputs
-						if (radmode == irrad::DN_DF)
-						{
-							Irradiance->p_IrradianceCalculated[0][idx] = (ssc_number_t)(wf.df + wf.dn * cos(solzen*3.1415926 / 180));
-							if (Irradiance->p_IrradianceCalculated[0][idx] < -1)
-							{
-								log(util::format("SAM calculated negative global horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-									Irradiance->p_IrradianceCalculated[0][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-								Irradiance->p_IrradianceCalculated[0][idx] = 0;
-							}
-						}
-
-						// calculate diffuse if total & beam are selected as inputs
-						if (radmode == irrad::DN_GH)
-						{
-							Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)(wf.gh - wf.dn * cos(solzen*3.1415926 / 180));
-							if (Irradiance->p_IrradianceCalculated[1][idx] < -1)
-							{
-								log(util::format("SAM calculated negative diffuse horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-									Irradiance->p_IrradianceCalculated[1][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-								Irradiance->p_IrradianceCalculated[1][idx] = 0;
-							}
-						}
-					}
-
-					// record sub-array plane of array output before computing shading and soiling
-					if (iyear == 0)
-					{
-						if (radmode != irrad::POA_R)
-							PVSystem->p_poaNominalFront[nn][idx] = (ssc_number_t)((ibeam + iskydiff + ignddiff));
-						else
-							PVSystem->p_poaNominalFront[nn][idx] = (ssc_number_t)((ipoa[nn]));
 					}
 
-
-					// record sub-array contribution to total POA power for this time step  (W)
-					if (radmode != irrad::POA_R)
-						ts_accum_poa_front_nom += (ibeam + iskydiff + ignddiff) * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-					else
-						ts_accum_poa_front_nom += (ipoa[nn])* ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-
-					// record sub-array contribution to total POA beam power for this time step (W)
-					ts_accum_poa_front_beam_nom += ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-
-					// for non-linear shading from shading database
-					if (Subarrays[nn]->shadeCalculator.use_shade_db())
-					{
-						double shadedb_gpoa = ibeam + iskydiff + ignddiff;
-						double shadedb_dpoa = iskydiff + ignddiff;
-
-						// update cell temperature - unshaded value per Sara 1/25/16
-						double tcell = wf.tdry;
-						if (sunup > 0)
-						{
-							// calculate cell temperature using selected temperature model
-							pvinput_t in(ibeam, iskydiff, ignddiff, 0, ipoa[nn],
-								wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
-								solzen, aoi, hdr.elev,
-								stilt, sazi,
-								((double)wf.hour) + wf.minute / 60.0,
-								radmode, Subarrays[nn]->poa.usePOAFromWF);
-							// voltage set to -1 for max power
-							(*Subarrays[nn]->Module->cellTempModel)(in, *Subarrays[nn]->Module->moduleModel, -1.0, tcell);
-						}
-						double shadedb_str_vmp_stc = Subarrays[nn]->nModulesPerString * Subarrays[nn]->Module->voltageMaxPower;
-						double shadedb_mppt_lo = PVSystem->Inverter->mpptLowVoltage;
-						double shadedb_mppt_hi = PVSystem->Inverter->mpptHiVoltage;
-						 
-						// shading database if necessary
-						if (!Subarrays[nn]->shadeCalculator.fbeam_shade_db(shadeDatabase, hour, solalt, solazi, jj, step_per_hour, shadedb_gpoa, shadedb_dpoa, tcell, Subarrays[nn]->nModulesPerString, shadedb_str_vmp_stc, shadedb_mppt_lo, shadedb_mppt_hi))
-						{
-							throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
-						}
-						if (iyear == 0)
-						{
-#ifdef SHADE_DB_OUTPUTS
-							p_shadedb_gpoa[nn][idx] = (ssc_number_t)shadedb_gpoa;
-							p_shadedb_dpoa[nn][idx] = (ssc_number_t)shadedb_dpoa;
-							p_shadedb_pv_cell_temp[nn][idx] = (ssc_number_t)tcell;
-							p_shadedb_mods_per_str[nn][idx] = (ssc_number_t)Subarrays[nn]->nModulesPerString;
-							p_shadedb_str_vmp_stc[nn][idx] = (ssc_number_t)shadedb_str_vmp_stc;
-							p_shadedb_mppt_lo[nn][idx] = (ssc_number_t)shadedb_mppt_lo;
-							p_shadedb_mppt_hi[nn][idx] = (ssc_number_t)shadedb_mppt_hi;
-							log("shade db hour " + util::to_string((int)hour) +"\n" + shadeCalculator->get_warning());
-#endif
-							// fraction shaded for comparison
-							PVSystem->p_shadeDBShadeFraction[nn][idx] = (ssc_number_t)(Subarrays[nn]->shadeCalculator.dc_shade_factor());
-						} 
-					}
-					else
-					{
-						if (!Subarrays[nn]->shadeCalculator.fbeam(hour, solalt, solazi, jj, step_per_hour))
-						{
-							throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
-						}
-					}
-
-					// apply hourly shading factors to beam (if none enabled, factors are 1.0) 
-					// shj 3/21/16 - update to handle negative shading loss
-					if (Subarrays[nn]->shadeCalculator.beam_shade_factor() != 1.0){
-						//							if (sa[nn].shad.beam_shade_factor() < 1.0){
-						// Sara 1/25/16 - shading database derate applied to dc only
-						// shading loss applied to beam if not from shading database
-						ibeam *= Subarrays[nn]->shadeCalculator.beam_shade_factor();
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-							Subarrays[nn]->poa.usePOAFromWF = false;
-							if (Subarrays[nn]->poa.poaShadWarningCount == 0){
-								log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
-									wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-							}
-							else{
-								log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
-									wf.year, wf.month, wf.day, wf.hour), SSC_NOTICE, (float)idx);
-							}
-							Subarrays[nn]->poa.poaShadWarningCount++;
-						}
-					}
-
-					// apply sky diffuse shading factor (specified as constant, nominally 1.0 if disabled in UI)
-					if (Subarrays[nn]->shadeCalculator.fdiff() < 1.0){
-						iskydiff *= Subarrays[nn]->shadeCalculator.fdiff();
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-							if (idx == 0)
-								log("Combining POA irradiance as input with the diffuse shading losses forces SAM to use a POA decomposition model to calculate incident diffuse irradiance", SSC_WARNING);
-							Subarrays[nn]->poa.usePOAFromWF = false;
-						}
-					}
-
-					double beam_shading_factor = Subarrays[nn]->shadeCalculator.beam_shade_factor();
-
-					//self-shading calculations
-					if (((Subarrays[nn]->trackMode == 0 || Subarrays[nn]->trackMode == 4) && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2)) //fixed tilt or timeseries tilt, self-shading (linear or non-linear) OR
-						|| (Subarrays[nn]->trackMode == 1 && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2) && Subarrays[nn]->backtrackingEnabled == 0)) //one-axis tracking, self-shading, not backtracking
-					{
-
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-							if (idx == 0)
-								log("Combining POA irradiance as input with self shading forces SAM to employ a POA decomposition model to calculate incident beam irradiance", SSC_WARNING);
-							Subarrays[nn]->poa.usePOAFromWF = false;
-						}
-
-						// info to be passed to self-shading function
-						bool trackbool = (Subarrays[nn]->trackMode == 1);	// 0 for fixed tilt and timeseries tilt, 1 for one-axis
-						bool linear = (Subarrays[nn]->shadeMode == 2); //0 for full self-shading, 1 for linear self-shading
-
-						//geometric fraction of the array that is shaded for one-axis trackers.
-						//USES A DIFFERENT FUNCTION THAN THE SELF-SHADING BECAUSE SS IS MEANT FOR FIXED ONLY. shadeFraction1x IS FOR ONE-AXIS TRACKERS ONLY.
-						//used in the non-linear self-shading calculator for one-axis tracking only
-						double shad1xf = 0;
-						if (trackbool)
-							shad1xf = shadeFraction1x(solazi, solzen, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->groundCoverageRatio, rot);
-
-						//execute self-shading calculations
-						ssc_number_t beam_to_use; //some self-shading calculations require DNI, NOT ibeam (beam in POA). Need to know whether to use DNI from wf or calculated, depending on radmode
-						if (radmode == irrad::DN_DF || radmode == irrad::DN_GH) beam_to_use = (ssc_number_t)wf.dn;
-						else beam_to_use = Irradiance->p_IrradianceCalculated[2][hour * step_per_hour]; // top of hour in first year
-
-						if (linear && trackbool) //one-axis linear
-						{
-							ibeam *= (1 - shad1xf); //derate beam irradiance linearly by the geometric shading fraction calculated above per Chris Deline 2/10/16
-							beam_shading_factor *= (1 - shad1xf);
-							if (iyear == 0)
-							{
-								PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
-								PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - shad1xf);
-								PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)1; //no diffuse derate for linear shading
-								PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)1; //no reflected derate for linear shading
-							}
-						}
-
-						else if (ss_exec(Subarrays[nn]->selfShadingInputs, stilt, sazi, solzen, solazi, beam_to_use, ibeam, (iskydiff + ignddiff), alb, trackbool, linear, shad1xf, Subarrays[nn]->selfShadingOutputs))
-						{
-							if (linear) //fixed tilt linear
-							{
-								ibeam *= (1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-								beam_shading_factor *= (1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-								if (iyear == 0)
-								{
-									PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
-									PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-									PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)1; //no diffuse derate for linear shading
-									PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)1; //no reflected derate for linear shading
-								}
-							}
-							else //non-linear: fixed tilt AND one-axis
-							{
-								if (iyear == 0)
-								{
-									PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-									PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-									PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_dc_derate;
-									PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)1;
-								}
-
-								// Sky diffuse and ground-reflected diffuse are derated according to C. Deline's algorithm
-								iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-								ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-								// Beam is not derated- all beam derate effects (linear and non-linear) are taken into account in the nonlinear_dc_shading_derate
-								Subarrays[nn]->poa.nonlinearDCShadingDerate = Subarrays[nn]->selfShadingOutputs.m_dc_derate;
-							}
-						}
-						else
-							throw exec_error("pvsamv1", util::format("Self-shading calculation failed at %d", (int)idx));
-					}
-
-					double poashad = (radmode == irrad::POA_R) ? ipoa[nn] : (ibeam + iskydiff + ignddiff);
-
-					// determine sub-array contribution to total shaded plane of array for this hour
-					ts_accum_poa_front_shaded += poashad * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-
-					// apply soiling derate to all components of irradiance
-					double soiling_factor = 1.0;
-					int month_idx = wf.month - 1;
-					if (month_idx >= 0 && month_idx < 12)
-					{
-						soiling_factor = Subarrays[nn]->monthlySoiling[month_idx];
-						ibeam *= soiling_factor;
-						iskydiff *= soiling_factor;
-						ignddiff *= soiling_factor;
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-							ipoa[nn] *= soiling_factor;
-							if (soiling_factor < 1 && idx == 0)
-								log("Soiling may already be accounted for in the input POA data. Please confirm that the input data does not contain soiling effects, or remove the additional losses on the Losses page.", SSC_WARNING);
-						}
-						beam_shading_factor *= soiling_factor;
-					}
-
-					// Calculate total front irradiation after soiling added to shading
-					ipoa_front[nn] = ibeam + iskydiff + ignddiff;
-					ts_accum_poa_front_shaded_soiled += ipoa_front[nn] * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-					
-					// Calculate rear-side irradiance for bifacial modules
-					if (Subarrays[0]->Module->isBifacial)
-					{
-						double slopeLength = Subarrays[nn]->selfShadingInputs.length * Subarrays[nn]->selfShadingInputs.nmody;
-						if (Subarrays[nn]->selfShadingInputs.mod_orient == 1) {
-							slopeLength = Subarrays[nn]->selfShadingInputs.width * Subarrays[nn]->selfShadingInputs.nmody;
-						}
-						irr.calc_rear_side(Subarrays[0]->Module->bifacialTransmissionFactor, Subarrays[0]->Module->bifaciality, Subarrays[0]->Module->groundClearanceHeight, slopeLength);
-						ipoa_rear[nn] = irr.get_poa_rear();
-						ipoa_rear_after_losses[nn] = ipoa_rear[nn] * (1 - Subarrays[nn]->rearIrradianceLossPercent);
-					}
-
-					ts_accum_poa_rear += ipoa_rear[nn] * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+					// record sub-array contributions to the system totals for this time step (W)
+					ts_accum_poa_front_nom += r.poaFrontNominalW;
+					ts_accum_poa_front_beam_nom += r.poaFrontBeamNominalW;
+					ts_accum_poa_front_shaded += r.poaFrontShadedW;
+					ts_accum_poa_front_shaded_soiled += r.poaFrontShadedSoiledW;
+					ts_accum_poa_rear += r.poaRearW;
 					ts_accum_poa_rear_after_losses = ts_accum_poa_rear * (1 - Subarrays[nn]->rearIrradianceLossPercent);
-
-					if (iyear == 0) 
-					{
-						// save sub-array level outputs			
-						PVSystem->p_poaShadedFront[nn][idx] = (ssc_number_t)poashad;
-						PVSystem->p_poaShadedSoiledFront[nn][idx] = (ssc_number_t)ipoa_front[nn];
-						PVSystem->p_poaBeamFront[nn][idx] = (ssc_number_t)ibeam;
-						PVSystem->p_poaDiffuseFront[nn][idx] = (ssc_number_t)(iskydiff + ignddiff);
-						PVSystem->p_poaRear[nn][idx] = (ssc_number_t)(ipoa_rear_after_losses[nn]);
-						PVSystem->p_beamShadingFactor[nn][idx] = (ssc_number_t)beam_shading_factor;
-						PVSystem->p_axisRotation[nn][idx] = (ssc_number_t)rot;
-						PVSystem->p_idealRotation[nn][idx] = (ssc_number_t)(rot - btd);
-						PVSystem->p_angleOfIncidence[nn][idx] = (ssc_number_t)aoi;
-						PVSystem->p_surfaceTilt[nn][idx] = (ssc_number_t)stilt;
-						PVSystem->p_surfaceAzimuth[nn][idx] = (ssc_number_t)sazi;
-						PVSystem->p_derateSoiling[nn][idx] = (ssc_number_t)soiling_factor;
-					}
-
-					// accumulate incident total radiation (W) in this timestep (all subarrays)
-					ts_accum_poa_front_beam_eff += ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-
-					// save the required irradiance inputs on array plane for the module output calculations.
-					Subarrays[nn]->poa.poaBeamFront = ibeam;
-					Subarrays[nn]->poa.poaDiffuseFront = iskydiff;
-					Subarrays[nn]->poa.poaGroundFront = ignddiff;
-					Subarrays[nn]->poa.poaRear = ipoa_rear_after_losses[nn];
-					Subarrays[nn]->poa.poaTotal = (radmode == irrad::POA_R) ? ipoa[nn] :(ipoa_front[nn] + ipoa_rear_after_losses[nn]);
-					Subarrays[nn]->poa.angleOfIncidenceDegrees = aoi;
-					Subarrays[nn]->poa.sunUp = sunup;
-					Subarrays[nn]->poa.surfaceTiltDegrees = stilt;
-					Subarrays[nn]->poa.surfaceAzimuthDegrees = sazi;
+					ts_accum_poa_front_beam_eff += r.poaFrontBeamEffW;
+
+					// the irradiance inputs on array plane for the module output calculations
+					Subarrays[nn]->poa.poaBeamFront = r.poaBeamFront;
+					Subarrays[nn]->poa.poaDiffuseFront = r.poaDiffuseFront;
+					Subarrays[nn]->poa.poaGroundFront = r.poaGroundFront;
+					Subarrays[nn]->poa.poaRear = r.ipoaRearAfterLosses;
+					Subarrays[nn]->poa.poaTotal = r.poaTotal;
+					Subarrays[nn]->poa.angleOfIncidenceDegrees = r.angleOfIncidenceDegrees;
+					Subarrays[nn]->poa.sunUp = r.sunup;
+					Subarrays[nn]->poa.surfaceTiltDegrees = r.surfaceTiltDegrees;
+					Subarrays[nn]->poa.surfaceAzimuthDegrees = r.surfaceAzimuthDegrees;
+					Subarrays[nn]->poa.nonlinearDCShadingDerate = r.nonlinearDCShadingDerate;
+					Subarrays[nn]->poa.usePOAFromWF = r.usePOAFromWF;
 				}
 
 				std::vector<double> mpptVoltageClipping; //a vector to store power that is clipped due to the inverter MPPT low & high voltage limits for each subarray
@@ -1769,14 +2021,16 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 
 					// Sara 1/25/16 - shading database derate applied to dc only
 					// shading loss applied to beam if not from shading database
-					Subarrays[nn]->Module->dcPowerW *= Subarrays[nn]->shadeCalculator.dc_shade_factor();
+					Subarrays[nn]->Module->dcPowerW *= dcShadeFactor[nn];
 
 					// Calculate and apply snow coverage losses if activated
 					if (PVSystem->enableSnowModel)
 					{
 						float smLoss = 0.0f;
 
-						if (Subarrays[nn]->snowModel.getLoss((float)(Subarrays[nn]->poa.poaBeamFront + Subarrays[nn]->poa.poaDiffuseFront + Subarrays[nn]->poa.poaGroundFront),
+						if (Subarrays[nn]->snowModel.canSkip((float)wf.snow, (float)Subarrays[nn]->poa.surfaceTiltDegrees, sunup))
+							Subarrays[nn]->snowModel.skipStep((float)wf.snow);
+						else if (Subarrays[nn]->snowModel.getLoss((float)(Subarrays[nn]->poa.poaBeamFront + Subarrays[nn]->poa.poaDiffuseFront + Subarrays[nn]->poa.poaGroundFront),
 							(float)Subarrays[nn]->poa.surfaceTiltDegrees, (float)wf.wspd, (float)wf.tdry, (float)wf.snow, sunup, 1.0f / step_per_hour, smLoss))
 						{
 							if (!Subarrays[nn]->snowModel.good)
@@ -1925,9 +2179,51 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 
 	double annual_dc_loss_ond = 0, annual_ac_loss_ond = 0; // (TR)
 
+	// without a DC-connected battery the inverter inputs for each year are all known from the DC calculation,
+	// so the inverter is run over the whole year in one pass before the AC losses are applied step by step
+	bool inverterYearAtATime = !(en_batt && (batt_topology == ChargeController::DC_CONNECTED));
+	size_t stepsPerYear = 8760 * step_per_hour;
+	std::vector<double> yearTdry(stepsPerYear);
+	std::vector<std::vector<double> > yearPowerPerMppt_kW, yearVoltagePerMppt;
+	SharedInverterSeries inverterYear;
 
 	for (size_t iyear = 0; iyear < nyears; iyear++)
 	{
+		size_t yearStart = idx;
+		for (size_t k = 0; k < stepsPerYear; k++)
+		{
+			wdprov->read(&Irradiance->weatherRecord);
+			yearTdry[k] = Irradiance->weatherRecord.tdry;
+		}
+
+		if (inverterYearAtATime)
+		{
+			// PVyield inverter model takes the total DC power on a single input
+			size_t nInputs = (PVSystem->Inverter->inverterType == INVERTER_PVYIELD) ? 1 : PVSystem->Inverter->nMpptInputs;
+			yearPowerPerMppt_kW.resize(nInputs);
+			yearVoltagePerMppt.resize(nInputs);
+			std::vector<const double*> powerPerMppt(nInputs), voltagePerMppt(nInputs);
+			for (size_t m = 0; m < nInputs; m++)
+			{
+				yearPowerPerMppt_kW[m].resize(stepsPerYear);
+				yearVoltagePerMppt[m].resize(stepsPerYear);
+				for (size_t k = 0; k < stepsPerYear; k++)
+				{
+					if (PVSystem->Inverter->inverterType == INVERTER_PVYIELD)
+						yearPowerPerMppt_kW[m][k] = PVSystem->p_systemDCPower[yearStart + k];
+					else
+						yearPowerPerMppt_kW[m][k] = PVSystem->p_dcPowerNetPerMppt[m][yearStart + k] * util::watt_to_kilowatt;
+					yearVoltagePerMppt[m][k] = PVSystem->p_mpptVoltage[m][yearStart + k];
+				}
+				powerPerMppt[m] = yearPowerPerMppt_kW[m].data();
+				voltagePerMppt[m] = yearVoltagePerMppt[m].data();
+			}
+
+			// inverter: runs at all hours of the day, even if no DC power.  important
+			// for capturing tare losses
+			sharedInverter->calculateACPower(stepsPerYear, powerPerMppt, voltagePerMppt, yearTdry.data(), inverterYear);
+		}
+
 		for (hour = 0; hour < 8760; hour++)
 		{
 			// report progress updates to the caller	
@@ -1953,38 +2249,25 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 
 				double acpwr_gross = 0, ac_wiringloss = 0, transmissionloss = 0;
 				cur_load = p_load_full[idx];
-				wdprov->read(&Irradiance->weatherRecord);
-				weather_record wf = Irradiance->weatherRecord;
-
-				//set DC voltages for use in AC power calculation
-				for (size_t m = 0; m < PVSystem->Inverter->nMpptInputs; m++)
-				{
-					dcVoltagePerMppt[m] = PVSystem->p_mpptVoltage[m][idx];
-					dcPowerNetPerMppt_kW[m] = PVSystem->p_dcPowerNetPerMppt[m][idx] * util::watt_to_kilowatt;
-				}
 
 				//run AC power calculation
-				if (en_batt && (batt_topology == ChargeController::DC_CONNECTED)) // DC-connected battery
+				if (!inverterYearAtATime) // DC-connected battery
 				{
+					//DC batteries not allowed with multiple MPPT, so can just use MPPT 1's voltage
+					double dcVoltage = PVSystem->p_mpptVoltage[0][idx];
+
 					// Compute PV clipping before adding battery
-					sharedInverter->calculateACPower(dcPower_kW, dcVoltagePerMppt[0], wf.tdry); //DC batteries not allowed with multiple MPPT, so can just use MPPT 1's voltage
+					sharedInverter->calculateACPower(dcPower_kW, dcVoltage, yearTdry[idx - yearStart]);
 
 					// Run PV plus battery through sharedInverter, returns AC power
-					batt.advance(*this, dcPower_kW, dcVoltagePerMppt[0], cur_load, sharedInverter->powerClipLoss_kW);
+					batt.advance(*this, dcPower_kW, dcVoltage, cur_load, sharedInverter->powerClipLoss_kW);
 					acpwr_gross = batt.outGenPower[idx];
 				}
-				else if (PVSystem->Inverter->inverterType == INVERTER_PVYIELD) //PVyield inverter model not currently enabled for multiple MPPT
-				{
-					sharedInverter->calculateACPower(dcPower_kW, dcVoltagePerMppt[0], wf.tdry);
-					acpwr_gross = sharedInverter->powerAC_kW;
-				}
 				else
 				{
-					// inverter: runs at all hours of the day, even if no DC power.  important
-					// for capturing tare losses
-					sharedInverter->calculateACPower(dcPowerNetPerMppt_kW, dcVoltagePerMppt, wf.tdry);
+					sharedInverter->setTimestep(inverterYear, idx - yearStart);
 					acpwr_gross = sharedInverter->powerAC_kW;
-				}		
+				}
 				
 				ac_wiringloss = fabs(acpwr_gross) * PVSystem->acLossPercent * 0.01;
 				transmissionloss = fabs(acpwr_gross) * PVSystem->transmissionLossPercent * 0.01;
@@ -2133,6 +2416,11 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		if (Subarrays[0]->snowModel.badValues > 0){
 			log(util::format("The snow model has detected %d bad snow depth values (less than 0 or greater than 610 cm). These values have been set to zero.", Subarrays[0]->snowModel.badValues), SSC_WARNING);
 		}
+
+		size_t skippedSteps = 0;
+		for (size_t nn = 0; nn < num_subarrays; nn++)
+			skippedSteps += Subarrays[nn]->snowModel.skippedSteps;
+		log(util::format("The snow model skipped %d snow free subarray timesteps of %d.", (int)skippedSteps, (int)(num_subarrays * nrec * nyears)), SSC_NOTICE);
 			
 		// scale by ts_hour to convert power -> energy
 		accumulate_monthly_for_year( "dc_snow_loss", "monthly_snow_loss", ts_hour , step_per_hour );			
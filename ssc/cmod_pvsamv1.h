@@ -55,6 +55,7 @@
 #include <limits>
 #include <vector>
 #include <memory>
+#include <exception>
 
 #include "core.h"
 #include "common.h"
@@ -82,6 +83,144 @@
 // comment following define if do not want shading database validation outputs
 //#define SHADE_DB_OUTPUTS
 
+/**
+* Irradiance, shading and soiling results for one subarray at one timestep. These only depend on the weather and on the
+* subarray, so pvsamv1 computes them for a block of timesteps ahead of the module and inverter calculations, optionally
+* with the subarrays on separate threads, and then uses them in timestep and subarray order.
+*/
+struct subarray_irradiance
+{
+	struct message
+	{
+		std::string text;
+		int type;
+		float time;
+	};
+
+	subarray_irradiance() { reset(); }
+
+	/// Clear the results before the timestep is calculated
+	void reset()
+	{
+		active = false;
+		solazi = solzen = solalt = alb = sunPositionHour = 0;
+		sunup = 0;
+		for (int i = 0; i < 3; i++) {
+			irradianceCalculated[i] = 0;
+			irradianceCalculatedSet[i] = false;
+		}
+		ipoa = ipoaFront = ipoaRear = ipoaRearAfterLosses = 0;
+		poaFrontNominalW = poaFrontBeamNominalW = poaFrontShadedW = poaFrontShadedSoiledW = poaRearW = poaFrontBeamEffW = 0;
+		poaBeamFront = poaDiffuseFront = poaGroundFront = poaTotal = 0;
+		angleOfIncidenceDegrees = surfaceTiltDegrees = surfaceAzimuthDegrees = 0;
+		nonlinearDCShadingDerate = dcShadeFactor = 1;
+		usePOAFromWF = false;
+		messages.clear();
+		error = std::exception_ptr();
+	}
+
+	/// Keep a message to be logged when the results are used, so that messages stay in timestep order
+	void log(const std::string &text, int type = SSC_NOTICE, float time = -1)
+	{
+		message m;
+		m.text = text;
+		m.type = type;
+		m.time = time;
+		messages.push_back(m);
+	}
+
+	/// Set one of the calculated global, diffuse or beam irradiance outputs
+	void setIrradianceCalculated(int i, ssc_number_t value)
+	{
+		irradianceCalculated[i] = value;
+		irradianceCalculatedSet[i] = true;
+	}
+
+	bool active;						/// False if the subarray is disabled or has no strings
+	double solazi, solzen, solalt, alb;	/// Sun position [degrees] and albedo
+	int sunup;							/// Sun up flag as reported by irrad
+	double sunPositionHour;				/// Hour at which the sun position was calculated
+	ssc_number_t irradianceCalculated[3];	/// Calculated global, diffuse and beam irradiance [W/m2], year one only
+	bool irradianceCalculatedSet[3];
+	double ipoa, ipoaFront, ipoaRear, ipoaRearAfterLosses;	/// POA irradiance from the weather file, on the front, and on the rear [W/m2]
+	double poaFrontNominalW, poaFrontBeamNominalW, poaFrontShadedW, poaFrontShadedSoiledW, poaRearW, poaFrontBeamEffW; /// Contributions to the timestep totals for the system [W]
+	double poaBeamFront, poaDiffuseFront, poaGroundFront, poaTotal;	/// Irradiance inputs to the module model [W/m2]
+	double angleOfIncidenceDegrees, surfaceTiltDegrees, surfaceAzimuthDegrees;
+	double nonlinearDCShadingDerate;	/// DC derate from non-linear self-shading
+	double dcShadeFactor;				/// DC derate from the shading database
+	bool usePOAFromWF;
+	std::vector<message> messages;		/// Messages raised while calculating this timestep
+	std::exception_ptr error;			/// Set if the calculation failed at this timestep
+};
+
+/**
+* Year one irradiance inputs to the module model for one subarray, stored one array per field at full precision
+* so that later years give the same results as recalculating them.
+* Weather is reused each year of a lifetime simulation, so later years take these instead of recalculating the
+* sun position, plane-of-array irradiance, shading and soiling.
+*/
+struct subarray_irradiance_history
+{
+	void resize(size_t n)
+	{
+		std::vector<double> *fields[] = { &solzen, &ipoa, &ipoaFront, &ipoaRearAfterLosses, &poaBeamFront, &poaDiffuseFront, &poaGroundFront,
+			&poaTotal, &angleOfIncidenceDegrees, &surfaceTiltDegrees, &surfaceAzimuthDegrees, &nonlinearDCShadingDerate, &dcShadeFactor };
+		for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+			fields[i]->assign(n, 0);
+		sunup.assign(n, 0);
+		usePOAFromWF.assign(n, 0);
+	}
+
+	size_t size() const { return solzen.size(); }
+
+	void store(size_t i, const subarray_irradiance &r)
+	{
+		solzen[i] = r.solzen;
+		sunup[i] = (char)r.sunup;
+		ipoa[i] = r.ipoa;
+		ipoaFront[i] = r.ipoaFront;
+		ipoaRearAfterLosses[i] = r.ipoaRearAfterLosses;
+		poaBeamFront[i] = r.poaBeamFront;
+		poaDiffuseFront[i] = r.poaDiffuseFront;
+		poaGroundFront[i] = r.poaGroundFront;
+		poaTotal[i] = r.poaTotal;
+		angleOfIncidenceDegrees[i] = r.angleOfIncidenceDegrees;
+		surfaceTiltDegrees[i] = r.surfaceTiltDegrees;
+		surfaceAzimuthDegrees[i] = r.surfaceAzimuthDegrees;
+		nonlinearDCShadingDerate[i] = r.nonlinearDCShadingDerate;
+		dcShadeFactor[i] = r.dcShadeFactor;
+		usePOAFromWF[i] = r.usePOAFromWF ? 1 : 0;
+	}
+
+	/// Restore the results needed after year one, the year one only outputs are left at their reset values
+	void load(size_t i, subarray_irradiance &r) const
+	{
+		r.reset();
+		r.active = true;
+		r.solzen = solzen[i];
+		r.sunup = sunup[i];
+		r.ipoa = ipoa[i];
+		r.ipoaFront = ipoaFront[i];
+		r.ipoaRearAfterLosses = ipoaRearAfterLosses[i];
+		r.poaBeamFront = poaBeamFront[i];
+		r.poaDiffuseFront = poaDiffuseFront[i];
+		r.poaGroundFront = poaGroundFront[i];
+		r.poaTotal = poaTotal[i];
+		r.angleOfIncidenceDegrees = angleOfIncidenceDegrees[i];
+		r.surfaceTiltDegrees = surfaceTiltDegrees[i];
+		r.surfaceAzimuthDegrees = surfaceAzimuthDegrees[i];
+		r.nonlinearDCShadingDerate = nonlinearDCShadingDerate[i];
+		r.dcShadeFactor = dcShadeFactor[i];
+		r.usePOAFromWF = usePOAFromWF[i] != 0;
+	}
+
+	std::vector<double> solzen, ipoa, ipoaFront, ipoaRearAfterLosses;
+	std::vector<double> poaBeamFront, poaDiffuseFront, poaGroundFront, poaTotal;
+	std::vector<double> angleOfIncidenceDegrees, surfaceTiltDegrees, surfaceAzimuthDegrees;
+	std::vector<double> nonlinearDCShadingDerate, dcShadeFactor;
+	std::vector<char> sunup, usePOAFromWF;
+};
+
 /**
 * Detailed photovoltaic model in SAM, version 1
 * Contains calculations to process a weather file, parse the irradiance, and evaluate PV subarray power production with AC or DC connected batteries
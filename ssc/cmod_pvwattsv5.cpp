@@ -48,6 +48,10 @@
 *******************************************************************************************************/
 
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
 
 #include "core.h"
 
@@ -181,19 +185,30 @@ public:
 
 	void setup_system_inputs()
 	{
-		dc_nameplate = as_double("system_capacity")*1000;
-		dc_ac_ratio = as_double("dc_ac_ratio");
+		setup_system( as_double("system_capacity"), as_integer("module_type"),
+			as_double("dc_ac_ratio"), as_double("inv_eff"), as_double("losses"), as_integer("array_type"),
+			is_assigned("tilt") ? as_double("tilt") : std::numeric_limits<double>::quiet_NaN(),
+			is_assigned("azimuth") ? as_double("azimuth") : std::numeric_limits<double>::quiet_NaN(),
+			is_assigned("gcr") ? as_double("gcr") : std::numeric_limits<double>::quiet_NaN() );
+	}
+
+	// tilt, azimuth and gcr are NaN when not specified
+	void setup_system( double system_capacity_kw, int module_type_in, double dc_ac_ratio_in, double inv_eff_in,
+		double losses_in, int array_type_in, double tilt_in, double azimuth_in, double gcr_in )
+	{
+		dc_nameplate = system_capacity_kw*1000;
+		dc_ac_ratio = dc_ac_ratio_in;
 		ac_nameplate = dc_nameplate / dc_ac_ratio;
-		inv_eff_percent = as_double("inv_eff");
+		inv_eff_percent = inv_eff_in;
 		
-		loss_percent = as_double("losses");        
-		if(is_assigned("tilt")) tilt = as_double("tilt");
-		if (is_assigned("azimuth")) azimuth = as_double("azimuth");
+		loss_percent = losses_in;
+		if ( std::isfinite( tilt_in ) ) tilt = tilt_in;
+		if ( std::isfinite( azimuth_in ) ) azimuth = azimuth_in;
 
 		gamma = 0;
 		use_ar_glass = false;
 
-		module_type = as_integer("module_type");
+		module_type = module_type_in;
 		switch( module_type )
 		{
 		case 0: // standard module
@@ -208,7 +223,7 @@ public:
 		inoct = 45;
 		shade_mode_1x = 0; // self shaded
 		
-		array_type = as_integer("array_type"); // 0, 1, 2, 3, 4		
+		array_type = array_type_in; // 0, 1, 2, 3, 4		
 		switch( array_type )
 		{
 		case FIXED_OPEN_RACK: // fixed open rack
@@ -227,11 +242,12 @@ public:
 
 		
 		gcr = 0.4;
-		if ( track_mode == 1 && is_assigned("gcr") ) gcr = as_double("gcr");
+		if ( track_mode == 1 && std::isfinite( gcr_in ) ) gcr = gcr_in;
 	}
 
 	void initialize_cell_temp( double ts_hour, double last_tcell = -9999, double last_poa = -9999 )
 	{
+		if ( tccalc ) delete tccalc;
 		tccalc = new pvwatts_celltemp ( inoct+273.15, PVWATTS_HEIGHT, ts_hour );
 		if ( last_tcell > -99 && last_poa >= 0 )
 			tccalc->set_last_values( last_tcell, last_poa );
@@ -678,3 +694,537 @@ public:
 };
 
 DEFINE_MODULE_ENTRY( pvwattsv5_1ts, "pvwattsv5_1ts- single timestep calculation of PV system performance.", 1 )
+
+
+
+/* *****************************************************************************
+			MULTI-SITE BATCH VERSION
+ ***************************************************************************** */
+
+static var_info _cm_vtab_pvwattsv5_batch[] = {
+/*   VARTYPE           DATATYPE          NAME                         LABEL                                               UNITS        META                      GROUP          REQUIRED_IF                 CONSTRAINTS                      UI_HINTS*/
+	{ SSC_INPUT,        SSC_STRING,      "solar_resource_file",            "Weather file path",                           "",          "Used by all configurations",                   "Weather",     "?",                        "",                              "" },
+	{ SSC_INPUT,        SSC_STRING,      "solar_resource_files",           "Weather file paths",                          "",          "One per line, indexed from 0 by the configurations", "Weather", "?",                      "",                              "" },
+	{ SSC_INPUT,        SSC_MATRIX,      "configurations",                 "System configurations",                       "",          "One per row: weather file index,system_capacity,module_type,dc_ac_ratio,inv_eff,losses,array_type,tilt,azimuth,gcr", "PVWatts", "*", "",             "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "batch_threads",                  "Number of threads for the batch",             "",          "0=one per processor",        "PVWatts",      "?=0",                     "INTEGER,MIN=0",                            "" },
+
+	{ SSC_OUTPUT,       SSC_MATRIX,      "monthly_energy",                 "Monthly energy",                              "kWh",       "One row per configuration",  "Monthly",      "*",                       "",                                         "" },
+	{ SSC_OUTPUT,       SSC_ARRAY,       "solrad_annual",                  "Daily average solar irradiance",              "kWh/m2/day","One per configuration",      "Annual",       "*",                       "",                                         "" },
+	{ SSC_OUTPUT,       SSC_ARRAY,       "annual_energy",                  "Annual energy",                               "kWh",       "One per configuration",      "Annual",       "*",                       "",                                         "" },
+	{ SSC_OUTPUT,       SSC_ARRAY,       "capacity_factor",                "Capacity factor",                             "%",         "One per configuration",      "Annual",       "*",                       "",                                         "" },
+	{ SSC_OUTPUT,       SSC_ARRAY,       "kwh_per_kw",                     "First year kWh/kW",                           "",          "One per configuration",      "Annual",       "*",                       "",                                         "" },
+
+	var_info_invalid };
+
+enum pvwatts_batch_column { BATCH_FILE, BATCH_SYSTEM_CAPACITY, BATCH_MODULE_TYPE, BATCH_DC_AC_RATIO, BATCH_INV_EFF, BATCH_LOSSES,
+	BATCH_ARRAY_TYPE, BATCH_TILT, BATCH_AZIMUTH, BATCH_GCR, BATCH_NCOLS };
+
+// sun position for every record of a weather file, shared by the files with the same location and time stamps
+struct pvwatts_batch_sun
+{
+	double lat, lon, tz, delt;
+	std::vector<int> year, month, day, hour;
+	std::vector<double> minute;
+
+	std::vector<int> sunup;
+	std::vector<double> azimuth, zenith, hextra; // radians, as calculated by irrad
+
+	// the records with the sun up, and their sun position, for the calculation of all timesteps of a configuration at once
+	std::vector<size_t> daylight;
+	std::vector<double> day_azimuth, day_zenith, day_hextra;
+
+	bool same_times( const pvwatts_batch_sun &s ) const
+	{
+		return lat == s.lat && lon == s.lon && tz == s.tz && delt == s.delt
+			&& year == s.year && month == s.month && day == s.day && hour == s.hour && minute == s.minute;
+	}
+};
+
+class pvwatts_batch_sun_cache
+{
+	std::mutex m_mutex;
+	std::vector< std::weak_ptr<const pvwatts_batch_sun> > m_list;
+	size_t m_calculated;
+public:
+	pvwatts_batch_sun_cache() : m_calculated(0) { }
+
+	size_t calculated() { return m_calculated; }
+
+	// returns the sun position for the location and time stamps in sun, calculating it if no other file has them
+	std::shared_ptr<const pvwatts_batch_sun> get( std::unique_ptr<pvwatts_batch_sun> sun, std::string &err )
+	{
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			for ( size_t i=0;i<m_list.size();i++ )
+			{
+				std::shared_ptr<const pvwatts_batch_sun> s = m_list[i].lock();
+				if ( s && s->same_times( *sun ) )
+					return s;
+			}
+		}
+
+		// calculated outside the lock so that files at different locations are processed in parallel
+		size_t n = sun->year.size();
+		for ( size_t i=0;i<n;i++ )
+		{
+			// time stamps and location are checked as irrad::calc does
+			irrad irr;
+			irr.set_time( sun->year[i], sun->month[i], sun->day[i], sun->hour[i], sun->minute[i], sun->delt );
+			irr.set_location( sun->lat, sun->lon, sun->tz );
+			irr.set_sky_model( 2, 0.2 );
+			irr.set_beam_diffuse( 0, 0 );
+			irr.set_surface( 0, 0, 180, 45.0, false, 0.4 );
+
+			int code = irr.check();
+			if ( code < 0 )
+			{
+				err = util::format( "failed to process irradiation on surface (code: %d) [y:%d m:%d d:%d h:%d]",
+					-100+code, sun->year[i], sun->month[i], sun->day[i], sun->hour[i] );
+				return std::shared_ptr<const pvwatts_batch_sun>();
+			}
+		}
+
+		sun->sunup.resize( n );
+		sun->azimuth.resize( n );
+		sun->zenith.resize( n );
+		sun->hextra.resize( n );
+		if ( n > 0 )
+		{
+			int *tsp[3] = { 0, 0, &sun->sunup[0] };
+			double *sunn[9] = { &sun->azimuth[0], &sun->zenith[0], 0, 0, 0, 0, 0, 0, &sun->hextra[0] };
+			solarpos_timestep_array( n, &sun->year[0], &sun->month[0], &sun->day[0], &sun->hour[0], &sun->minute[0],
+				sun->delt, sun->lat, sun->lon, sun->tz, tsp, sunn );
+		}
+
+		for ( size_t i=0;i<n;i++ )
+		{
+			if ( sun->sunup[i] > 0 )
+			{
+				sun->daylight.push_back( i );
+				sun->day_azimuth.push_back( sun->azimuth[i] );
+				sun->day_zenith.push_back( sun->zenith[i] );
+				sun->day_hextra.push_back( sun->hextra[i] );
+			}
+		}
+
+		std::shared_ptr<const pvwatts_batch_sun> s( sun.release() );
+		std::lock_guard<std::mutex> lock( m_mutex );
+		for ( size_t i=0;i<m_list.size();i++ )
+		{
+			if ( m_list[i].expired() )
+			{
+				m_list[i] = m_list.back();
+				m_list.pop_back();
+				i--;
+			}
+		}
+		m_list.push_back( s );
+		m_calculated++;
+		return s;
+	}
+};
+
+// weather data of one file, kept while configurations that use it are being run
+struct pvwatts_batch_weather
+{
+	size_t step_per_hour;
+	std::vector<double> dn, df, alb, wspd, tdry;
+	std::vector<double> day_dn, day_df, day_alb; // at the daylight records of sun
+	std::shared_ptr<const pvwatts_batch_sun> sun;
+};
+
+struct pvwatts_batch_file
+{
+	std::string path;
+	std::mutex mutex;
+	bool loaded;
+	std::shared_ptr<const pvwatts_batch_weather> weather;
+	std::atomic<size_t> remaining; // configurations still to be run with this file
+	std::string error;
+	std::vector<std::string> notices;
+
+	pvwatts_batch_file() : loaded(false), remaining(0) { }
+
+	// reads the file the way pvwattsv5 does, returns false and sets the error on failure
+	bool load( pvwatts_batch_sun_cache &suns )
+	{
+		weatherfile wfile( path );
+		if ( !wfile.ok() ) { error = wfile.message(); return false; }
+		if ( wfile.has_message() ) notices.push_back( wfile.message() );
+
+		double delt = IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET; // instantaneous values
+		if ( !wfile.has_data_column( weather_data_provider::MINUTE ) )
+		{
+			if ( wfile.nrecords() != 8760 ) { error = "subhourly weather files must specify the minute for each record"; return false; }
+			delt = 1.0; // hourly averages, with the sun position at the middle of sunrise and sunset hours
+		}
+
+		size_t nrec = wfile.nrecords();
+		size_t step_per_hour = nrec/8760;
+		if ( step_per_hour < 1 || step_per_hour > 60 || step_per_hour*8760 != nrec )
+		{
+			error = util::format( "invalid number of data records (%d): must be an integer multiple of 8760", (int)nrec );
+			return false;
+		}
+		if ( delt > 0 ) delt = 1.0/step_per_hour;
+
+		weather_header hdr;
+		wfile.header( &hdr );
+
+		std::unique_ptr<pvwatts_batch_sun> sun( new pvwatts_batch_sun );
+		sun->lat = hdr.lat;
+		sun->lon = hdr.lon;
+		sun->tz = hdr.tz;
+		sun->delt = delt;
+
+		std::shared_ptr<pvwatts_batch_weather> w( new pvwatts_batch_weather );
+		w->step_per_hour = step_per_hour;
+
+		weather_record wf;
+		for ( size_t i=0;i<nrec;i++ )
+		{
+			if ( !wfile.read( &wf ) )
+			{
+				error = util::format( "could not read data line %d of %d in weather file", (int)(i+1), (int)nrec );
+				return false;
+			}
+
+			// the same limits as irrad::check, which are not checked again when the sun position is shared
+			if ( wf.dn < 0 || wf.dn > irrad::irradiationMax || wf.df < 0 || wf.df > 1500 )
+			{
+				error = util::format( "failed to process irradiation on surface (code: %d) [y:%d m:%d d:%d h:%d]",
+					-105, wf.year, wf.month, wf.day, wf.hour );
+				return false;
+			}
+
+			double alb = 0.2; // do not increase albedo if snow exists in TMY2			
+			if ( std::isfinite( wf.alb ) && wf.alb > 0 && wf.alb < 1 )
+				alb = wf.alb;
+
+			sun->year.push_back( wf.year );
+			sun->month.push_back( wf.month );
+			sun->day.push_back( wf.day );
+			sun->hour.push_back( wf.hour );
+			sun->minute.push_back( wf.minute );
+			w->dn.push_back( wf.dn );
+			w->df.push_back( wf.df );
+			w->alb.push_back( alb );
+			w->wspd.push_back( wf.wspd );
+			w->tdry.push_back( wf.tdry );
+		}
+
+		w->sun = suns.get( std::move( sun ), error );
+		if ( !w->sun ) return false;
+
+		size_t nexceeded = 0;
+		for ( size_t i=0;i<nrec;i++ )
+			if ( w->sun->sunup[i] > 0 && w->dn[i]*cos( w->sun->zenith[i] ) > w->sun->hextra[i] )
+				nexceeded++;
+		if ( nexceeded > 0 )
+			notices.push_back( util::format( "beam irradiance exceeded extraterrestrial value at %d records", (int)nexceeded ) );
+
+		for ( size_t j=0;j<w->sun->daylight.size();j++ )
+		{
+			size_t i = w->sun->daylight[j];
+			w->day_dn.push_back( w->dn[i] );
+			w->day_df.push_back( w->df[i] );
+			w->day_alb.push_back( w->alb[i] );
+		}
+
+		weather = w;
+		return true;
+	}
+};
+
+// runs one configuration at a time with weather and sun position from a pvwatts_batch_file,
+// each thread of the batch has its own so that the calculation state is not shared
+class pvwattsv5_batch_system : public cm_pvwattsv5_base
+{
+	// surface angles and plane-of-array irradiance at the daylight records, reused between configurations
+	std::vector<double> m_angle[5], m_poa[3];
+
+public:
+	void exec( ) throw( general_error ) { }
+
+	struct results
+	{
+		ssc_number_t monthly_energy[12];
+		ssc_number_t solrad_annual, annual_energy, capacity_factor, kwh_per_kw;
+	};
+
+	// follows cm_pvwattsv5::exec without shading and adjustment factors, the calculation of irrad::calc
+	// for beam and diffuse inputs with the Perez sky model is done here with the shared sun position,
+	// for all daylight records of the year before the timestep loop
+	void simulate( const ssc_number_t *config, const pvwatts_batch_weather &w, results &r )
+	{
+		setup_system( config[BATCH_SYSTEM_CAPACITY], (int)config[BATCH_MODULE_TYPE], config[BATCH_DC_AC_RATIO],
+			config[BATCH_INV_EFF], config[BATCH_LOSSES], (int)config[BATCH_ARRAY_TYPE],
+			config[BATCH_TILT], config[BATCH_AZIMUTH], config[BATCH_GCR] );
+
+		double ts_hour = 1.0/w.step_per_hour;
+		initialize_cell_temp( ts_hour );
+
+		const pvwatts_batch_sun &sun = *w.sun;
+		size_t nday = sun.daylight.size();
+		double *angle[5] = { 0, 0, 0, 0, 0 }, *poa_front[3] = { 0, 0, 0 };
+		if ( nday > 0 )
+		{
+			for ( int k=0;k<5;k++ )
+			{
+				m_angle[k].resize( nday );
+				angle[k] = &m_angle[k][0];
+			}
+			for ( int k=0;k<3;k++ )
+			{
+				m_poa[k].resize( nday );
+				poa_front[k] = &m_poa[k][0];
+			}
+			incidence_array( track_mode, tilt, azimuth, 45.0, nday, &sun.day_zenith[0], &sun.day_azimuth[0], shade_mode_1x == 1, gcr, angle );
+			skymodel_array( 2, nday, &sun.day_hextra[0], &w.day_dn[0], &w.day_df[0], &w.day_alb[0], angle[0], angle[1], &sun.day_zenith[0], poa_front, 0 );
+		}
+
+		size_t j = 0; // daylight record
+		double annual_kwh = 0;
+		ssc_number_t solrad_ann = 0;
+		size_t idx = 0;
+		for ( int m=0;m<12;m++ )
+		{
+			ssc_number_t gen_month = 0, poa_month = 0;
+			for ( size_t k=0;k<util::nday[m]*24*w.step_per_hour;k++ )
+			{
+				sunup = sun.sunup[idx];
+				if ( sunup > 0 )
+				{
+					solazi = sun.azimuth[idx] * (180/M_PI);
+					solzen = sun.zenith[idx] * (180/M_PI);
+					aoi = angle[0][j] * (180/M_PI);
+					stilt = angle[1][j] * (180/M_PI);
+					sazi = angle[2][j] * (180/M_PI);
+					rot = angle[3][j] * (180/M_PI);
+					btd = angle[4][j] * (180/M_PI);
+
+					ibeam = iskydiff = ignddiff = 0;
+					if ( w.dn[idx]*cos( sun.zenith[idx] ) <= sun.hextra[idx] )
+					{
+						ibeam = poa_front[0][j];
+						iskydiff = poa_front[1][j];
+						ignddiff = poa_front[2][j];
+					}
+					j++;
+
+					double shad_beam = 1.0;
+					powerout( (double)idx, shad_beam, 1.0, w.dn[idx], w.alb[idx], w.wspd[idx], w.tdry[idx] );
+
+					ssc_number_t gen = (ssc_number_t)(ac * 0.001f); // W to kW
+					gen_month += gen;
+					poa_month += (ssc_number_t)poa;
+					annual_kwh += gen;
+				}
+				idx++;
+			}
+
+			r.monthly_energy[m] = gen_month * (ssc_number_t)ts_hour;
+			ssc_number_t solrad = poa_month * (ssc_number_t)(0.001*ts_hour) / util::nday[m];
+			solrad_ann += solrad;
+		}
+
+		r.solrad_annual = solrad_ann/12;
+		r.annual_energy = (ssc_number_t)(annual_kwh*ts_hour);
+
+		double kWhperkW = 1000.0*annual_kwh / dc_nameplate;
+		kWhperkW *= ts_hour;
+		r.capacity_factor = (ssc_number_t)(kWhperkW / 87.6);
+		r.kwh_per_kw = (ssc_number_t)kWhperkW;
+	}
+};
+
+class cm_pvwattsv5_batch : public compute_module
+{
+public:
+	
+	cm_pvwattsv5_batch()
+	{
+		add_var_info( _cm_vtab_pvwattsv5_batch );
+	}
+
+	void exec( ) throw( general_error )
+	{
+		std::vector<std::string> paths;
+		if ( is_assigned( "solar_resource_files" ) )
+			paths = util::split( as_string("solar_resource_files"), "\r\n" );
+		else if ( is_assigned( "solar_resource_file" ) )
+			paths.push_back( as_string("solar_resource_file") );
+		if ( paths.size() < 1 )
+			throw exec_error("pvwattsv5_batch", "no weather files supplied");
+
+		size_t nconfig = 0, ncols = 0;
+		ssc_number_t *configs = as_matrix( "configurations", &nconfig, &ncols );
+		if ( ncols != BATCH_NCOLS )
+			throw exec_error("pvwattsv5_batch", util::format("configurations must have %d columns", (int)BATCH_NCOLS));
+
+		std::vector<pvwatts_batch_file> files( paths.size() );
+		for ( size_t f=0;f<paths.size();f++ )
+			files[f].path = paths[f];
+
+		for ( size_t i=0;i<nconfig;i++ )
+		{
+			const ssc_number_t *c = configs + i*ncols;
+			std::string err;
+			if ( c[BATCH_FILE] < 0 || c[BATCH_FILE] >= paths.size() || c[BATCH_FILE] != (int)c[BATCH_FILE] ) err = "weather file index is not valid";
+			else if ( c[BATCH_SYSTEM_CAPACITY] <= 0 ) err = "system_capacity must be positive";
+			else if ( c[BATCH_MODULE_TYPE] < 0 || c[BATCH_MODULE_TYPE] > 2 || c[BATCH_MODULE_TYPE] != (int)c[BATCH_MODULE_TYPE] ) err = "module_type must be 0, 1 or 2";
+			else if ( c[BATCH_DC_AC_RATIO] <= 0 ) err = "dc_ac_ratio must be positive";
+			else if ( c[BATCH_INV_EFF] < 90 || c[BATCH_INV_EFF] > 99.5 ) err = "inv_eff must be between 90 and 99.5";
+			else if ( c[BATCH_LOSSES] < -5 || c[BATCH_LOSSES] > 99 ) err = "losses must be between -5 and 99";
+			else if ( c[BATCH_ARRAY_TYPE] < 0 || c[BATCH_ARRAY_TYPE] > 4 || c[BATCH_ARRAY_TYPE] != (int)c[BATCH_ARRAY_TYPE] ) err = "array_type must be 0 to 4";
+			else if ( c[BATCH_TILT] < 0 || c[BATCH_TILT] > 90 ) err = "tilt must be between 0 and 90";
+			else if ( c[BATCH_AZIMUTH] < 0 || c[BATCH_AZIMUTH] >= 360 ) err = "azimuth must be at least 0 and less than 360";
+			else if ( c[BATCH_GCR] <= 0 || c[BATCH_GCR] > 3 ) err = "gcr must be positive and at most 3";
+			if ( !err.empty() )
+				throw exec_error("pvwattsv5_batch", util::format("configuration %d: ", (int)i) + err );
+
+			files[(size_t)c[BATCH_FILE]].remaining++;
+		}
+
+		ssc_number_t *p_monthly = allocate( "monthly_energy", nconfig, 12 );
+		ssc_number_t *p_solrad = allocate( "solrad_annual", nconfig );
+		ssc_number_t *p_annual = allocate( "annual_energy", nconfig );
+		ssc_number_t *p_cf = allocate( "capacity_factor", nconfig );
+		ssc_number_t *p_kwhperkw = allocate( "kwh_per_kw", nconfig );
+
+		// configurations are run in weather file order, so each file is read once and
+		// released when its last configuration is done
+		std::vector<size_t> order( nconfig );
+		for ( size_t i=0;i<nconfig;i++ )
+			order[i] = i;
+		std::stable_sort( order.begin(), order.end(), [&]( size_t a, size_t b ) {
+			return configs[a*ncols + BATCH_FILE] < configs[b*ncols + BATCH_FILE]; } );
+
+		size_t nthreads = (size_t)as_integer("batch_threads");
+		if ( nthreads < 1 ) nthreads = (size_t)std::thread::hardware_concurrency();
+		if ( nthreads > nconfig ) nthreads = nconfig;
+		if ( nthreads < 1 ) nthreads = 1;
+
+		pvwatts_batch_sun_cache suns;
+		std::vector< std::vector<log_item> > messages( nconfig );
+		std::atomic<size_t> next(0), ndone(0);
+		std::atomic<bool> stop(false);
+		bool canceled = false;
+		std::mutex error_mutex;
+		std::string error;
+
+		auto worker = [&]( bool calling_thread )
+		{
+			pvwattsv5_batch_system system;
+			size_t k, nupdate = 0, nlog = 0;
+			while ( !stop && (k = next++) < nconfig )
+			{
+				size_t i = order[k];
+				pvwatts_batch_file &file = files[(size_t)configs[i*ncols + BATCH_FILE]];
+
+				std::shared_ptr<const pvwatts_batch_weather> weather;
+				{
+					std::lock_guard<std::mutex> lock( file.mutex );
+					if ( !file.loaded )
+					{
+						file.loaded = true;
+
+						// the weather file reader throws on some malformed values, which must not leave the thread
+						bool ok = false;
+						try {
+							ok = file.load( suns );
+						}
+						catch ( general_error &e ) {
+							file.error = e.err_text;
+						}
+						catch ( std::exception &e ) {
+							file.error = std::string("could not read weather file: ") + e.what();
+						}
+						if ( !ok )
+						{
+							file.weather.reset();
+							file.error = file.path + ": " + file.error;
+						}
+					}
+					weather = file.weather;
+				}
+				if ( !weather ) { stop = true; break; } // the load error is reported below
+
+				try {
+					pvwattsv5_batch_system::results r;
+					system.simulate( configs + i*ncols, *weather, r );
+					for ( int m=0;m<12;m++ )
+						p_monthly[i*12 + m] = r.monthly_energy[m];
+					p_solrad[i] = r.solrad_annual;
+					p_annual[i] = r.annual_energy;
+					p_cf[i] = r.capacity_factor;
+					p_kwhperkw[i] = r.kwh_per_kw;
+
+					while ( log_item *item = system.log( (int)nlog ) )
+					{
+						messages[i].push_back( *item );
+						nlog++;
+					}
+				}
+				catch ( std::exception &e ) {
+					std::lock_guard<std::mutex> lock( error_mutex );
+					if ( error.empty() ) error = util::format("configuration %d: ", (int)i) + e.what();
+					stop = true;
+				}
+
+				weather.reset();
+				if ( --file.remaining == 0 )
+				{
+					std::lock_guard<std::mutex> lock( file.mutex );
+					file.weather.reset();
+				}
+
+				size_t done = ++ndone;
+				if ( calling_thread && done >= nupdate )
+				{
+					nupdate = done + std::max( (size_t)1, nconfig/50 );
+					if ( !update( "", 100.0f*done/nconfig ) )
+					{
+						canceled = true;
+						stop = true;
+					}
+				}
+			}
+		};
+
+		std::vector<std::thread> pool;
+		for ( size_t t=1;t<nthreads;t++ )
+			pool.push_back( std::thread( worker, false ) );
+
+		worker( true ); // the calling thread runs configurations too
+
+		for ( size_t t=0;t<pool.size();t++ )
+			pool[t].join();
+
+		if ( canceled )
+			throw exec_error("pvwattsv5_batch", util::format("simulation canceled after %d of %d configurations", (int)ndone, (int)nconfig));
+
+		for ( size_t f=0;f<files.size();f++ )
+		{
+			if ( !files[f].error.empty() )
+				throw exec_error("pvwattsv5_batch", files[f].error);
+			for ( size_t j=0;j<files[f].notices.size();j++ )
+				log( files[f].path + ": " + files[f].notices[j], SSC_NOTICE );
+		}
+
+		if ( !error.empty() )
+			throw exec_error("pvwattsv5_batch", error);
+
+		for ( size_t i=0;i<nconfig;i++ )
+			for ( size_t j=0;j<messages[i].size();j++ )
+				log( util::format("configuration %d: ", (int)i) + messages[i][j].text, messages[i][j].type );
+
+		size_t nloaded = 0;
+		for ( size_t f=0;f<files.size();f++ )
+			if ( files[f].loaded ) nloaded++;
+		log( util::format("%d configurations run with %d weather files on %d threads, sun position calculated for %d locations",
+			(int)nconfig, (int)nloaded, (int)nthreads, (int)suns.calculated()), SSC_NOTICE );
+	}
+};
+
+DEFINE_MODULE_ENTRY( pvwattsv5_batch, "PVWatts V5 - batch of system configurations over one or more weather files.", 1 )
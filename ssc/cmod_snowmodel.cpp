@@ -53,6 +53,7 @@
 #include <iostream>
 #include <cmath>
 #include <string>
+#include <vector>
 
 /**********************************************************************************
 ************************************************************************************
@@ -119,7 +120,7 @@ public:
 		// Define Input Arrays and variables
 		//ssc_number_t *poa  = as_array( "subarray1_poa_eff_beam", &num_steps );	// Plane of array Irradiance
 		ssc_number_t *poa  = as_array( "subarray1_poa_shaded", &num_steps );	// Plane of array Irradiance
-		ssc_number_t *wSpd = as_array( "wspd", &num_steps );					// Wind Speed
+		as_array( "wspd", &num_steps );											// Wind Speed (not used by the model)
 		ssc_number_t *hrEn = as_array( "hourly_gen", &num_steps );			// Hourly Energy
 		ssc_number_t *tAmb = as_array( "tdry", &num_steps );					// Ambient Temperature
 		ssc_number_t *tilt = as_array( "subarray1_surf_tilt", &num_steps );		// Surface Tilt
@@ -142,22 +143,32 @@ public:
 			}	
 		}
 
-		float loss; 
+		std::vector<int> sunupFlag(8760);
+		for (int i = 0; i < 8760; i++)
+			sunupFlag[i] = (int)sunup[i];
 
-		for (int i = 0; i < 8760; i++){
-			if (!snowModule.getLoss(poa[i], tilt[i], wSpd[i], tAmb[i], sDep[i], (int)sunup[i], 1.0, loss)){
+		// snow free spans are skipped, the model stops at each bad snow depth value so that it can be reported
+		std::vector<float> loss(8760, 0.0f);
+		size_t i = 0;
+		while (i < 8760){
+			size_t nDone = 0;
+			if (!snowModule.getLosses(8760 - i, poa + i, tilt + i, tAmb + i, sDep + i, &sunupFlag[i], 1.0, &loss[i], nDone)){
 				if (snowModule.good) log(snowModule.msg, SSC_WARNING);
 				else{
 					log(snowModule.msg, SSC_ERROR);
 					return;
 				}
 			}
+			i += nDone;
+		}
 
+		for (i = 0; i < 8760; i++){
 			hrEn_b4Snow[i] = hrEn[i]; 
-			hrEn[i] = hrEn[i] * (1 - loss);
-
+			hrEn[i] = hrEn[i] * (1 - loss[i]);
 		}
 
+		log(util::format("The snow model skipped %d snow free hours of 8760.", (int)snowModule.skippedSteps), SSC_NOTICE);
+
 		// accumulate monthly and annual values
 
 		accumulate_annual("hourly_energy_before_snow", "annual_energy_before_snow");
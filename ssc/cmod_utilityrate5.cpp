@@ -762,6 +762,8 @@ public:
 		bool timestep_reconciliation = (metering_option == 2 || metering_option == 3 || metering_option == 4);
 
 
+		bool use_lifetime = (as_integer("system_use_lifetime_output") == 1);
+
 		idx = 0;
 		for (i=0;i<nyears;i++)
 		{
@@ -794,7 +796,7 @@ public:
 
 
 				// update e_sys per year if lifetime output
-				if ((as_integer("system_use_lifetime_output") == 1) && ( idx < nrec_gen ))
+				if (use_lifetime && ( idx < nrec_gen ))
 				{
 //					e_sys[j] = p_sys[j] = 0.0;
 //					ts_power = (idx < nrec_gen) ? pgen[idx] : 0;
@@ -532,6 +532,10 @@ bool shading_factor_calculator::setup( compute_module *cm, const std::string &pr
 				for (size_t r = 0; r < nrows; r++)
 					for (size_t c = 0; c < ncols; c++)
 						m_beamFactors.at(r, c) = mat[r*ncols + c]; //entered in % shaded 
+				// the string case in the database depends only on the shading inputs, so find it once per row
+				m_dbCases.resize(nrows);
+				for (size_t r = 0; r < nrows; r++)
+					m_dbCases[r] = ShadeDB8_mpp::get_string_case(&m_beamFactors.at(r, 0), ncols);
 			}
 			else if (m_string_option == 1) // use average of all strings in column zero
 			{
@@ -645,6 +649,7 @@ bool shading_factor_calculator::setup( compute_module *cm, const std::string &pr
 					m_azaltvals.at(r, c) = 1 - mat[r*ncols + c] / 100; //all other entries must be converted from % to factor
 			}
 		}
+		m_azaltTable.set(m_azaltvals);
 		m_enAzAlt = true;
 	}
 
@@ -693,7 +698,7 @@ bool shading_factor_calculator::fbeam(size_t hour, double solalt, double solazi,
 			factor *= m_mxhFactors(irow, 0);
 		// apply azi alt shading factor
 		if (m_enAzAlt)
-			factor *= util::bilinear(solalt, solazi, m_azaltvals);
+			factor *= m_azaltTable(solalt, solazi);
 
 		m_beam_shade_factor = factor;
 
@@ -711,16 +716,15 @@ bool shading_factor_calculator::fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t
 	size_t irow = get_row_index_for_input(hour, hour_step, steps_per_hour);
 	if (irow < m_beamFactors.nrows())
 	{
-		std::vector<double> shad_fracs;
-		for (size_t icol = 0; icol < m_beamFactors.ncols(); icol++)
-			shad_fracs.push_back(m_beamFactors.at(irow, icol));
-		dc_factor = 1.0 - p_shadedb->get_shade_loss(gpoa, dpoa, shad_fracs, true, pv_cell_temp, mods_per_str, str_vmp_stc, mppt_lo, mppt_hi);
+		ShadeDB8_mpp::string_case sc = (irow < m_dbCases.size()) ? m_dbCases[irow]
+			: ShadeDB8_mpp::get_string_case(&m_beamFactors.at(irow, 0), m_beamFactors.ncols());
+		dc_factor = 1.0 - p_shadedb->get_shade_loss(gpoa, dpoa, sc, true, pv_cell_temp, mods_per_str, str_vmp_stc, mppt_lo, mppt_hi);
 		// apply mxh factor
 		if (m_enMxH && (irow < m_mxhFactors.nrows()))
 			beam_factor *= m_mxhFactors(irow, 0);
 		// apply azi alt shading factor
 		if (m_enAzAlt)
-			beam_factor *= util::bilinear(solalt, solazi, m_azaltvals);
+			beam_factor *= m_azaltTable(solalt, solazi);
 
 		m_dc_shade_factor = dc_factor;
 		m_beam_shade_factor = beam_factor;
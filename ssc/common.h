@@ -101,6 +101,7 @@ class shading_factor_calculator
 {
 	std::vector<std::string> m_errors;
 	util::matrix_t<double> m_azaltvals;
+	util::bilinear_table m_azaltTable; // m_azaltvals with its axes indexed for lookup
 	bool m_enAzAlt;
 	double m_diffFactor;
 
@@ -115,6 +116,7 @@ class shading_factor_calculator
 	int m_steps_per_hour;
 	bool m_enTimestep;
 	util::matrix_t<double> m_beamFactors;
+	std::vector<ShadeDB8_mpp::string_case> m_dbCases; // database string case for each row of m_beamFactors when m_string_option = 0
 	bool m_enMxH;
 	util::matrix_t<double> m_mxhFactors;
 
@@ -282,6 +282,12 @@ var_data *compute_module::assign( const std::string &name, const var_data &value
 	return m_vartab->assign( name, value );
 }
 
+var_data *compute_module::assign( const std::string &name, var_data &&value ) throw( general_error )
+{
+	if (!m_vartab) throw general_error("invalid data container object reference");
+	return m_vartab->assign( name, std::move(value) );
+}
+
 ssc_number_t *compute_module::allocate( const std::string &name, size_t length ) throw( general_error )
 {
 	var_data *v = assign(name, var_data());
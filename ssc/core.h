@@ -252,11 +252,15 @@ protected:
 
 
 public:
-	/* for working with input/output/inout variables during 'compute'*/
+	/* for working with input/output/inout variables during 'compute'.
+	   the var_data* returned by lookup() and assign() is stable, so code that reads a
+	   variable inside a timestep loop can resolve it once before the loop and use the
+	   pointer directly instead of looking the name up on every iteration */
 	const var_info &info( const std::string &name ) throw( general_error );
 	bool is_ssc_array_output( const std::string &name ) throw( general_error );
 	var_data *lookup( const std::string &name ) throw( general_error );
 	var_data *assign( const std::string &name, const var_data &value ) throw( general_error );
+	var_data *assign( const std::string &name, var_data &&value ) throw( general_error );
 	ssc_number_t *allocate( const std::string &name, size_t length ) throw( general_error );
 	ssc_number_t *allocate( const std::string &name, size_t nrows, size_t ncols ) throw( general_error );
 	util::matrix_t<ssc_number_t>& allocate_matrix( const std::string &name, size_t nrows, size_t ncols ) throw( general_error );
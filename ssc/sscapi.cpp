@@ -50,6 +50,8 @@
 #include <stdio.h>
 #include <cstring>
 #include <iostream>
+#include <thread>
+#include <atomic>
 
 #include "core.h"
 #include "sscapi.h"
@@ -87,6 +89,7 @@ extern module_entry_info
 	cm_entry_pvwattsv5,
 	cm_entry_pvwattsv5_lifetime,
 	cm_entry_pvwattsv5_1ts,
+	cm_entry_pvwattsv5_batch,
 	cm_entry_pv6parmod,
 	cm_entry_pvsandiainv,
 	cm_entry_wfreader,
@@ -174,6 +177,7 @@ static module_entry_info *module_table[] = {
 	&cm_entry_pvwattsv5,
 	&cm_entry_pvwattsv5_lifetime,
 	&cm_entry_pvwattsv5_1ts,
+	&cm_entry_pvwattsv5_batch,
 	&cm_entry_pvsandiainv,
 	&cm_entry_wfreader,
 	&cm_entry_irradproc,
@@ -353,6 +357,45 @@ SSCEXPORT void ssc_data_set_matrix( ssc_data_t p_data, const char *name, ssc_num
 	vt->assign( name, var_data(pvalues, nrows, ncols) );
 }
 
+SSCEXPORT ssc_number_t *ssc_number_alloc( int count )
+{
+	if (count < 1) return 0;
+	return util::matrix_t<ssc_number_t>::allocate( (size_t)count );
+}
+
+SSCEXPORT void ssc_number_free( ssc_number_t *pvalues )
+{
+	if (pvalues) util::matrix_t<ssc_number_t>::deallocate( pvalues );
+}
+
+SSCEXPORT void ssc_data_adopt_array( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int length )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt || !pvalues || length < 1)
+	{
+		// ownership passes with the call, so free a buffer that can't be stored
+		ssc_number_free( pvalues );
+		return;
+	}
+	util::matrix_t<ssc_number_t> values;
+	values.adopt( pvalues, 1, (size_t)length );
+	vt->assign( name, var_data( std::move(values), SSC_ARRAY ) );
+}
+
+SSCEXPORT void ssc_data_adopt_matrix( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int nrows, int ncols )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt || !pvalues || nrows < 1 || ncols < 1)
+	{
+		// ownership passes with the call, so free a buffer that can't be stored
+		ssc_number_free( pvalues );
+		return;
+	}
+	util::matrix_t<ssc_number_t> values;
+	values.adopt( pvalues, (size_t)nrows, (size_t)ncols );
+	vt->assign( name, var_data( std::move(values), SSC_MATRIX ) );
+}
+
 SSCEXPORT void ssc_data_set_table( ssc_data_t p_data, const char *name, ssc_data_t table )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
@@ -404,6 +447,50 @@ SSCEXPORT ssc_number_t *ssc_data_get_matrix( ssc_data_t p_data, const char *name
 	return dat->num.data();
 }
 
+SSCEXPORT ssc_number_t *ssc_data_take_array( ssc_data_t p_data, const char *name, int *length )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt) return 0;
+	var_data *dat = vt->lookup(name);
+	if (!dat || dat->type != SSC_ARRAY) return 0;
+	if (length) *length = (int) dat->num.length();
+	ssc_number_t *p = dat->num.release();
+	vt->unassign( name );
+	return p;
+}
+
+SSCEXPORT ssc_number_t *ssc_data_take_matrix( ssc_data_t p_data, const char *name, int *nrows, int *ncols )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt) return 0;
+	var_data *dat = vt->lookup(name);
+	if (!dat || dat->type != SSC_MATRIX) return 0;
+	if (nrows) *nrows = (int) dat->num.nrows();
+	if (ncols) *ncols = (int) dat->num.ncols();
+	ssc_number_t *p = dat->num.release();
+	vt->unassign( name );
+	return p;
+}
+
+SSCEXPORT ssc_bool_t ssc_data_write( ssc_data_t p_data, const char *file )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt || !file) return 0;
+	return vt->write_binary( file ) ? 1 : 0;
+}
+
+SSCEXPORT ssc_data_t ssc_data_read_mmap( const char *file )
+{
+	if (!file) return 0;
+	var_table *vt = new var_table;
+	if ( !vt->read_binary( file ) )
+	{
+		delete vt;
+		return 0;
+	}
+	return static_cast<ssc_data_t>( vt );
+}
+
 SSCEXPORT ssc_data_t ssc_data_get_table( ssc_data_t p_data, const char *name )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
@@ -604,13 +691,55 @@ static char p_internal_buf[256];
 	return result ? 0 : p_internal_buf;
 }
 
-static int sg_defaultPrint = 1;
+// read by every call to ssc_module_exec, possibly from several threads at once
+static std::atomic<int> sg_defaultPrint(1);
 
 SSCEXPORT void ssc_module_exec_set_print( int print )
 {
 	sg_defaultPrint = print;
 }
 
+SSCEXPORT int ssc_module_exec_batch( const char *name, ssc_data_t *p_data, int count, int nthreads, ssc_bool_t *results )
+{
+	// check the module name once, before any workers are started
+	ssc_module_t p_mod = ssc_module_create( name );
+	if ( !p_mod ) return -1;
+	ssc_module_free( p_mod );
+
+	if ( count < 0 || ( count > 0 && !p_data ) ) return -1;
+	if ( count == 0 ) return 0;
+
+	if ( nthreads < 1 ) nthreads = (int)std::thread::hardware_concurrency();
+	if ( nthreads < 1 ) nthreads = 1;
+	if ( nthreads > count ) nthreads = count;
+
+	// workers pull the next unclaimed run from a shared counter, so long and short
+	// runs balance across threads.  each run gets its own module instance.
+	std::atomic<int> next(0);
+	std::atomic<int> nsuccess(0);
+	auto worker = [&]()
+	{
+		int i;
+		while ( (i = next++) < count )
+		{
+			ssc_bool_t ok = p_data[i] ? ssc_module_exec_simple( name, p_data[i] ) : 0;
+			if ( results ) results[i] = ok;
+			if ( ok ) nsuccess++;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for ( int t=1; t<nthreads; t++ )
+		pool.push_back( std::thread( worker ) );
+
+	worker(); // the calling thread runs cases too
+
+	for ( size_t t=0; t<pool.size(); t++ )
+		pool[t].join();
+
+	return nsuccess;
+}
+
 SSCEXPORT ssc_bool_t ssc_module_exec( ssc_module_t p_mod, ssc_data_t p_data )
 {
 	return ssc_module_exec_with_handler( p_mod, p_data, sg_defaultPrint ? default_internal_handler : default_internal_handler_no_print, 0 );
@@ -166,6 +166,40 @@ SSCEXPORT void ssc_data_set_matrix( ssc_data_t p_data, const char *name, ssc_num
 SSCEXPORT void ssc_data_set_table( ssc_data_t p_data, const char *name, ssc_data_t table );
 /**@}*/ 
 
+/** @name Transferring ownership of arrays and matrices.
+The following functions move large arrays and matrices into and out of a data container without copying them. Buffers passed to the adopt functions must be allocated with ssc_number_alloc( ), and become owned by the data container. If the container or dimensions are not valid, the adopt functions free the buffer instead, so it must not be used after the call in any case. Buffers returned by the take functions are removed from the data container and must be released by the caller with ssc_number_free( ).
+*/
+/**@{*/
+/** Allocates a buffer of @a count numbers that can be handed to ssc_data_adopt_array( ) or ssc_data_adopt_matrix( ). */
+SSCEXPORT ssc_number_t *ssc_number_alloc( int count );
+
+/** Frees a buffer allocated by ssc_number_alloc( ) or returned by ssc_data_take_array( ) or ssc_data_take_matrix( ). */
+SSCEXPORT void ssc_number_free( ssc_number_t *pvalues );
+
+/** Assigns value of type @a SSC_ARRAY, taking ownership of @a pvalues without copying. */
+SSCEXPORT void ssc_data_adopt_array( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int length );
+
+/** Assigns value of type @a SSC_MATRIX, taking ownership of @a pvalues without copying.  Matrices are specified as a continuous array, in row-major order. */
+SSCEXPORT void ssc_data_adopt_matrix( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int nrows, int ncols );
+
+/** Removes a @a SSC_ARRAY variable from the data container and returns its values without copying. Returns 0 (NULL) if the variable is not an array. */
+SSCEXPORT ssc_number_t *ssc_data_take_array( ssc_data_t p_data, const char *name, int *length );
+
+/** Removes a @a SSC_MATRIX variable from the data container and returns its values without copying. Returns 0 (NULL) if the variable is not a matrix. */
+SSCEXPORT ssc_number_t *ssc_data_take_matrix( ssc_data_t p_data, const char *name, int *nrows, int *ncols );
+/**@}*/ 
+
+/** @name Binary storage of data containers.
+Data containers can be saved to a compact binary file and loaded back much faster than through the text representation of each variable. Nested tables are supported. Arrays and matrices are stored as aligned blocks in native byte order, and the file is memory-mapped when it is read, so the values are copied directly into the new container without any parsing. Files are not portable between platforms with a different byte order or ssc_number_t size.
+*/
+/**@{*/
+/** Writes all variables in the data container to a binary file. Returns 1 (true) on success. */
+SSCEXPORT ssc_bool_t ssc_data_write( ssc_data_t p_data, const char *file );
+
+/** Creates a new data container from a binary file written by ssc_data_write( ). Returns 0 (NULL) if the file could not be opened or is not a valid data file. The container must be released with ssc_data_free( ). */
+SSCEXPORT ssc_data_t ssc_data_read_mmap( const char *file );
+/**@}*/
+
 /** @name Retrieving variable values.
 The following functions return internal references to memory, and the returned string, array, matrix, and tables should not be freed by the user.
 */
@@ -292,6 +326,14 @@ SSCEXPORT ssc_bool_t ssc_module_exec_simple( const char *name, ssc_data_t p_data
 /** Another very simple way to run a computation module over a data set. The function returns NULL on success.  If something went wrong, the first error message is returned. Because the returned string references a common internal data container, this function is never thread-safe.  */
 SSCEXPORT const char *ssc_module_exec_simple_nothread( const char *name, ssc_data_t p_data );
 
+/** @name Running compute modules concurrently.
+Data containers and module instances are not internally synchronized, but they share no state with each other: distinct @a ssc_data_t and @a ssc_module_t objects can be used from different threads at the same time.  A single data container or module instance must only be used by one thread at a time.  ssc_module_exec_set_print( ) applies to all threads, and ssc_module_exec_simple_nothread( ) is never thread-safe.  Modules that run external executables are not thread-safe.
+*/
+/**@{*/
+/** Runs the named computation module over @a count independent data sets on @a nthreads worker threads. Passing 0 for @a nthreads uses one thread per hardware core. Every data set must be a distinct object, and each run uses its own module instance. If @a results is not NULL, it receives 1 or 0 for each data set.  Returns the number of successful runs, or -1 if no module with the given name exists, @a count is negative, or @a p_data is NULL for a non-empty batch. */
+SSCEXPORT int ssc_module_exec_batch( const char *name, ssc_data_t *p_data, int count, int nthreads, ssc_bool_t *results );
+/**@}*/
+
 /** @name Action/notification types that can be sent to a handler function: 
   *	SSC_LOG: Log a message in the handler. f0: (int)message type, f1: time, s0: message text, s1: unused. 
   *	SSC_UPDATE: Notify simulation progress update. f0: percent done, f1: time, s0: current action text, s1: unused.
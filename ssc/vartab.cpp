@@ -47,6 +47,20 @@
 *  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************************************/
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "lib_util.h"
 #include "vartab.h"
 
@@ -186,7 +200,7 @@ bool var_data::parse( unsigned char type, const std::string &buf, var_data &valu
 	return false;
 }
 
-var_table::var_table() : m_iterator(m_hash.begin())
+var_table::var_table() : m_iterator(m_hash.begin()), m_block_size(0), m_block_used(0)
 {
 	/* nothing to do here */
 }
@@ -208,15 +222,69 @@ var_table &var_table::operator=( const var_table &rhs )
 	return *this;
 }
 
+var_table::var_table( var_table &&rhs ) noexcept : m_iterator(m_hash.begin()), m_block_size(0), m_block_used(0)
+{
+	*this = std::move( rhs );
+}
+
+var_table &var_table::operator=( var_table &&rhs ) noexcept
+{
+	if ( this != &rhs )
+	{
+		clear();
+		m_hash.swap( rhs.m_hash );
+		m_blocks.swap( rhs.m_blocks );
+		m_free.swap( rhs.m_free );
+		std::swap( m_block_size, rhs.m_block_size );
+		std::swap( m_block_used, rhs.m_block_used );
+		m_iterator = m_hash.begin();
+		rhs.m_iterator = rhs.m_hash.begin();
+	}
+
+	return *this;
+}
+
+// vectors of variables move rather than copy them on reallocation
+static_assert( std::is_nothrow_move_constructible<var_data>::value, "var_data move must be noexcept" );
+static_assert( std::is_nothrow_move_constructible<var_table>::value, "var_table move must be noexcept" );
+
 void var_table::clear()
 {
-	for (var_hash::iterator it = m_hash.begin(); it != m_hash.end(); ++it)
+	m_hash.clear();
+	m_iterator = m_hash.begin();
+
+	for (size_t i = 0; i < m_blocks.size(); i++)
+		delete [] m_blocks[i]; // deletes all var_data objects in the block
+
+	m_blocks.clear();
+	m_free.clear();
+	m_block_size = m_block_used = 0;
+}
+
+var_data *var_table::alloc_slot()
+{
+	if ( m_free.size() > 0 )
 	{
-		// debug heap corruption
+		var_data *v = m_free.back();
+		m_free.pop_back();
+		return v;
+	}
 
-		delete it->second; // delete the var_data object
+	if ( m_blocks.size() == 0 || m_block_used == m_block_size )
+	{
+		// blocks double in size so a table needs only a handful of allocations
+		m_block_size = ( m_blocks.size() == 0 ) ? 16 : 2*m_block_size;
+		m_blocks.push_back( new var_data[ m_block_size ] );
+		m_block_used = 0;
 	}
-	m_hash.clear();
+
+	return &(m_blocks.back()[ m_block_used++ ]);
+}
+
+void var_table::free_slot( var_data *v )
+{
+	*v = var_data(); // release the values held by the slot before it is reused
+	m_free.push_back( v );
 }
 
 var_data *var_table::assign( const std::string &name, const var_data &val )
@@ -224,7 +292,7 @@ var_data *var_table::assign( const std::string &name, const var_data &val )
 	var_data *v = lookup(name);
 	if (!v)
 	{
-		v = new var_data;
+		v = alloc_slot();
 		m_hash[ util::lower_case(name) ] = v;
 	}
 	
@@ -232,12 +300,25 @@ var_data *var_table::assign( const std::string &name, const var_data &val )
 	return v;
 }
 
+var_data *var_table::assign( const std::string &name, var_data &&val )
+{
+	var_data *v = lookup(name);
+	if (!v)
+	{
+		v = alloc_slot();
+		m_hash[ util::lower_case(name) ] = v;
+	}
+
+	v->move(val);
+	return v;
+}
+
 void var_table::unassign( const std::string &name )
 {
 	var_hash::iterator it = m_hash.find( util::lower_case(name) );
 	if (it != m_hash.end())
 	{
-		delete (*it).second; // delete the associated data
+		free_slot( (*it).second ); // release the associated data
 		m_hash.erase( it );
 	}
 }
@@ -258,7 +339,7 @@ bool var_table::rename( const std::string &oldname, const std::string &newname )
 		it = m_hash.find( lcnewname );
 		if ( it != m_hash.end() )
 		{
-			delete it->second;
+			free_slot( it->second );
 			it->second = data;
 		}
 		else // otherwise, just add a new itme
@@ -270,9 +351,18 @@ bool var_table::rename( const std::string &oldname, const std::string &newname )
 		return false;
 }
 
+static bool has_upper_case( const std::string &name )
+{
+	for ( std::string::const_iterator it = name.begin(); it != name.end(); ++it )
+		if ( *it >= 'A' && *it <= 'Z' )
+			return true;
+	return false;
+}
+
 var_data *var_table::lookup( const std::string &name )
 {
-	var_hash::iterator it = m_hash.find( util::lower_case(name) );
+	// variable names are almost always lower case already, so skip the copy
+	var_hash::iterator it = has_upper_case( name ) ? m_hash.find( util::lower_case(name) ) : m_hash.find( name );
 	if ( it != m_hash.end() )
 		return (*it).second;
 	else
@@ -299,3 +389,252 @@ const char *var_table::next()
 	return NULL;
 }
 
+/* binary table format, all integers are 32 bit unsigned in native byte order:
+
+	header:   'SSCB' version byte_order_tag sizeof(ssc_number_t)
+	table:    count, followed by count entries
+	entry:    name_length name[pad4] type[pad4] payload
+	payload:  SSC_STRING   length chars[pad4]
+	          SSC_NUMBER   value[pad4]
+	          SSC_ARRAY,
+	          SSC_MATRIX   nrows ncols [pad8] values
+	          SSC_TABLE    table
+
+   padding is relative to the start of the file so numeric blocks are aligned in a mapped view */
+
+static const char binary_magic[4] = { 'S', 'S', 'C', 'B' };
+static const unsigned int binary_version = 1;
+static const unsigned int binary_byte_order = 0x01020304;
+
+class binary_writer
+{
+	FILE *m_fp;
+	size_t m_pos;
+	bool m_ok;
+public:
+	binary_writer( FILE *fp ) : m_fp(fp), m_pos(0), m_ok(true) {  }
+
+	bool ok() { return m_ok; }
+
+	void bytes( const void *p, size_t n )
+	{
+		if ( n > 0 && fwrite( p, 1, n, m_fp ) != n ) m_ok = false;
+		m_pos += n;
+	}
+
+	void u32( size_t v )
+	{
+		unsigned int x = (unsigned int)v;
+		bytes( &x, sizeof(x) );
+	}
+
+	void pad( size_t align )
+	{
+		static const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		size_t n = ( align - m_pos % align ) % align;
+		bytes( zeros, n );
+	}
+
+	void table( var_table &vt )
+	{
+		u32( vt.size() );
+		const char *name = vt.first();
+		while ( name )
+		{
+			var_data *v = vt.lookup( name );
+			size_t len = strlen( name );
+			u32( len );
+			bytes( name, len );
+			pad( 4 );
+			u32( v->type );
+
+			switch( v->type )
+			{
+			case SSC_STRING:
+				u32( v->str.length() );
+				bytes( v->str.c_str(), v->str.length() );
+				pad( 4 );
+				break;
+			case SSC_NUMBER:
+				bytes( &(v->num.at(0)), sizeof(ssc_number_t) );
+				pad( 4 );
+				break;
+			case SSC_ARRAY:
+			case SSC_MATRIX:
+				u32( v->num.nrows() );
+				u32( v->num.ncols() );
+				pad( 8 );
+				bytes( v->num.data(), v->num.ncells()*sizeof(ssc_number_t) );
+				pad( 4 );
+				break;
+			case SSC_TABLE:
+				table( v->table );
+				break;
+			}
+
+			name = vt.next();
+		}
+	}
+};
+
+class binary_reader
+{
+	const char *m_base;
+	size_t m_pos, m_len;
+public:
+	binary_reader( const char *base, size_t len ) : m_base(base), m_pos(0), m_len(len) {  }
+
+	const char *bytes( size_t n )
+	{
+		if ( n > m_len - m_pos ) return 0;
+		const char *p = m_base + m_pos;
+		m_pos += n;
+		return p;
+	}
+
+	bool u32( unsigned int *v )
+	{
+		const char *p = bytes( sizeof(unsigned int) );
+		if ( !p ) return false;
+		memcpy( v, p, sizeof(unsigned int) );
+		return true;
+	}
+
+	bool pad( size_t align )
+	{
+		return bytes( ( align - m_pos % align ) % align ) != 0;
+	}
+
+	bool table( var_table &vt, int depth )
+	{
+		unsigned int count = 0;
+		if ( depth > 64 || !u32( &count ) ) return false;
+
+		for ( unsigned int i = 0; i < count; i++ )
+		{
+			unsigned int len = 0, type = 0;
+			const char *name;
+			if ( !u32( &len ) || !(name = bytes( len )) || !pad( 4 ) || !u32( &type ) )
+				return false;
+
+			var_data *v = vt.assign( std::string( name, len ), var_data() );
+			v->type = (unsigned char)type;
+
+			switch( type )
+			{
+			case SSC_STRING:
+			{
+				const char *str;
+				if ( !u32( &len ) || !(str = bytes( len )) || !pad( 4 ) ) return false;
+				v->str.assign( str, len );
+				break;
+			}
+			case SSC_NUMBER:
+			{
+				const char *val = bytes( sizeof(ssc_number_t) );
+				if ( !val || !pad( 4 ) ) return false;
+				memcpy( &(v->num.at(0)), val, sizeof(ssc_number_t) );
+				break;
+			}
+			case SSC_ARRAY:
+			case SSC_MATRIX:
+			{
+				unsigned int nr = 0, nc = 0;
+				if ( !u32( &nr ) || !u32( &nc ) || !pad( 8 ) ) return false;
+				size_t n = (size_t)nr * (size_t)nc;
+				if ( n > ( m_len - m_pos ) / sizeof(ssc_number_t) ) return false;
+				// an empty array has no values, and is left as the single zero of var_data()
+				if ( n > 0 )
+				{
+					v->num.resize( nr, nc );
+					memcpy( v->num.data(), bytes( n*sizeof(ssc_number_t) ), n*sizeof(ssc_number_t) );
+				}
+				if ( !pad( 4 ) ) return false;
+				break;
+			}
+			case SSC_TABLE:
+				if ( !table( v->table, depth+1 ) ) return false;
+				break;
+			case SSC_INVALID:
+				break;
+			default:
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+bool var_table::write_binary( const std::string &file )
+{
+	FILE *fp = fopen( file.c_str(), "wb" );
+	if ( !fp ) return false;
+
+	binary_writer out( fp );
+	out.bytes( binary_magic, 4 );
+	out.u32( binary_version );
+	out.u32( binary_byte_order );
+	out.u32( sizeof(ssc_number_t) );
+	out.table( *this );
+
+	bool ok = out.ok();
+	if ( fclose( fp ) != 0 ) ok = false;
+	return ok;
+}
+
+bool var_table::read_binary( const std::string &file )
+{
+	clear();
+
+	const char *base = 0;
+	size_t len = 0;
+
+#ifdef _WIN32
+	HANDLE hfile = ::CreateFileA( file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( hfile == INVALID_HANDLE_VALUE ) return false;
+	LARGE_INTEGER size;
+	HANDLE hmap = NULL;
+	if ( ::GetFileSizeEx( hfile, &size ) && size.QuadPart > 0 )
+	{
+		len = (size_t)size.QuadPart;
+		hmap = ::CreateFileMappingA( hfile, NULL, PAGE_READONLY, 0, 0, NULL );
+		if ( hmap ) base = (const char*)::MapViewOfFile( hmap, FILE_MAP_READ, 0, 0, 0 );
+	}
+#else
+	int fd = open( file.c_str(), O_RDONLY );
+	if ( fd < 0 ) return false;
+	struct stat st;
+	if ( fstat( fd, &st ) == 0 && st.st_size > 0 )
+	{
+		len = (size_t)st.st_size;
+		void *p = mmap( 0, len, PROT_READ, MAP_PRIVATE, fd, 0 );
+		if ( p != MAP_FAILED ) base = (const char*)p;
+	}
+#endif
+
+	bool ok = false;
+	if ( base )
+	{
+		binary_reader in( base, len );
+		const char *magic = in.bytes( 4 );
+		unsigned int version = 0, byte_order = 0, number_size = 0;
+		ok = magic && memcmp( magic, binary_magic, 4 ) == 0
+			&& in.u32( &version ) && version == binary_version
+			&& in.u32( &byte_order ) && byte_order == binary_byte_order
+			&& in.u32( &number_size ) && number_size == sizeof(ssc_number_t)
+			&& in.table( *this, 0 );
+	}
+
+#ifdef _WIN32
+	if ( base ) ::UnmapViewOfFile( base );
+	if ( hmap ) ::CloseHandle( hmap );
+	::CloseHandle( hfile );
+#else
+	if ( base ) munmap( (void*)base, len );
+	close( fd );
+#endif
+
+	if ( !ok ) clear();
+	return ok;
+}
@@ -52,6 +52,7 @@
 
 #include "../shared/lib_util.h"
 #include <string>
+#include <vector>
 #include "sscapi.h"
 
 
@@ -70,10 +71,12 @@ class var_table
 {
 public:
 	explicit var_table();
+	var_table( var_table &&rhs ) noexcept;
 	virtual ~var_table();
 
 	void clear();
 	var_data *assign( const std::string &name, const var_data &value );
+	var_data *assign( const std::string &name, var_data &&value );
 	void unassign( const std::string &name );
 	bool rename( const std::string &oldname, const std::string &newname );
 	var_data *lookup( const std::string &name );
@@ -81,10 +84,28 @@ public:
 	const char *next();
 	unsigned int size() { return (unsigned int)m_hash.size(); }
 	var_table &operator=( const var_table &rhs );
+	var_table &operator=( var_table &&rhs ) noexcept;
+
+	// compact binary storage of the table and any nested tables. numeric blocks
+	// are written 8-byte aligned in native byte order, and read_binary maps the
+	// file into memory so arrays are copied straight out without parsing.
+	bool write_binary( const std::string &file );
+	bool read_binary( const std::string &file );
 
 private:
+	var_data *alloc_slot();
+	void free_slot( var_data *v );
+
 	var_hash m_hash;
 	var_hash::iterator m_iterator;
+
+	// var_data entries are carved out of blocks owned by the table rather than
+	// allocated one at a time.  entries never move, so a var_data* returned by
+	// lookup() or assign() stays valid until the variable is unassigned.
+	std::vector< var_data* > m_blocks;
+	std::vector< var_data* > m_free;
+	size_t m_block_size;
+	size_t m_block_used;
 };
 
 
@@ -94,11 +115,13 @@ public:
 	
 	var_data() : type(SSC_INVALID) { num=0.0; }
 	var_data( const var_data &cp ) : type(cp.type), num(cp.num), str(cp.str) {  }
+	var_data( var_data &&mv ) noexcept : type(mv.type), num(std::move(mv.num)), str(std::move(mv.str)), table(std::move(mv.table)) {  }
 	var_data( const std::string &s ) : type(SSC_STRING), str(s) {  }
 	var_data( ssc_number_t n ) : type(SSC_NUMBER) { num = n; }
 	var_data(const ssc_number_t *pvalues, int length) : type(SSC_ARRAY) { num.assign(pvalues, (size_t)length); }
 	var_data(const ssc_number_t *pvalues, size_t length) : type(SSC_ARRAY) { num.assign(pvalues, length); }
 	var_data(const ssc_number_t *pvalues, int nr, int nc) : type(SSC_MATRIX) { num.assign(pvalues, (size_t)nr, (size_t)nc); }
+	var_data(util::matrix_t<ssc_number_t> &&values, unsigned char ty) : type(ty), num(std::move(values)) {  }
 
 	const char *type_name();
 	static std::string type_name(int type);
@@ -108,7 +131,9 @@ public:
 	static bool parse( unsigned char type, const std::string &buf, var_data &value );
 
 	var_data &operator=(const var_data &rhs) { copy(rhs); return *this; }
+	var_data &operator=(var_data &&rhs) noexcept { move(rhs); return *this; }
 	void copy( const var_data &rhs ) { type=rhs.type; num=rhs.num; str=rhs.str; table = rhs.table; }
+	void move( var_data &rhs ) noexcept { type=rhs.type; num=std::move(rhs.num); str=std::move(rhs.str); table = std::move(rhs.table); }
 	
 	unsigned char type;
 	util::matrix_t<ssc_number_t> num;
@@ -53,6 +53,73 @@ TEST_F(BatteryDispatchTest, DispatchAutoBTM)
 	EXPECT_LT(batteryPower->powerBatteryDC, 0);
 }
 
+/// Peak shaving target found by the original search over every pair of sorted grid powers, for comparison
+double peakShavingTargetReference(std::vector<double> grid, double dt_hour, double E_useful)
+{
+	std::sort(grid.begin(), grid.end(), std::greater<double>());
+	size_t n = grid.size();
+
+	std::vector<double> E_charge(n, 0.);
+	for (size_t k = 0; k < n; k++) {
+		for (int ii = (int)n - 1; ii >= 0; ii--) {
+			if (grid[ii] > grid[k])
+				break;
+			E_charge[k] += (grid[k] - grid[ii]) * dt_hour;
+		}
+	}
+
+	double P_target = grid[0];
+	double sum = 0;
+	for (size_t ii = 0; ii != n - 1; ii++) {
+		if (grid[ii + 1] < 0)
+			break;
+		P_target = grid[ii + 1];
+		if (grid[ii] == grid[ii + 1])
+			continue;
+		sum += (grid[ii] - grid[ii + 1]) * (ii + 1) * dt_hour;
+		if (sum < E_charge[ii + 1] && sum < E_useful)
+			continue;
+		else if (sum > E_charge[ii + 1]) {
+			P_target += (sum - E_charge[ii]) / ((ii + 1) * dt_hour);
+			break;
+		}
+		else if (sum > E_useful) {
+			P_target += (sum - E_useful) / ((ii + 1) * dt_hour);
+			break;
+		}
+	}
+	return P_target;
+}
+
+TEST_F(BatteryDispatchTest, DispatchAutoBTMTargetMinute)
+{
+	// one minute load and pv with a morning and evening peak, repeated values and some export
+	double dtHourMinute = 1.0 / 60.0;
+	size_t steps = 24 * 60;
+	std::vector<double> load, pv, grid;
+	for (size_t i = 0; i < 2 * steps; i++) {
+		double h = (double)(i % steps) / 60.;
+		double P_load = 400 + 250 * exp(-pow(h - 8.5, 2)) + 350 * exp(-pow(h - 18.75, 2) / 2) + (double)((i * 7919) % 23);
+		double P_pv = (h > 6 && h < 20) ? 600 * sin((h - 6) / 14 * M_PI) : 0;
+		load.push_back(P_load);
+		pv.push_back(P_pv);
+		if (i < steps)
+			grid.push_back(P_load - P_pv);
+	}
+
+	dispatch_automatic_behind_the_meter_t dispatch(batteryModelFOM, dtHourMinute, 15, 95, 1, 999, 999, 500, 500, 1, 0, 0, 1, 24, 1, true, true, false, false);
+	dispatch.update_load_data(load);
+	dispatch.update_pv_data(pv);
+	batteryPower = dispatch.getBatteryPower();
+	batteryPower->connectionMode = ChargeController::AC_CONNECTED;
+
+	double E_max = batteryModelFOM->battery_voltage() * batteryModelFOM->battery_charge_maximum() * (95 - 15) * 0.01 * util::watt_to_kilowatt;
+	double P_target = peakShavingTargetReference(grid, dtHourMinute, E_max) * 1.03;
+
+	dispatch.dispatch(0, 0, 0);
+	EXPECT_NEAR(dispatch.power_grid_target(), P_target, 1e-6 * fabs(P_target));
+}
+
 TEST_F(BatteryDispatchTest, DispatchFOMInput)
 {
 	std::vector<double> P_batt;
@@ -70,6 +137,96 @@ TEST_F(BatteryDispatchTest, DispatchFOMInput)
 
 }
 
+TEST_F(BatteryDispatchTest, DispatchLPPeak)
+{
+	// 150 kWh of discharge brings the peak to 175 kW, with 50 kWh charged from the grid before the peak
+	dispatch_lp_t lp(4, 1.0, dispatch_lp_t::MINIMIZE_PEAK);
+	lp.net_load = { 100, 300, 200, 100 };
+	lp.discharge_max = lp.net_load;
+	lp.charge_grid_max = { 100, 100, 100, 100 };
+	lp.charge_max = 100;
+	lp.energy_max = 150;
+	lp.energy_initial = 100;
+
+	EXPECT_TRUE(lp.solve());
+	EXPECT_NEAR(lp.peak(), 175, 1e-6);
+	EXPECT_NEAR(lp.battery_power()[0], -50, 1e-6);
+	EXPECT_NEAR(lp.battery_power()[1], 125, 1e-6);
+	EXPECT_NEAR(lp.battery_power()[2], 25, 1e-6);
+
+	// the peak can't be set below one already reached
+	lp.peak_min = 250;
+	EXPECT_TRUE(lp.solve());
+	EXPECT_NEAR(lp.peak(), 250, 1e-6);
+	EXPECT_NEAR(lp.battery_power()[1], 50, 1e-6);
+	EXPECT_EQ(lp.solve_count(), 2);
+	EXPECT_EQ(lp.failure_count(), 0);
+}
+
+TEST_F(BatteryDispatchTest, DispatchLPRevenue)
+{
+	// charge from the grid when it is cheapest and discharge at the highest price
+	dispatch_lp_t lp(4, 1.0, dispatch_lp_t::MAXIMIZE_REVENUE);
+	lp.value_discharge = { 0.1, 0.1, 0.5, 0.2 };
+	lp.cost_charge_grid = { 0.05, 0.3, 0.3, 0.3 };
+	lp.charge_grid_max = { 100, 100, 100, 100 };
+	lp.discharge_max = { 100, 100, 100, 100 };
+	lp.charge_max = 100;
+	lp.energy_max = 100;
+	lp.energy_initial = 0;
+
+	EXPECT_TRUE(lp.solve());
+	std::vector<double> expected = { -100, 0, 100, 0 };
+	for (size_t i = 0; i != expected.size(); i++)
+		EXPECT_NEAR(lp.battery_power()[i], expected[i], 1e-6) << i;
+	size_t iterations = lp.iterations();
+
+	// an unchanged horizon is solved from the previous basis without further iterations
+	EXPECT_TRUE(lp.solve());
+	EXPECT_EQ(lp.iterations(), iterations);
+	for (size_t i = 0; i != expected.size(); i++)
+		EXPECT_NEAR(lp.battery_power()[i], expected[i], 1e-6) << i;
+}
+
+TEST_F(BatteryDispatchTest, DispatchAutoBTMLP)
+{
+	// one day of one minute data with a single peak
+	double dtHourMinute = 1.0 / 60.0;
+	size_t steps = 24 * 60;
+	std::vector<double> load, pv;
+	for (size_t i = 0; i < 2 * steps; i++) {
+		double h = (double)(i % steps) / 60.;
+		load.push_back(400 + 350 * exp(-pow(h - 18.75, 2) / 2));
+		pv.push_back(0);
+	}
+
+	dispatch_automatic_behind_the_meter_t dispatch(batteryModelFOM, dtHourMinute, 15, 95, 1, 999, 999, 500, 500, 1, 0, 0, 1, 24, 1, true, true, false, false);
+	dispatch.update_load_data(load);
+	dispatch.update_pv_data(pv);
+	dispatch.set_lp_dispatch(true);
+	batteryPower = dispatch.getBatteryPower();
+	batteryPower->connectionMode = ChargeController::AC_CONNECTED;
+
+	double E_available = batteryModelFOM->battery_voltage() * batteryModelFOM->battery_charge_maximum() * (batteryModelFOM->battery_soc() - 15) * 0.01 * util::watt_to_kilowatt;
+	dispatch.dispatch(0, 0, 0);
+	const dispatch_lp_t * lp = dispatch.lp_dispatch();
+	ASSERT_TRUE(lp != NULL);
+	EXPECT_EQ(lp->solve_count(), 1);
+	EXPECT_EQ(lp->failure_count(), 0);
+	EXPECT_NEAR(dispatch.power_grid_target(), lp->peak(), 1e-9);
+
+	// discharging the energy available at the start of the day flattens the peak
+	double E_shaved = 0;
+	for (size_t i = 0; i < steps; i++)
+		E_shaved += std::fmax(load[i] - lp->peak(), 0) * dtHourMinute;
+	EXPECT_LT(lp->peak(), 750);
+	EXPECT_NEAR(E_shaved, E_available, 1e-3 * E_available);
+
+	// the linear program is only used for the look ahead and look behind modes
+	dispatchAutoFOM->set_lp_dispatch(true);
+	EXPECT_TRUE(dispatchAutoFOM->lp_dispatch() == NULL);
+}
+
 /// Test to see if losses model is initialized correctly
 TEST_F(BatteryDispatchTest, LossesModel)
 {
@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 #include <lib_util.h>
 #include <lib_battery_dispatch.h>
+#include <lib_battery_dispatch_lp.h>
 #include <lib_battery_powerflow.h>
 #include <lib_power_electronics.h>
 
@@ -70,4 +70,103 @@ TEST_F(BatteryTest, LossesModel)
 	lossModel->run_losses(idx);
 	EXPECT_EQ(lossModel->getLoss(idx), 1);
 
-}
\ No newline at end of file
+}
+
+TEST_F(BatteryTest, SaveRestoreState)
+{
+	// run a few cycles so that the rainflow, calendar and loss models have state to save
+	size_t idx = 0;
+	for (size_t h = 0; h < 48; h++, idx++) {
+		batteryModel->run(idx, (h % 6 < 3) ? 20. : -20.);
+	}
+
+	battery_state state;
+	batteryModel->save_state(state);
+
+	std::vector<double> SOC, voltage, T_battery, q_lifetime;
+	for (size_t h = 0; h < 48; h++) {
+		batteryModel->run(idx + h, (h % 4 < 2) ? 30. : -30.);
+		SOC.push_back(batteryModel->battery_soc());
+		voltage.push_back(batteryModel->battery_voltage());
+		T_battery.push_back(batteryModel->thermal_model()->T_battery());
+		q_lifetime.push_back(batteryModel->lifetime_model()->capacity_percent());
+	}
+	int cycles = batteryModel->lifetime_model()->cycleModel()->cycles_elapsed();
+
+	// restoring the state must reproduce the same trajectory exactly
+	batteryModel->restore_state(state);
+	for (size_t h = 0; h < 48; h++) {
+		batteryModel->run(idx + h, (h % 4 < 2) ? 30. : -30.);
+		EXPECT_EQ(batteryModel->battery_soc(), SOC[h]);
+		EXPECT_EQ(batteryModel->battery_voltage(), voltage[h]);
+		EXPECT_EQ(batteryModel->thermal_model()->T_battery(), T_battery[h]);
+		EXPECT_EQ(batteryModel->lifetime_model()->capacity_percent(), q_lifetime[h]);
+	}
+	EXPECT_EQ(batteryModel->lifetime_model()->cycleModel()->cycles_elapsed(), cycles);
+	EXPECT_GT(cycles, 0);
+}
+
+TEST_F(BatteryTest, RainflowCycleCounting)
+{
+	// 500 cycles of 80 % DOD, each with a nested 20 % cycle which must be closed first
+	for (size_t i = 0; i < 500; i++) {
+		cycleModel->runCycleLifetime(0);
+		cycleModel->runCycleLifetime(50);
+		cycleModel->runCycleLifetime(30);
+		cycleModel->runCycleLifetime(80);
+	}
+	double q = cycleModel->runCycleLifetime(0);
+
+	EXPECT_EQ(cycleModel->cycles_elapsed(), 1000);
+	EXPECT_EQ(cycleModel->cycle_range(), 80);
+
+	// capacity at the average range of 50 % after 1000 cycles, halfway between 96 % at 20 % DOD and 80 % at 80 % DOD
+	EXPECT_NEAR(q, 88, 1e-9);
+	EXPECT_NEAR(cycleModel->computeCycleDamageAtDOD(), 0.012, 1e-9);
+}
+
+TEST_F(BatteryTest, RunIdle)
+{
+	// a room that is 10 C warmer in the afternoon, so the idle span relaxes toward a changing room temperature
+	std::vector<double> T_room_diurnal;
+	for (size_t i = 0; i < 8760; i++) {
+		T_room_diurnal.push_back(((i % 24 >= 12 && i % 24 < 18) ? 30 : 20) + 273.15);
+	}
+	delete thermalModel;
+	thermalModel = new thermal_t(1.0, mass, length, width, height, Cp, h, T_room_diurnal, capacityVsTemperature);
+	batteryModel->initialize(capacityModel, voltageModel, lifetimeModel, thermalModel, lossModel);
+
+	// heat the battery and leave it partly discharged, so that the idle span relaxes the temperature
+	size_t idx = 0;
+	for (size_t h = 0; h < 30; h++, idx++) {
+		batteryModel->run(idx, (h % 6 < 3) ? 50. : -40.);
+	}
+
+	battery_state state;
+	batteryModel->save_state(state);
+
+	for (size_t n_steps : {1, 4, 240}) {
+		batteryModel->restore_state(state);
+		for (size_t i = 0; i < n_steps; i++) {
+			batteryModel->run(idx + i, 0.);
+		}
+		battery_state stepped;
+		batteryModel->save_state(stepped);
+		double voltage = batteryModel->battery_voltage();
+
+		// running the idle span in one call must match the stepwise path, the calendar fade to within the
+		// error of evaluating its rate once at the mean temperature of a run at the room temperature
+		batteryModel->restore_state(state);
+		batteryModel->run_idle(idx, n_steps);
+		battery_state idle;
+		batteryModel->save_state(idle);
+		EXPECT_NEAR(idle.capacity.SOC, stepped.capacity.SOC, 1e-9) << n_steps;
+		EXPECT_NEAR(batteryModel->battery_voltage(), voltage, 1e-9) << n_steps;
+		EXPECT_NEAR(idle.thermal.T_battery, stepped.thermal.T_battery, 1e-9) << n_steps;
+		EXPECT_NEAR(idle.lifetime.calendar.q, stepped.lifetime.calendar.q, 1e-6) << n_steps;
+		EXPECT_EQ(idle.lifetime.calendar.day_age_of_battery, stepped.lifetime.calendar.day_age_of_battery) << n_steps;
+		EXPECT_NEAR(idle.lifetime.q, stepped.lifetime.q, 1e-6) << n_steps;
+		EXPECT_NE(idle.thermal.T_battery, state.thermal.T_battery) << n_steps;
+		EXPECT_LT(idle.lifetime.calendar.q, state.lifetime.calendar.q) << n_steps;
+	}
+}
@@ -447,6 +447,163 @@ TEST_F(SunsetCaseIrradProc, CalcTestRadMode0_lib_irradproc){
 	*/
 }
 
+/**
+*   Array versions of solarpos, incidence and the sky models give the same results as the scalar functions
+*/
+TEST_F(DayCaseIrradProc, ArrayKernelsTest_lib_irradproc){
+	const size_t n = 96; // 15 minute steps over the day
+	vector<int> yr(n, year), mn(n, month), dy(n, day), hr(n);
+	vector<double> mi(n);
+	for (size_t i = 0; i < n; i++) {
+		hr[i] = (int)(i / 4);
+		mi[i] = 7.5 + 15.0 * (i % 4);
+	}
+
+	vector<vector<double> > sun(9, vector<double>(n));
+	double *sunn[9];
+	for (int k = 0; k < 9; k++) sunn[k] = &sun[k][0];
+	solarpos_array(n, &yr[0], &mn[0], &dy[0], &hr[0], &mi[0], lat, lon, tz, sunn);
+
+	vector<vector<double> > ang(5, vector<double>(n));
+	double *angle[5];
+	for (int k = 0; k < 5; k++) angle[k] = &ang[k][0];
+
+	vector<double> dn(n, 800), df(n, 150), albedo(n, alb);
+	vector<vector<double> > poa(3, vector<double>(n)), diff(3, vector<double>(n));
+	double *p_poa[3], *p_diff[3];
+	for (int k = 0; k < 3; k++) { p_poa[k] = &poa[k][0]; p_diff[k] = &diff[k][0]; }
+
+	for (int mode = 0; mode < 3; mode++) {
+		incidence_array(mode, tilt, azim, 45, n, &sun[1][0], &sun[0][0], false, 0.3, angle);
+		for (int model = 0; model < 3; model++) {
+			skymodel_array(model, n, &sun[8][0], &dn[0], &df[0], &albedo[0], &ang[0][0], &ang[1][0], &sun[1][0], p_poa, p_diff);
+
+			for (size_t i = 0; i < n; i++) {
+				double s[9], a[5], p[3], d[3];
+				solarpos(year, month, day, hr[i], mi[i], lat, lon, tz, s);
+				for (int k = 0; k < 9; k++)
+					ASSERT_DOUBLE_EQ(sun[k][i], s[k]) << "sun parameter " << k << " at step " << i;
+
+				incidence(mode, tilt, azim, 45, s[1], s[0], false, 0.3, a);
+				for (int k = 0; k < 5; k++)
+					ASSERT_DOUBLE_EQ(ang[k][i], a[k]) << "mode " << mode << " angle " << k << " at step " << i;
+
+				if (s[1] >= M_PI / 2) continue; // sky models are only evaluated with the sun up
+
+				if (model == 0) isotropic(s[8], 800, 150, alb, a[0], a[1], s[1], p, d);
+				else if (model == 1) hdkr(s[8], 800, 150, alb, a[0], a[1], s[1], p, d);
+				else perez(s[8], 800, 150, alb, a[0], a[1], s[1], p, d);
+				for (int k = 0; k < 3; k++) {
+					ASSERT_DOUBLE_EQ(poa[k][i], p[k]) << "model " << model << " poa " << k << " at step " << i;
+					ASSERT_DOUBLE_EQ(diff[k][i], d[k]) << "model " << model << " diffuse " << k << " at step " << i;
+				}
+			}
+		}
+	}
+}
+
+/**
+*   The sun positions of solarpos_timestep_array, including the sunrise and sunset timesteps, are those of irrad::calc,
+*   and supplying them with set_sun_position gives the same plane-of-array irradiance
+*/
+TEST_F(DayCaseIrradProc, TimestepArrayTest_lib_irradproc){
+	const size_t n = 48 * 4; // two days of 15 minute steps
+	vector<int> yr(n, year), mn(n, month), dy(n), hr(n);
+	vector<double> mi(n);
+	for (size_t i = 0; i < n; i++) {
+		dy[i] = day + (int)(i / 96);
+		hr[i] = (int)((i % 96) / 4);
+		mi[i] = 7.5 + 15.0 * (i % 4);
+	}
+
+	double delts[3] = { 0.25, 1.0, IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET };
+	for (int j = 0; j < 3; j++) {
+		vector<vector<int> > ts(3, vector<int>(n));
+		vector<vector<double> > sun(9, vector<double>(n));
+		int *tsp[3];
+		double *sunn[9];
+		for (int k = 0; k < 3; k++) tsp[k] = &ts[k][0];
+		for (int k = 0; k < 9; k++) sunn[k] = &sun[k][0];
+		solarpos_timestep_array(n, &yr[0], &mn[0], &dy[0], &hr[0], &mi[0], delts[j], lat, lon, tz, tsp, sunn);
+
+		int nstraddle = 0;
+		for (size_t i = 0; i < n; i++) {
+			irrad irr;
+			irr.set_time(yr[i], mn[i], dy[i], hr[i], mi[i], delts[j]);
+			irr.set_location(lat, lon, tz);
+			irr.set_sky_model(skymodel, alb);
+			irr.set_beam_diffuse(800, 150);
+			irr.set_surface(tracking, tilt, azim, rotlim, backtrack_on, gcr);
+			ASSERT_EQ(irr.calc(), 0);
+
+			double s[9], poa[3];
+			int sunup;
+			irr.get_sun(0, 0, 0, 0, 0, 0, &sunup, 0, 0, 0);
+			for (int k = 0; k < 9; k++) {
+				s[k] = irr.get_sun_component(k);
+				ASSERT_DOUBLE_EQ(sun[k][i], s[k]) << "delt " << delts[j] << " sun parameter " << k << " at step " << i;
+			}
+			ASSERT_EQ(ts[2][i], sunup) << "delt " << delts[j] << " at step " << i;
+			if (sunup > 1) nstraddle++;
+			irr.get_poa(&poa[0], &poa[1], &poa[2], 0, 0, 0);
+
+			irrad supplied;
+			supplied.set_time(yr[i], mn[i], dy[i], hr[i], mi[i], delts[j]);
+			supplied.set_location(lat, lon, tz);
+			supplied.set_sky_model(skymodel, alb);
+			supplied.set_beam_diffuse(800, 150);
+			supplied.set_surface(tracking, tilt, azim, rotlim, backtrack_on, gcr);
+			int t[3] = { ts[0][i], ts[1][i], ts[2][i] };
+			supplied.set_sun_position(t, s);
+			ASSERT_EQ(supplied.calc(), 0);
+
+			double p[3];
+			supplied.get_poa(&p[0], &p[1], &p[2], 0, 0, 0);
+			for (int k = 0; k < 3; k++)
+				ASSERT_DOUBLE_EQ(p[k], poa[k]) << "delt " << delts[j] << " poa " << k << " at step " << i;
+		}
+		if (delts[j] > 0) EXPECT_GT(nstraddle, 0) << "delt " << delts[j];
+		else EXPECT_EQ(nstraddle, 0);
+	}
+}
+
+/**
+*   Rear-side irradiance is the same whether or not the geometry and scratch storage are reused between calls
+*/
+TEST_F(DayCaseIrradProc, RearSideGeometryReuse_lib_irradproc){
+	bifacial_geometry geometry;
+	irr_hourly_day.set_surface(tracking, 30, azim, rotlim, backtrack_on, 0.4);
+	irr_15m_day.set_surface(tracking, 30, azim, rotlim, backtrack_on, 0.4);
+	irr_hourly_day.set_beam_diffuse(800, 150);
+	irr_15m_day.set_beam_diffuse(800, 150);
+
+	// the front-side calculation is rerun before each rear-side one, as in the timestep loop of pvsamv1
+	irr_hourly_day.calc();
+	irr_hourly_day.calc_rear_side(0.013, 0.65, 1.0, 2.0);
+	double rear_hourly = irr_hourly_day.get_poa_rear();
+	irr_15m_day.calc();
+	irr_15m_day.calc_rear_side(0.013, 0.65, 1.0, 2.0);
+	double rear_15m = irr_15m_day.get_poa_rear();
+	EXPECT_GT(rear_hourly, 0);
+
+	for (int pass = 0; pass < 2; pass++) {
+		irr_hourly_day.calc();
+		irr_hourly_day.calc_rear_side(0.013, 0.65, 1.0, 2.0, &geometry);
+		ASSERT_DOUBLE_EQ(irr_hourly_day.get_poa_rear(), rear_hourly);
+		irr_15m_day.calc();
+		irr_15m_day.calc_rear_side(0.013, 0.65, 1.0, 2.0, &geometry);
+		ASSERT_DOUBLE_EQ(irr_15m_day.get_poa_rear(), rear_15m);
+	}
+
+	// a different row geometry must not pick up the stored factors
+	irr_hourly_day.calc();
+	irr_hourly_day.calc_rear_side(0.013, 0.65, 1.0, 3.0);
+	double rear_longer = irr_hourly_day.get_poa_rear();
+	irr_hourly_day.calc();
+	irr_hourly_day.calc_rear_side(0.013, 0.65, 1.0, 3.0, &geometry);
+	ASSERT_DOUBLE_EQ(irr_hourly_day.get_poa_rear(), rear_longer);
+}
+
 /**
 *   Test Sky Configuration factors.  These factors do not change with time, just system geometry
 */
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <lib_pv_shade_loss_mpp.h>
+
+TEST(shadeDB8Test, StringCase)
+{
+	// percent shaded for each string, in any order, and the position of the case in the database
+	struct { std::vector<double> shade; size_t S; int s_max; } cases[] = {
+		{ { 30, 10 }, 2, 3 },
+		{ { 32, 28 }, 4, 3 },
+		{ { 14.9, 52, 20 }, 6, 5 },
+		{ { 50, 50, 50 }, 21, 5 },
+		{ { 40, 20, 70, 40 }, 35, 7 },
+		{ { 0, 90, 30, 10, 20, 100, 30, 0 }, 6491, 10 },
+		{ { 20, 0, 0, 0, 0, 0, 0, 0 }, 1, 2 },
+		{ { 10 }, 1, 1 },
+		{ { 0, 40 }, 1, 4 },
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		ShadeDB8_mpp::string_case sc = ShadeDB8_mpp::get_string_case(&cases[i].shade[0], cases[i].shade.size());
+		EXPECT_EQ(sc.num_strings, cases[i].shade.size()) << "case " << i;
+		EXPECT_EQ(sc.S, cases[i].S) << "case " << i;
+		EXPECT_EQ(sc.s_max, cases[i].s_max) << "case " << i;
+	}
+
+	// more strings than the database covers
+	std::vector<double> nine(9, 50.0);
+	EXPECT_EQ(ShadeDB8_mpp::get_string_case(&nine[0], nine.size()).S, 0u);
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+#include <lib_pvmodel.h>
+#include <lib_cec6par.h>
+
+/**
+* Single diode solution tests, comparing the Lambert W solution with the iterative solution
+*/
+
+class singleDiodeTest : public ::testing::Test {
+protected:
+	cec6par_module_t cec;
+
+	void SetUp() {
+		// 60 cell multi-Si module from the CEC database
+		cec.Area = 1.631;
+		cec.Vmp = 30.9;
+		cec.Imp = 8.1;
+		cec.Voc = 38.3;
+		cec.Isc = 8.6;
+		cec.alpha_isc = 0.00533;
+		cec.beta_voc = -0.1298;
+		cec.a = 1.5;
+		cec.Il = 8.65;
+		cec.Io = 6.4e-11;
+		cec.Rs = 0.31;
+		cec.Rsh = 315;
+		cec.Adj = 9.5;
+	}
+};
+
+TEST_F(singleDiodeTest, LambertW) {
+	EXPECT_NEAR(lambertw_exp(0), 0.567143290409784, 1e-12);
+	EXPECT_NEAR(lambertw_exp(1), 1.0, 1e-12);
+	double w = lambertw_exp(500);
+	EXPECT_NEAR(w + log(w), 500, 1e-10);
+	EXPECT_NEAR(lambertw_exp(-50), exp(-50), 1e-30);
+}
+
+TEST_F(singleDiodeTest, MaxPowerMatchesIterative) {
+	for (double G = 50; G <= 1200; G += 150) {
+		for (double Tc = -10; Tc <= 75; Tc += 17) {
+			double IL, IO, A, Rsh;
+			cec.operating_parameters(G, Tc + 273.15, IL, IO, A, Rsh);
+
+			double Voc = openvoltage_5par(cec.Voc, A, IL, IO, Rsh);
+			double V, I;
+			double P = maxpower_5par(Voc, A, IL, IO, cec.Rs, Rsh, &V, &I);
+
+			double Voc_lw, V_lw, I_lw;
+			double P_lw = maxpower_5par_lambertw(A, IL, IO, cec.Rs, Rsh, &V_lw, &I_lw, &Voc_lw);
+
+			EXPECT_NEAR(Voc_lw, Voc, 0.002) << "G=" << G << " Tc=" << Tc;
+			EXPECT_NEAR(P_lw, P, 1e-4 * P) << "G=" << G << " Tc=" << Tc;
+			EXPECT_NEAR(V_lw, V, 0.01 * V) << "G=" << G << " Tc=" << Tc;
+			EXPECT_GE(P_lw, P * (1 - 1e-8)) << "the explicit solution should not find a lower max power";
+
+			// current at a fixed voltage, and both sides of the single diode equation
+			double I_fixed = current_5par_lambertw(0.8 * V_lw, A, IL, IO, cec.Rs, Rsh);
+			EXPECT_NEAR(I_fixed, current_5par(0.8 * V_lw, 0.9 * IL, A, IL, IO, cec.Rs, Rsh), 1e-3);
+			double Vd = 0.8 * V_lw + I_fixed * cec.Rs;
+			EXPECT_NEAR(IL - IO * (exp(Vd / A) - 1) - Vd / Rsh, I_fixed, 1e-9);
+		}
+	}
+}
+
+TEST_F(singleDiodeTest, ModuleSolverAndBatch) {
+	pvinput_t in(600, 150, 20, 0, 770, 20, 10, 2, 180, 1013, 35, 25, 100, 30, 180, 12, 0, false);
+	pvoutput_t out_iter, out_lw;
+
+	cec.Solver = SINGLE_DIODE_ITERATIVE;
+	EXPECT_TRUE(cec(in, 45, -1, out_iter));
+	cec.Solver = SINGLE_DIODE_LAMBERTW;
+	EXPECT_TRUE(cec(in, 45, -1, out_lw));
+	EXPECT_NEAR(out_lw.Power, out_iter.Power, 1e-4 * out_iter.Power);
+	EXPECT_NEAR(out_lw.Voc_oper, out_iter.Voc_oper, 0.002);
+
+	// operating voltage specified
+	EXPECT_TRUE(cec(in, 45, 25, out_lw));
+	cec.Solver = SINGLE_DIODE_ITERATIVE;
+	EXPECT_TRUE(cec(in, 45, 25, out_iter));
+	EXPECT_NEAR(out_lw.Current, out_iter.Current, 1e-3);
+
+	double G[] = { 0.5, 200, 800, 1000 };
+	double Tc[] = { 10, 25, 45, 60 };
+	double P[4], V[4], I[4];
+	cec.max_power_batch(4, G, Tc, P, V, I);
+	EXPECT_EQ(P[0], 0);
+	for (int i = 1; i < 4; i++) {
+		double IL, IO, A, Rsh, Vmp, Imp;
+		cec.operating_parameters(G[i], Tc[i] + 273.15, IL, IO, A, Rsh);
+		EXPECT_DOUBLE_EQ(P[i], maxpower_5par_lambertw(A, IL, IO, cec.Rs, Rsh, &Vmp, &Imp));
+		EXPECT_DOUBLE_EQ(V[i], Vmp);
+		EXPECT_DOUBLE_EQ(I[i], Imp);
+	}
+}
+
+TEST_F(singleDiodeTest, CalcArrayMatchesTimestep) {
+	noct_celltemp_t tc;
+	tc.Tnoct = 46;
+	tc.standoff_tnoct_adj = 0;
+	tc.ffv_wind = 0.51;
+
+	const size_t n = 24;
+	std::vector<pvinput_t> in(n);
+	std::vector<double> opv(n, -1), tcell(n);
+	std::vector<pvoutput_t> out(n);
+	for (size_t i = 0; i < n; i++) {
+		double beam = (i > 6 && i < 18) ? 80.0 * (i - 6) * (18 - i) / 3.0 : 0;
+		in[i] = pvinput_t(beam, 0.2 * beam, 0.02 * beam, 0, 1.22 * beam, 15 + i * 0.5, 5, 1 + 0.2 * i, 180, 1013, 30 + 2 * fabs(12.0 - i), 20 + fabs(12.0 - i), 100, 30, 180, (double)i, 0, false);
+		if (i % 3 == 0) opv[i] = 28;
+	}
+
+	EXPECT_TRUE(tc.calc_array(n, &in[0], cec, &opv[0], &tcell[0]));
+	EXPECT_TRUE(cec.calc_array(n, &in[0], &tcell[0], &opv[0], &out[0]));
+
+	for (size_t i = 0; i < n; i++) {
+		double t = 0;
+		pvoutput_t o;
+		EXPECT_TRUE(tc(in[i], cec, opv[i], t));
+		EXPECT_TRUE(cec(in[i], t, opv[i], o));
+		EXPECT_EQ(tcell[i], t) << "timestep " << i;
+		EXPECT_EQ(out[i].Power, o.Power) << "timestep " << i;
+		EXPECT_EQ(out[i].Voltage, o.Voltage) << "timestep " << i;
+	}
+
+	// a NULL operating voltage array means max power at every timestep
+	std::vector<pvoutput_t> out_mpp(n);
+	EXPECT_TRUE(cec.calc_array(n, &in[0], &tcell[0], 0, &out_mpp[0]));
+	for (size_t i = 0; i < n; i++)
+		EXPECT_GE(out_mpp[i].Power, out[i].Power * (1 - 1e-6)) << "timestep " << i;
+}
+
+TEST_F(singleDiodeTest, MountingSpecificWarmStart) {
+	for (int mc = 1; mc <= 3; mc++) {
+		mcsp_celltemp_t cold, warm;
+		for (mcsp_celltemp_t *m : { &cold, &warm }) {
+			m->DcDerate = 0.95;
+			m->MC = mc;
+			m->HTD = 1;
+			m->MSO = 1;
+			m->Wgap = 0.05;
+			m->Length = 1.6;
+			m->Width = 1.0;
+			m->Nrows = m->Ncols = 1;
+			m->TbackInteg = 20;
+		}
+		warm.WarmStart = true;
+
+		// clear day with a slowly varying ambient temperature and wind speed
+		for (int h = 0; h < 24; h++) {
+			double x = (h - 12) / 6.0;
+			double G = (fabs(x) < 1) ? 900 * (1 - x * x) : 0;
+			pvinput_t in(0.7 * G, 0.25 * G, 0.05 * G, 0, G, 15 + 5 * (1 - x * x), 5, 1 + fabs(x), 180, 1013, 30 + 40 * fabs(x), 20 + 30 * fabs(x), 100, 30, 180, h, 0, false);
+
+			double Tc_cold, Tc_warm;
+			EXPECT_TRUE(cold(in, cec, -1, Tc_cold));
+			EXPECT_TRUE(warm(in, cec, -1, Tc_warm));
+			EXPECT_NEAR(Tc_warm, Tc_cold, 0.01) << "MC=" << mc << " hour=" << h;
+		}
+
+		EXPECT_EQ(cold.Calls, 11u) << "MC=" << mc;
+		EXPECT_EQ(warm.Calls, cold.Calls);
+		EXPECT_GE(cold.TemperatureIterations, cold.PowerIterations);
+		EXPECT_LE(warm.PowerIterations, cold.PowerIterations) << "MC=" << mc;
+
+		cold.reset_counters();
+		EXPECT_EQ(cold.Calls + cold.PowerIterations + cold.TemperatureIterations, 0u);
+	}
+}
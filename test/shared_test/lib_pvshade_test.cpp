@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <lib_pvshade.h>
+
+static ssinputs selfShadingInputs(int mod_orient, int str_orient)
+{
+	ssinputs in;
+	in.nmodx = 12;
+	in.nmody = 2;
+	in.nrows = 10;
+	in.nstrx = 1;
+	in.length = 1.65;
+	in.width = 0.99;
+	in.mod_orient = mod_orient;
+	in.str_orient = str_orient;
+	in.row_space = in.nmody * (mod_orient == 0 ? in.length : in.width) / 0.5;
+	in.ndiode = 3;
+	in.Vmp = 30.;
+	in.mask_angle_calc_method = 0;
+	in.FF0 = 0.75;
+	return in;
+}
+
+TEST(pvShadeTest, ssSurfaceMatchesDirect)
+{
+	for (int orient = 0; orient < 4; orient++)
+	{
+		ssinputs in = selfShadingInputs(orient % 2, orient / 2);
+		double tilt = 25, azimuth = 180;
+
+		ss_surface coarse, fine;
+		ASSERT_TRUE(coarse.setup(in, tilt, azimuth, 2.0));
+		ASSERT_TRUE(fine.setup(in, tilt, azimuth, 0.5));
+		EXPECT_TRUE(fine.applies(tilt, azimuth));
+		EXPECT_FALSE(fine.applies(tilt + 1, azimuth));
+
+		// a finer grid does not increase the reported error, and the shaded fraction is smooth enough to be close
+		EXPECT_LE(fine.max_error(true), coarse.max_error(true) + 1e-12);
+		EXPECT_LT(fine.max_error(true), 0.01);
+
+		// the reported error bounds the error over the sky for the nominal irradiance it was estimated with
+		double worst_linear = 0, worst_derate = 0;
+		for (double zen = 0.3; zen < 95; zen += 1.7)
+		{
+			for (double azi = 0.1; azi < 360; azi += 2.3)
+			{
+				ssoutputs direct, interp;
+				ASSERT_TRUE(ss_exec(in, tilt, azimuth, zen, azi, 900, 700, 150, 0.2, false, true, 0, direct));
+				ASSERT_TRUE(fine.exec(zen, azi, 900, 700, 150, 0.2, true, interp));
+				worst_linear = fmax(worst_linear, fabs(interp.m_shade_frac_fixed - direct.m_shade_frac_fixed));
+
+				ASSERT_TRUE(ss_exec(in, tilt, azimuth, zen, azi, 900, 700, 150, 0.2, false, false, 0, direct));
+				ASSERT_TRUE(fine.exec(zen, azi, 900, 700, 150, 0.2, false, interp));
+				worst_derate = fmax(worst_derate, fabs(interp.m_dc_derate - direct.m_dc_derate));
+				EXPECT_EQ(interp.m_diffuse_derate, direct.m_diffuse_derate);
+			}
+		}
+		EXPECT_LE(worst_linear, 2 * fine.max_error(true) + 1e-9) << "orientation " << orient;
+		EXPECT_LE(worst_derate, fine.max_error(false) + 0.05) << "orientation " << orient;
+	}
+
+	// nothing to tabulate for a flat array or an invalid resolution
+	ss_surface none;
+	EXPECT_FALSE(none.setup(selfShadingInputs(0, 0), 0, 180, 1.0));
+	EXPECT_FALSE(none.setup(selfShadingInputs(0, 0), 25, 180, 0));
+	EXPECT_FALSE(none.is_setup());
+}
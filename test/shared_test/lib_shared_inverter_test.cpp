@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <lib_shared_inverter.h>
+#include <bsplinebuilder.h>
+#include <datatable.h>
 
 /**
 * Shared Inverter Class test
@@ -186,3 +188,115 @@ TEST_F(sharedInverterTest, tempDerateTest_lib_shared_inverter) {
 	EXPECT_NEAR(pAC, 60, e) << "case 9";
 
 }
+
+TEST_F(sharedInverterTest, ondEfficiencySplineCache) {
+	const double Pdc[] = { 0, 2000, 5000, 10000, 20000, 30000, 40000, 50000, 60000 };
+	const double eta[] = { 0, 0.87, 0.935, 0.96, 0.972, 0.975, 0.974, 0.972, 0.97 };
+	const int n = 9;
+
+	ond_inverter ond[2];
+	for (int m = 0; m < 2; m++) {
+		ond_inverter &o = ond[m];
+		o.ModeOper = "MPPT";
+		o.CompPMax = o.CompVMax = "Lim";
+		o.ModeAffEnum = "Efficiencyf_PIn";
+		o.PNomConv = 50000;
+		o.PMaxOUT = 55000;
+		o.PNomDC = 51500;
+		o.PMaxDC = 57000;
+		o.VMppMin = 300;
+		o.VMPPMax = 800;
+		o.INomDC = o.IMaxDC = 0;
+		o.PLim1 = o.PLimAbs = 0;
+		o.TPNom = 40; o.TPMax = 25; o.TPLim1 = 50; o.TPLimAbs = 60;
+		o.VNomEff[0] = 600; o.VNomEff[1] = o.VNomEff[2] = 0;
+		for (int i = 0; i < 100; i++)
+			o.effCurve_Pdc[0][i] = o.effCurve_eta[0][i] = 0;
+		for (int i = 0; i < n; i++) {
+			o.effCurve_Pdc[0][i] = Pdc[i];
+			o.effCurve_eta[0][i] = eta[i];
+		}
+	}
+
+	ond_inverter::clearSplineCache();
+	ond[0].initializeManual();
+	EXPECT_EQ(ond_inverter::splineCacheSize(), 1u);
+	ond[1].initializeManual();
+	EXPECT_EQ(ond_inverter::splineCacheSize(), 1u) << "the second inverter should reuse the fitted curve";
+
+	// compare with evaluating the SPLINTER fit directly, above the arctangent segment
+	DataTable samples;
+	DenseVector x(1);
+	for (int i = 2; i < n; i++) {
+		x(0) = Pdc[i];
+		samples.addSample(x, eta[i]);
+	}
+	BSpline bspline = BSpline::Builder(samples).degree(3).build();
+	for (double P = Pdc[2]; P <= Pdc[n - 1]; P += 250) {
+		x(0) = P;
+		double expected = bspline.eval(x);
+		EXPECT_NEAR(ond[0].calcEfficiency(P, 0), expected, 1e-12) << "Pdc=" << P;
+		EXPECT_NEAR(ond[1].calcEfficiency(P, 0), expected, 1e-12) << "Pdc=" << P;
+	}
+	x(0) = Pdc[n - 1];
+	EXPECT_NEAR(ond[0].calcEfficiency(Pdc[n - 1] + 1000, 0), bspline.eval(x), 1e-12) << "clipped at the last curve point";
+	ond_inverter::clearSplineCache();
+}
+
+TEST_F(sharedInverterTest, seriesMatchesTimestep) {
+	sinv.Paco = 3800;
+	sinv.Pdco = 3950;
+	sinv.Vdco = 380;
+	sinv.Pso = 20;
+	sinv.Pntare = 1;
+	sinv.C0 = -3e-6;
+	sinv.C1 = -2e-5;
+	sinv.C2 = 1e-3;
+	sinv.C3 = -1e-3;
+
+	for (size_t nMppt = 1; nMppt <= 2; nMppt++) {
+		SharedInverter single(SharedInverter::SANDIA_INVERTER, 3, &sinv, &plinv, &ondinv);
+		SharedInverter series(SharedInverter::SANDIA_INVERTER, 3, &sinv, &plinv, &ondinv);
+		std::vector<std::vector<double>> curves = { { 300, 30, -0.01 }, { 450, 35, -0.02 } };
+		single.setTempDerateCurves(curves);
+		series.setTempDerateCurves(curves);
+
+		// a day of DC power and voltage, with the second input at a lower power
+		const size_t n = 24;
+		std::vector<std::vector<double>> P(nMppt, std::vector<double>(n)), V(nMppt, std::vector<double>(n));
+		std::vector<double> T(n);
+		std::vector<const double*> pP, pV;
+		for (size_t m = 0; m < nMppt; m++) {
+			for (size_t i = 0; i < n; i++) {
+				double x = (i - 12.) / 6.;
+				P[m][i] = (fabs(x) < 1) ? 13 * (1 - x * x) / (m + 1) : 0;
+				V[m][i] = 350 + 60 * sin(i + m);
+				T[i] = 20 + 20 * (1 - x * x);
+			}
+			pP.push_back(P[m].data());
+			pV.push_back(V[m].data());
+		}
+
+		SharedInverterSeries out;
+		series.calculateACPower(n, pP, pV, T.data(), out);
+		ASSERT_EQ(out.size(), n);
+
+		for (size_t i = 0; i < n; i++) {
+			std::vector<double> Pi, Vi;
+			for (size_t m = 0; m < nMppt; m++) {
+				Pi.push_back(P[m][i]);
+				Vi.push_back(V[m][i]);
+			}
+			single.calculateACPower(Pi, Vi, T[i]);
+			EXPECT_EQ(out.powerAC_kW[i], single.powerAC_kW) << "step " << i;
+			EXPECT_EQ(out.efficiencyAC[i], single.efficiencyAC) << "step " << i;
+			EXPECT_EQ(out.powerClipLoss_kW[i], single.powerClipLoss_kW) << "step " << i;
+			EXPECT_EQ(out.powerTempLoss_kW[i], single.powerTempLoss_kW) << "step " << i;
+			EXPECT_EQ(out.powerLossTotal_kW[i], single.powerLossTotal_kW) << "step " << i;
+
+			series.setTimestep(out, i);
+			EXPECT_EQ(series.powerAC_kW, single.powerAC_kW);
+			EXPECT_EQ(series.powerNightLoss_kW, single.powerNightLoss_kW);
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+#include <lib_snowmodel.h>
+
+TEST(snowModelTest, skipsSnowFreeSpans)
+{
+	// a winter with snow falls, melting and a few bad values, and summer without snow
+	size_t n = 8760;
+	std::vector<float> poa(n), tilt(n, 30.f), tdry(n), depth(n);
+	std::vector<int> sunup(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		size_t h = i % 24;
+		sunup[i] = (h > 6 && h < 18) ? 1 : 0;
+		poa[i] = sunup[i] ? (float)(600 * sin((h - 6) * M_PI / 12)) : 0.f;
+		tdry[i] = (float)(10 - 15 * cos(i * 2 * M_PI / n) + 5 * sin((h - 9) * M_PI / 12));
+		double season = cos(i * 2 * M_PI / n);
+		depth[i] = season > 0.5 ? (float)(20 * (season - 0.5) + ((i / 200) % 3 == 0 ? 5 : 0)) : 0.f;
+	}
+	depth[100] = -5.f;
+	depth[5000] = 700.f;
+	tilt[6000] = -10.f; // sliding would add coverage here, so it is not skipped
+
+	pvsnowmodel scalar, batch;
+	scalar.setup(2, 30.f);
+	batch.setup(2, 30.f);
+
+	std::vector<float> lossScalar(n), lossBatch(n), cvgScalar(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		scalar.getLoss(poa[i], tilt[i], 0, tdry[i], depth[i], sunup[i], 1.0f, lossScalar[i]);
+		cvgScalar[i] = scalar.coverage;
+	}
+
+	size_t i = 0, bad = 0;
+	while (i < n)
+	{
+		size_t nDone = 0;
+		if (!batch.getLosses(n - i, &poa[i], &tilt[i], &tdry[i], &depth[i], &sunup[i], 1.0f, &lossBatch[i], nDone))
+			bad++;
+		i += nDone;
+	}
+
+	EXPECT_EQ(bad, 2u);
+	EXPECT_EQ(batch.badValues, scalar.badValues);
+	for (i = 0; i < n; i++)
+		ASSERT_EQ(lossBatch[i], lossScalar[i]) << "step " << i;
+	EXPECT_EQ(batch.coverage, cvgScalar[n - 1]);
+	EXPECT_EQ(batch.previousDepth, scalar.previousDepth);
+
+	size_t snowFree = 0, snowy = 0;
+	for (i = 0; i < n; i++)
+	{
+		if (batch.canSkip(depth[i], tilt[i], sunup[i])) snowFree++;
+		if (lossScalar[i] > 0) snowy++;
+	}
+	EXPECT_EQ(batch.skippedSteps, snowFree);
+	EXPECT_GT(snowy, 0u);
+	EXPECT_GT(batch.skippedSteps, n / 2);
+	EXPECT_EQ(scalar.skippedSteps, 0u);
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <lib_util.h>
 #include <string>
+#include <cmath>
 
 
 TEST(libUtilTests, testFormat)
@@ -13,4 +14,104 @@ TEST(libUtilTests, testFormat)
 	str = "query point (301.3, 10.4) is too far out of convex hull of data (dist=4.3)... estimating value from 5 parameter modele at (2.2, 2.1)=2.4";
 	ASSERT_EQ(util::format("query point (%lg, %lg) is too far out of convex hull of data (dist=%lg)... estimating value from 5 parameter modele at (%lg, %lg)=%lg",
 		301.3, 10.4, 4.3, 2.2, 2.1, 2.4), str);
-}
\ No newline at end of file
+}
+TEST(libUtilTests, testMatrixMove)
+{
+	// std::vector only moves its elements on reallocation if the move can't throw
+	static_assert(std::is_nothrow_move_constructible<util::matrix_t<double>>::value, "matrix_t move must be noexcept");
+	static_assert(std::is_nothrow_move_assignable<util::matrix_t<double>>::value, "matrix_t move assignment must be noexcept");
+
+	util::matrix_t<double> a(3, 2, 1.5);
+	double *p = a.data();
+
+	util::matrix_t<double> b(std::move(a));
+	ASSERT_EQ(b.data(), p);
+	ASSERT_EQ(b.nrows(), 3);
+	ASSERT_EQ(b.ncols(), 2);
+	ASSERT_EQ(a.ncells(), 1);
+
+	util::matrix_t<double> c;
+	c = std::move(b);
+	ASSERT_EQ(c.data(), p);
+	ASSERT_EQ(c.at(2, 1), 1.5);
+	ASSERT_EQ(b.ncells(), 1);
+
+	// moved-from matrices can be reused
+	b.resize_fill(2, 2, 3.0);
+	ASSERT_EQ(b.at(1, 1), 3.0);
+}
+
+TEST(libUtilTests, testMatrixAdoptRelease)
+{
+	double *p = util::matrix_t<double>::allocate(6);
+	for (size_t i = 0; i < 6; i++)
+		p[i] = (double)i;
+
+	util::matrix_t<double> m;
+	m.adopt(p, 2, 3);
+	ASSERT_EQ(m.data(), p);
+	ASSERT_EQ(m.at(1, 0), 3.0);
+
+	double *q = m.release();
+	ASSERT_EQ(q, p);
+	ASSERT_EQ(m.ncells(), 1);
+	util::matrix_t<double>::deallocate(q);
+}
+
+TEST(libUtilTests, testMatrixSmallBuffer)
+{
+	util::matrix_t<double> a(1, 2, 4.0);
+	util::matrix_t<double> b(std::move(a));
+	ASSERT_EQ(b.ncells(), 2);
+	ASSERT_EQ(b[1], 4.0);
+
+	// reshaping to the same number of cells keeps the storage
+	util::matrix_t<double> c(2, 6, 1.0);
+	double *p = c.data();
+	c.resize(3, 4);
+	ASSERT_EQ(c.data(), p);
+
+	// shrinking back to a scalar releases the heap array
+	c.resize(1, 1);
+	c = 7.0;
+	ASSERT_EQ(c.value(), 7.0);
+
+	// release of inline storage hands back a heap copy
+	double *q = b.release();
+	ASSERT_EQ(q[0], 4.0);
+	util::matrix_t<double>::deallocate(q);
+}
+
+TEST(libUtilTests, testBilinearTable)
+{
+	// azimuth by altitude layout: altitudes down column zero, azimuths across row zero
+	util::matrix_t<double> even(11, 38, 0.0);
+	for (size_t r = 1; r < 11; r++) even.at(r, 0) = (r - 1) * 10.0;
+	for (size_t c = 1; c < 38; c++) even.at(0, c) = (c - 1) * 10.0;
+	for (size_t r = 1; r < 11; r++)
+		for (size_t c = 1; c < 38; c++)
+			even.at(r, c) = ((r * 7 + c * 13) % 17) / 17.0;
+
+	util::matrix_t<double> uneven(even);
+	double alts[] = { 0, 2, 5, 10, 20, 35, 50, 65, 80, 90 };
+	for (size_t r = 1; r < 11; r++) uneven.at(r, 0) = alts[r - 1];
+
+	util::matrix_t<double> unsorted(even);
+	unsorted.at(4, 0) = 45.0;
+
+	util::matrix_t<double> tables[] = { even, uneven, unsorted };
+	for (size_t k = 0; k < 3; k++)
+	{
+		util::bilinear_table table(tables[k]);
+		for (double alt = -15; alt <= 105; alt += 0.37)
+			for (double azi = -20; azi <= 380; azi += 1.13)
+				ASSERT_EQ(table(alt, azi), util::bilinear(alt, azi, tables[k])) << "table " << k << " at " << alt << ", " << azi;
+		// exactly on the grid points
+		for (size_t r = 1; r < 11; r++)
+			for (size_t c = 1; c < 38; c++)
+				ASSERT_EQ(table(tables[k].at(r, 0), tables[k].at(0, c)), util::bilinear(tables[k].at(r, 0), tables[k].at(0, c), tables[k]));
+	}
+
+	util::bilinear_table small(util::matrix_t<double>(2, 2, 1.0));
+	ASSERT_TRUE(std::isnan(small(1.0, 1.0)));
+}
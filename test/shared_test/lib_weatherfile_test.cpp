@@ -147,6 +147,40 @@ TEST_F(weatherfileTest, EPWNoLineEndingsTest) {
 	EXPECT_TRUE(wf.nrecords() == 8760 );
 }
 
+/// Opening the same file again is served from the parse cache and gives identical data
+TEST_F(weatherfileTest, ParseCacheTest) {
+	char filepath[150];
+	sprintf(filepath, "%s/test/input_docs/weather_30m.epw", std::getenv("SSCDIR"));
+	file = std::string(filepath);
+
+	weatherfile::set_cache_size(0);
+	weatherfile parsed;
+	ASSERT_TRUE(parsed.open(file));
+
+	weatherfile::set_cache_size(4);
+	weatherfile::clear_cache();
+	weatherfile first, cached;
+	ASSERT_TRUE(first.open(file));
+	ASSERT_TRUE(cached.open(file));
+	EXPECT_EQ(cached.nrecords(), parsed.nrecords());
+	EXPECT_EQ(cached.step_sec(), parsed.step_sec());
+	EXPECT_EQ(cached.filename(), file);
+	EXPECT_EQ(cached.header().city, parsed.header().city);
+
+	weather_record r1, r2;
+	for (size_t i = 0; i < parsed.nrecords(); i++) {
+		ASSERT_TRUE(parsed.read(&r1));
+		ASSERT_TRUE(cached.read(&r2));
+		EXPECT_EQ(r1.hour, r2.hour) << "record " << i;
+		EXPECT_EQ(r1.minute, r2.minute) << "record " << i;
+		EXPECT_EQ(r1.gh, r2.gh) << "record " << i;
+		EXPECT_EQ(r1.tdry, r2.tdry) << "record " << i;
+		EXPECT_EQ(r1.twet, r2.twet) << "record " << i;
+	}
+	EXPECT_FALSE(cached.read(&r2));
+	weatherfile::set_cache_size(16);
+}
+
 /**
 * \class weatherdataTest
 *
@@ -34,4 +34,45 @@ TEST_F(CMBattery, CommercialLifetimePeakShaving) {
 		
 		EXPECT_GT(replacements, 0);
 	}
-}
\ No newline at end of file
+}
+/// Test that manual dispatch runs the hours with no charging or discharging allowed as idle spans
+TEST_F(CMBattery, ManualDispatchIdleSpans) {
+
+	// charge and discharge only from 10 am to 6 pm on weekdays, with profile 4 allowing neither
+	ssc_number_t p_sched[288], p_sched_weekend[288];
+	for (size_t i = 0; i < 288; i++) {
+		size_t hour = i % 24;
+		p_sched[i] = (hour >= 10 && hour < 18) ? 3 : 4;
+		p_sched_weekend[i] = 4;
+	}
+	ssc_data_set_matrix(data, "dispatch_manual_sched", p_sched, 12, 24);
+	ssc_data_set_matrix(data, "dispatch_manual_sched_weekend", p_sched_weekend, 12, 24);
+	ssc_data_set_number(data, "batt_dispatch_choice", 4);
+
+	ssc_module_exec_set_print(0);
+	ssc_module_t module = ssc_module_create("battery");
+	ASSERT_TRUE(module != NULL);
+	EXPECT_TRUE(ssc_module_exec(module, data) != 0);
+
+	// the notice reports how many steps were advanced within spans rather than run individually
+	int skipped = 0, type = 0, i = 0;
+	float time = 0;
+	while (const char *text = ssc_module_log(module, i++, &type, &time)) {
+		if (sscanf(text, "The battery model advanced %d idle timesteps", &skipped) == 1)
+			EXPECT_EQ(type, SSC_NOTICE);
+	}
+	ssc_module_free(module);
+	EXPECT_GT(skipped, 0);
+
+	// the battery holds its charge through the spans
+	int n = 0;
+	ssc_number_t *power = ssc_data_get_array(data, "batt_power", &n);
+	ssc_number_t *SOC = ssc_data_get_array(data, "batt_SOC", &n);
+	ASSERT_EQ(n, 20 * 8760);
+	for (int h = 1; h < 8760; h++) {
+		if (h % 24 < 10 || h % 24 >= 18 || !util::weekday(h)) {
+			EXPECT_EQ(power[h], 0) << "hour " << h;
+			EXPECT_NEAR(SOC[h], SOC[h - 1], 1e-4) << "hour " << h;
+		}
+	}
+}
@@ -603,4 +603,92 @@ TEST_F(CMPvsamv1PowerIntegration, SnowModel)
 	ssc_data_get_number(data, "annual_energy", &annual_energy);
 	EXPECT_NEAR(annual_energy, 11354.7, m_error_tolerance_hi) << "Annual energy.";
 
-}
\ No newline at end of file
+}
+/// Test PVSAMv1 multiple subarrays give the same results with the irradiance calculated on several threads
+TEST_F(CMPvsamv1PowerIntegration, SubarrayThreads)
+{
+	pvsamv_nofinancial_default(data);
+
+	std::map<std::string, double> pairs;
+	pairs["subarray1_nstrings"] = 14;
+	pairs["subarray2_enable"] = 1;
+	pairs["subarray2_nstrings"] = 15;
+	pairs["subarray2_tilt"] = 0;
+	pairs["subarray3_enable"] = 1;
+	pairs["subarray3_nstrings"] = 10;
+	pairs["subarray3_azimuth"] = 90;
+	pairs["subarray4_enable"] = 1;
+	pairs["subarray4_nstrings"] = 10;
+	pairs["subarray4_track_mode"] = 1;
+	pairs["inverter_count"] = 22;
+
+	ssc_number_t annual_energy_serial = 0;
+	pairs["subarray_threads"] = 1;
+	int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	EXPECT_FALSE(pvsam_errors);
+	ssc_data_get_number(data, "annual_energy", &annual_energy_serial);
+
+	ssc_number_t annual_energy_threaded = 0;
+	pairs["subarray_threads"] = 0;
+	pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	EXPECT_FALSE(pvsam_errors);
+	ssc_data_get_number(data, "annual_energy", &annual_energy_threaded);
+
+	EXPECT_GT(annual_energy_serial, 0) << "Annual energy.";
+	EXPECT_EQ(annual_energy_serial, annual_energy_threaded) << "Annual energy.";
+}
+
+/// Test PVSAMv1 lifetime results after year one are the same whether the year one irradiance is reused or recalculated
+TEST_F(CMPvsamv1PowerIntegration, LifetimeReuseIrradiance)
+{
+	std::map<std::string, double> pairs;
+	pairs["system_use_lifetime_output"] = 1;
+	pairs["analysis_period"] = 3;
+
+	double dc_degradation[3] = { 0.5, 0.5, 0.5 };
+	ssc_data_set_array(data, "dc_degradation", (ssc_number_t*)dc_degradation, 3);
+	ssc_data_set_array(data, "ac_degradation", (ssc_number_t*)dc_degradation, 3);
+
+	std::vector<ssc_number_t> gen[2];
+	for (int reuse = 0; reuse < 2; reuse++)
+	{
+		pairs["reuse_irradiance"] = reuse;
+		int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+		EXPECT_FALSE(pvsam_errors);
+
+		int n = 0;
+		ssc_number_t *p_gen = ssc_data_get_array(data, "gen", &n);
+		ASSERT_EQ(n, 3 * 8760);
+		gen[reuse].assign(p_gen, p_gen + n);
+	}
+
+	double year_one = 0, year_two = 0;
+	for (size_t i = 0; i < 8760; i++)
+	{
+		year_one += gen[1][i];
+		year_two += gen[1][8760 + i];
+	}
+	EXPECT_LT(year_two, year_one) << "Later years are degraded.";
+
+	for (size_t i = 8760; i < gen[0].size(); i++)
+		ASSERT_EQ(gen[0][i], gen[1][i]) << "gen at timestep " << i;
+}
+
+/// Test PVSAMv1 heat transfer cell temperature model gives nearly the same results when warm started from the last timestep
+TEST_F(CMPvsamv1PowerIntegration, HeatTransferWarmStart)
+{
+	std::map<std::string, double> pairs;
+	pairs["cec_temp_corr_mode"] = 1;
+
+	ssc_number_t annual_energy[2] = { 0, 0 };
+	for (int warm = 0; warm < 2; warm++)
+	{
+		pairs["cec_warm_start"] = warm;
+		int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+		EXPECT_FALSE(pvsam_errors);
+		ssc_data_get_number(data, "annual_energy", &annual_energy[warm]);
+	}
+
+	EXPECT_NEAR(annual_energy[0], 8749, m_error_tolerance_hi) << "Annual energy.";
+	EXPECT_NEAR(annual_energy[1], annual_energy[0], 0.01) << "Annual energy with warm start.";
+}
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
 
 #include "../ssc/core.h"
 #include "../ssc/vartab.h"
@@ -37,4 +39,110 @@ TEST_F(CMPvwattsV5Integration, DefaultNoFinancialModel){
 	ssc_data_get_number(data, "capacity_factor", &capacity_factor);
 	EXPECT_NEAR(capacity_factor, 19.7197, error_tolerance) << "Capacity factor";
 
-}
\ No newline at end of file
+}
+/// Default PVWattsV5 case run several times through the multi-threaded batch interface
+TEST_F(CMPvwattsV5Integration, BatchExecution) {
+	const int n = 4;
+	ssc_data_t cases[n];
+	for (int i = 0; i < n; i++) {
+		cases[i] = ssc_data_create();
+		EXPECT_FALSE(pvwattsv5_nofinancial_testfile(cases[i]));
+	}
+
+	ssc_bool_t results[n];
+	EXPECT_EQ(ssc_module_exec_batch("pvwattsv5", cases, n, 2, results), n);
+	EXPECT_EQ(ssc_module_exec_batch("not_a_module", cases, n, 2, results), -1);
+
+	// the module name is checked even for an empty batch, and a missing data array is an error
+	EXPECT_EQ(ssc_module_exec_batch("not_a_module", NULL, 0, 2, NULL), -1);
+	EXPECT_EQ(ssc_module_exec_batch("pvwattsv5", NULL, 0, 2, NULL), 0);
+	EXPECT_EQ(ssc_module_exec_batch("pvwattsv5", NULL, n, 2, results), -1);
+	EXPECT_EQ(ssc_module_exec_batch("pvwattsv5", cases, -1, 2, results), -1);
+
+	for (int i = 0; i < n; i++) {
+		EXPECT_TRUE(results[i]) << "Case " << i;
+
+		int count = 0;
+		ssc_number_t* monthly_energy = ssc_data_get_array(cases[i], "monthly_energy", &count);
+		ASSERT_EQ(count, 12);
+
+		double tmp = 0;
+		for (size_t m = 0; m < 12; m++)
+			tmp += (double)monthly_energy[m];
+		EXPECT_NEAR(tmp, 6909.79, error_tolerance) << "Annual energy of case " << i;
+
+		ssc_data_free(cases[i]);
+	}
+}
+
+/// The batch module gives the results of separate pvwattsv5 runs, including the default case
+TEST_F(CMPvwattsV5Integration, BatchModuleMatchesSingleRuns) {
+	const char *file = ssc_data_get_string(data, "solar_resource_file");
+	std::string files = std::string(file) + "\n" + file + "\n";
+
+	// file index, system_capacity, module_type, dc_ac_ratio, inv_eff, losses, array_type, tilt, azimuth, gcr
+	const int n = 4;
+	ssc_number_t configs[n * 10] = {
+		0, 4, 0, 1.2000000476837158f, 96, 14.075660705566406f, 0, 20, 180, 0.40000000596046448f,
+		1, 5, 1, 1.1f, 97, 10, 1, 30, 200, 0.4f,
+		0, 3, 2, 1.3f, 96, 14, 2, 0, 180, 0.3f,
+		1, 4, 0, 1.2f, 96, 14, 4, 0, 180, 0.4f };
+
+	ssc_data_t batch = ssc_data_create();
+	ssc_data_set_string(batch, "solar_resource_files", files.c_str());
+	ssc_data_set_matrix(batch, "configurations", configs, n, 10);
+	ssc_data_set_number(batch, "batch_threads", 2);
+	EXPECT_TRUE(ssc_module_exec_simple_nothread("pvwattsv5_batch", batch) == 0);
+
+	int count = 0, nrows = 0, ncols = 0;
+	ssc_number_t *annual = ssc_data_get_array(batch, "annual_energy", &count);
+	ssc_number_t *monthly = ssc_data_get_matrix(batch, "monthly_energy", &nrows, &ncols);
+	ASSERT_EQ(count, n);
+	ASSERT_EQ(nrows, n);
+	ASSERT_EQ(ncols, 12);
+	EXPECT_NEAR(annual[0], 6909.79, error_tolerance) << "Annual energy of the default case";
+
+	const char *names[10] = { "", "system_capacity", "module_type", "dc_ac_ratio", "inv_eff", "losses", "array_type", "tilt", "azimuth", "gcr" };
+	for (int i = 0; i < n; i++) {
+		ssc_data_t single = ssc_data_create();
+		EXPECT_FALSE(pvwattsv5_nofinancial_testfile(single));
+		for (int c = 1; c < 10; c++)
+			ssc_data_set_number(single, names[c], configs[i * 10 + c]);
+		EXPECT_TRUE(ssc_module_exec_simple_nothread("pvwattsv5", single) == 0);
+
+		ssc_number_t annual_single = 0;
+		ssc_data_get_number(single, "annual_energy", &annual_single);
+		EXPECT_NEAR(annual[i], annual_single, error_tolerance) << "Annual energy of configuration " << i;
+		ssc_number_t *monthly_single = ssc_data_get_array(single, "monthly_energy", &count);
+		for (int m = 0; m < 12; m++)
+			EXPECT_NEAR(monthly[i * 12 + m], monthly_single[m], error_tolerance) << "Configuration " << i << " month " << m;
+		ssc_data_free(single);
+	}
+	ssc_data_free(batch);
+}
+
+/// A weather file with a value that cannot be read fails the batch with an error naming the file
+TEST_F(CMPvwattsV5Integration, BatchCorruptWeatherFile) {
+	std::ifstream in(ssc_data_get_string(data, "solar_resource_file"));
+	std::string corrupt = "pvwattsv5_batch_corrupt.csv";
+	std::ofstream out(corrupt.c_str());
+	std::string line;
+	for (int i = 0; std::getline(in, line); i++) {
+		if (i == 10) line = "1988,1,1,7,-x1,0,0,5.6,-3.3,53,983,2.1,200,0,0";
+		out << line << "\n";
+	}
+	out.close();
+
+	ssc_number_t configs[10] = { 0, 4, 0, 1.2f, 96, 14, 0, 20, 180, 0.4f };
+	ssc_data_t batch = ssc_data_create();
+	ssc_data_set_string(batch, "solar_resource_files", corrupt.c_str());
+	ssc_data_set_matrix(batch, "configurations", configs, 1, 10);
+	ssc_data_set_number(batch, "batch_threads", 2);
+	const char *err = ssc_module_exec_simple_nothread("pvwattsv5_batch", batch);
+	std::string message = err ? err : "";
+	ssc_data_free(batch);
+	std::remove(corrupt.c_str());
+
+	EXPECT_TRUE(err != 0);
+	EXPECT_NE(message.find(corrupt), std::string::npos) << message;
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "../ssc/sscapi.h"
+
+/// Buffers adopted by a data container can be read in place and taken back out without copying
+TEST(sscapiTest, AdoptTakeRoundTrip) {
+	ssc_data_t data = ssc_data_create();
+
+	ssc_number_t *array = ssc_number_alloc(4);
+	ASSERT_TRUE(array != NULL);
+	for (int i = 0; i < 4; i++)
+		array[i] = (ssc_number_t)i;
+	ssc_data_adopt_array(data, "array", array, 4);
+
+	int length = 0;
+	ssc_number_t *values = ssc_data_get_array(data, "array", &length);
+	EXPECT_EQ(values, array);
+	EXPECT_EQ(length, 4);
+
+	ssc_number_t *matrix = ssc_number_alloc(6);
+	ASSERT_TRUE(matrix != NULL);
+	for (int i = 0; i < 6; i++)
+		matrix[i] = (ssc_number_t)(10 + i);
+	ssc_data_adopt_matrix(data, "matrix", matrix, 2, 3);
+
+	int nrows = 0, ncols = 0;
+	values = ssc_data_get_matrix(data, "matrix", &nrows, &ncols);
+	EXPECT_EQ(values, matrix);
+	EXPECT_EQ(nrows, 2);
+	EXPECT_EQ(ncols, 3);
+	EXPECT_EQ(values[1 * ncols + 2], 15);
+
+	// taking the values removes the variable and hands back the same buffer
+	length = 0;
+	values = ssc_data_take_array(data, "array", &length);
+	EXPECT_EQ(values, array);
+	EXPECT_EQ(length, 4);
+	EXPECT_EQ(values[3], 3);
+	EXPECT_EQ(ssc_data_query(data, "array"), SSC_INVALID);
+	ssc_number_free(values);
+
+	nrows = ncols = 0;
+	values = ssc_data_take_matrix(data, "matrix", &nrows, &ncols);
+	EXPECT_EQ(values, matrix);
+	EXPECT_EQ(nrows, 2);
+	EXPECT_EQ(ncols, 3);
+	EXPECT_EQ(ssc_data_query(data, "matrix"), SSC_INVALID);
+	ssc_number_free(values);
+
+	ssc_data_free(data);
+}
+
+/// Invalid arguments leave the container unchanged, and the adopted buffer is freed rather than leaked
+TEST(sscapiTest, AdoptTakeInvalid) {
+	EXPECT_TRUE(ssc_number_alloc(0) == NULL);
+	ssc_number_free(NULL);
+
+	ssc_data_t data = ssc_data_create();
+	ssc_data_adopt_array(data, "array", ssc_number_alloc(4), 0);
+	ssc_data_adopt_array(NULL, "array", ssc_number_alloc(4), 4);
+	ssc_data_adopt_array(data, "array", NULL, 4);
+	ssc_data_adopt_matrix(data, "matrix", ssc_number_alloc(6), 2, 0);
+	ssc_data_adopt_matrix(data, "matrix", ssc_number_alloc(6), -1, 3);
+	EXPECT_EQ(ssc_data_query(data, "array"), SSC_INVALID);
+	EXPECT_EQ(ssc_data_query(data, "matrix"), SSC_INVALID);
+
+	// only a variable of the matching type can be taken
+	ssc_data_set_number(data, "number", 1);
+	ssc_data_set_array(data, "array", NULL, 0);
+	int length = -1, nrows = -1, ncols = -1;
+	EXPECT_TRUE(ssc_data_take_array(data, "number", &length) == NULL);
+	EXPECT_TRUE(ssc_data_take_array(data, "missing", &length) == NULL);
+	EXPECT_TRUE(ssc_data_take_matrix(data, "array", &nrows, &ncols) == NULL);
+	EXPECT_TRUE(ssc_data_take_array(NULL, "array", &length) == NULL);
+	EXPECT_EQ(length, -1);
+	EXPECT_EQ(nrows, -1);
+	EXPECT_EQ(ncols, -1);
+	EXPECT_EQ(ssc_data_query(data, "number"), SSC_NUMBER);
+	EXPECT_EQ(ssc_data_query(data, "array"), SSC_ARRAY);
+
+	ssc_data_free(data);
+}
+
+/// Data written with ssc_data_write is read back unchanged, including nested tables
+TEST(sscapiTest, BinaryDataRoundTrip) {
+	ssc_data_t data = ssc_data_create();
+	ssc_number_t gen[8760];
+	for (int i = 0; i < 8760; i++)
+		gen[i] = (ssc_number_t)(i % 24) * 0.37f;
+	ssc_data_set_array(data, "gen", gen, 8760);
+	ssc_number_t matrix[] = { 1, 2, 3, 4, 5, 6 };
+	ssc_data_set_matrix(data, "matrix", matrix, 3, 2);
+	ssc_data_set_number(data, "number", 1.5f);
+	ssc_data_set_string(data, "string", "weather.csv");
+
+	ssc_data_t nested = ssc_data_create();
+	ssc_data_set_string(nested, "label", "nested");
+	ssc_data_set_number(nested, "value", 42);
+	ssc_data_set_table(data, "nested", nested);
+	ssc_data_free(nested);
+
+	const char *file = "sscapi_roundtrip.bin";
+	EXPECT_TRUE(ssc_data_write(data, file));
+	ssc_data_t copy = ssc_data_read_mmap(file);
+	remove(file);
+	ASSERT_TRUE(copy != NULL);
+
+	const char *name = ssc_data_first(data);
+	while (name) {
+		EXPECT_EQ(ssc_data_query(copy, name), ssc_data_query(data, name)) << name;
+		name = ssc_data_next(data);
+	}
+
+	int n_copy = 0;
+	ssc_number_t *gen_copy = ssc_data_get_array(copy, "gen", &n_copy);
+	ASSERT_EQ(n_copy, 8760);
+	for (int i = 0; i < n_copy; i++)
+		EXPECT_EQ(gen_copy[i], gen[i]) << "gen at index " << i;
+
+	int nrows = 0, ncols = 0;
+	ssc_number_t *matrix_copy = ssc_data_get_matrix(copy, "matrix", &nrows, &ncols);
+	ASSERT_EQ(nrows, 3);
+	ASSERT_EQ(ncols, 2);
+	for (int i = 0; i < 6; i++)
+		EXPECT_EQ(matrix_copy[i], matrix[i]);
+
+	ssc_number_t value = 0;
+	EXPECT_TRUE(ssc_data_get_number(copy, "number", &value));
+	EXPECT_EQ(value, 1.5f);
+	EXPECT_STREQ(ssc_data_get_string(copy, "string"), "weather.csv");
+
+	ssc_data_t nested_copy = ssc_data_get_table(copy, "nested");
+	ASSERT_TRUE(nested_copy != NULL);
+	EXPECT_STREQ(ssc_data_get_string(nested_copy, "label"), "nested");
+	EXPECT_TRUE(ssc_data_get_number(nested_copy, "value", &value));
+	EXPECT_EQ(value, 42);
+
+	ssc_data_free(copy);
+	ssc_data_free(data);
+
+	EXPECT_TRUE(ssc_data_read_mmap("does_not_exist.bin") == NULL);
+}
+
+/// Arrays and matrices stored with zero rows or columns are read back as the single zero an empty array is set to
+TEST(sscapiTest, BinaryDataEmptyArray) {
+	// a 0 x 0 array and a 0 x 3 matrix, which ssc_data_write can't produce since the API has no empty arrays
+	const char *file = "sscapi_empty.bin";
+	FILE *fp = fopen(file, "wb");
+	ASSERT_TRUE(fp != NULL);
+	unsigned int header[] = { 1, 0x01020304, (unsigned int)sizeof(ssc_number_t), 2 };
+	fwrite("SSCB", 1, 4, fp);
+	fwrite(header, sizeof(unsigned int), 4, fp);
+	const char *names[] = { "array\0\0\0", "matrix\0\0" };
+	unsigned int entries[][4] = { { 5, SSC_ARRAY, 0, 0 }, { 6, SSC_MATRIX, 0, 3 } };
+	for (int i = 0; i < 2; i++) {
+		// name length, name padded to 4 bytes, type and dimensions, then padding to 8 bytes before the (empty) values
+		fwrite(&entries[i][0], sizeof(unsigned int), 1, fp);
+		fwrite(names[i], 1, 8, fp);
+		fwrite(&entries[i][1], sizeof(unsigned int), 3, fp);
+		while (ftell(fp) % 8 != 0)
+			fputc(0, fp);
+	}
+	fclose(fp);
+
+	ssc_data_t copy = ssc_data_read_mmap(file);
+	remove(file);
+	ASSERT_TRUE(copy != NULL);
+
+	// same as ssc_data_set_array( data, name, NULL, 0 )
+	int length = 0;
+	ssc_number_t *values = ssc_data_get_array(copy, "array", &length);
+	ASSERT_TRUE(values != NULL);
+	EXPECT_EQ(length, 1);
+	EXPECT_EQ(values[0], 0);
+
+	int nrows = 0, ncols = 0;
+	values = ssc_data_get_matrix(copy, "matrix", &nrows, &ncols);
+	ASSERT_TRUE(values != NULL);
+	EXPECT_EQ(nrows, 1);
+	EXPECT_EQ(ncols, 1);
+	EXPECT_EQ(values[0], 0);
+	ssc_data_free(copy);
+}